@@ -0,0 +1,76 @@
+#include "AllocationCounting.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// Replaces the global allocation functions for the whole of hazor-bench, so the count covers every library hazor
+// allocates through; only the counting is added
+namespace {
+std::atomic<std::size_t> allocations = 0;
+
+void* counted_allocate(std::size_t bytes) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(bytes == 0 ? 1 : bytes);
+}
+
+void* counted_allocate(std::size_t bytes, std::align_val_t alignment) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    const auto align = static_cast<std::size_t>(alignment);
+    // aligned_alloc needs the size to be a multiple of the alignment
+    return std::aligned_alloc(align, (std::max<std::size_t>(bytes, 1) + align - 1) / align * align);
+}
+} // namespace
+
+std::size_t tel::bench::heap_allocations() { return allocations.load(std::memory_order_relaxed); }
+
+void* operator new(std::size_t bytes) {
+    if (void* memory = counted_allocate(bytes)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t bytes) { return operator new(bytes); }
+
+void* operator new(std::size_t bytes, const std::nothrow_t&) noexcept { return counted_allocate(bytes); }
+
+void* operator new[](std::size_t bytes, const std::nothrow_t&) noexcept { return counted_allocate(bytes); }
+
+void* operator new(std::size_t bytes, std::align_val_t alignment) {
+    if (void* memory = counted_allocate(bytes, alignment)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t bytes, std::align_val_t alignment) { return operator new(bytes, alignment); }
+
+void* operator new(std::size_t bytes, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return counted_allocate(bytes, alignment);
+}
+
+void* operator new[](std::size_t bytes, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return counted_allocate(bytes, alignment);
+}
+
+void operator delete(void* memory) noexcept { std::free(memory); }
+
+void operator delete[](void* memory) noexcept { std::free(memory); }
+
+void operator delete(void* memory, std::size_t) noexcept { std::free(memory); }
+
+void operator delete[](void* memory, std::size_t) noexcept { std::free(memory); }
+
+void operator delete(void* memory, std::align_val_t) noexcept { std::free(memory); }
+
+void operator delete[](void* memory, std::align_val_t) noexcept { std::free(memory); }
+
+void operator delete(void* memory, std::size_t, std::align_val_t) noexcept { std::free(memory); }
+
+void operator delete[](void* memory, std::size_t, std::align_val_t) noexcept { std::free(memory); }
+
+void operator delete(void* memory, const std::nothrow_t&) noexcept { std::free(memory); }
+
+void operator delete[](void* memory, const std::nothrow_t&) noexcept { std::free(memory); }
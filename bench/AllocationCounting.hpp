@@ -0,0 +1,17 @@
+#pragma once
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+
+namespace tel::bench {
+// Every operator new in hazor-bench since it started, the benchmark library's own included, so only the difference
+// across the code being measured means anything
+[[nodiscard]] std::size_t heap_allocations();
+
+// Reports the allocations since allocationsBefore per iteration as the "allocations" counter, which
+// compare_benchmarks.py flags whenever it is above zero. For benchmarks of work that runs every frame.
+inline void report_allocations(benchmark::State& state, std::size_t allocationsBefore) {
+    state.counters["allocations"] = benchmark::Counter(static_cast<double>(heap_allocations() - allocationsBefore),
+                                                       benchmark::Counter::kAvgIterations);
+}
+} // namespace tel::bench
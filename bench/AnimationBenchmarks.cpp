@@ -0,0 +1,61 @@
+#include "Animation.hpp"
+#include "ThreadPool.hpp"
+
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <glm/geometric.hpp>
+#include <string>
+#include <vector>
+
+namespace {
+constexpr std::size_t jointCount = 64;
+
+// A branching skeleton, two children per joint, about the size of a game character
+tel::Skeleton make_skeleton() {
+    tel::Skeleton skeleton;
+    for (std::size_t joint = 0; joint < jointCount; ++joint) {
+        skeleton.names.push_back("joint" + std::to_string(joint));
+        skeleton.parents.push_back(static_cast<std::int32_t>(joint) / 2 - 1);
+        skeleton.restPose.push_back(tel::JointTransform{.translation = glm::vec3(0.0f, 0.1f, 0.0f)});
+        skeleton.inverseBindMatrices.emplace_back(1.0f);
+    }
+    return skeleton;
+}
+
+// Every joint swings about its own axis with its own phase, so no two samples are alike
+tel::AnimationClip make_clip(const tel::Skeleton& skeleton, float duration, float frequency) {
+    std::vector<tel::JointTrack> tracks(skeleton.joint_count());
+    for (std::size_t joint = 0; joint < tracks.size(); ++joint) {
+        const glm::vec3 axis = glm::normalize(glm::vec3(1.0f, static_cast<float>(joint % 3), 0.5f));
+        for (float time = 0.0f; time <= duration; time += 0.1f) {
+            const float angle = std::sin(frequency * time + static_cast<float>(joint));
+            tracks[joint].rotations.push_back({.time = time, .value = glm::angleAxis(angle, axis)});
+        }
+    }
+    return tel::AnimationClip::resample(skeleton, tracks, duration);
+}
+
+void pose_instances(benchmark::State& state) {
+    static tel::ThreadPool threadPool;
+    tel::Animation animation(&threadPool);
+    const tel::Skeleton skeleton = make_skeleton();
+    const auto skeletonHandle = animation.add_skeleton(skeleton);
+    const auto walk = animation.add_clip(make_clip(skeleton, 1.2f, 5.0f));
+    const auto run = animation.add_clip(make_clip(skeleton, 0.8f, 8.0f));
+    const auto instances = static_cast<std::size_t>(state.range(0));
+    for (std::size_t instance = 0; instance < instances; ++instance) {
+        const auto handle = animation.create_instance(skeletonHandle);
+        const float offset = static_cast<float>(instance) * 0.01f;
+        animation.layers(handle).push_back({.clip = walk, .time = offset, .weight = 0.7f});
+        animation.layers(handle).push_back({.clip = run, .time = offset, .weight = 0.3f});
+    }
+    for (auto _ : state) {
+        animation.update(1.0f / 60.0f);
+        benchmark::DoNotOptimize(animation.palettes().data());
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * instances * jointCount));
+    state.counters["instances"] = static_cast<double>(instances);
+}
+
+BENCHMARK(pose_instances)->RangeMultiplier(10)->Range(10, 10000)->Unit(benchmark::kMillisecond);
+} // namespace
@@ -0,0 +1,59 @@
+#include "AssetArchive.hpp"
+#include "Compression.hpp"
+#include "SyntheticData.hpp"
+
+#include <benchmark/benchmark.h>
+
+namespace {
+void lz4_compress_obj(benchmark::State& state) {
+    const std::string obj = tel::bench::make_grid_obj(static_cast<int>(state.range(0)));
+    for (auto _ : state) {
+        auto compressed = tel::lz4_compress(std::as_bytes(std::span(obj)));
+        benchmark::DoNotOptimize(compressed);
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * obj.size()));
+    state.counters["ratio"] =
+        static_cast<double>(obj.size()) / static_cast<double>(tel::lz4_compress(std::as_bytes(std::span(obj))).size());
+}
+
+BENCHMARK(lz4_compress_obj)->RangeMultiplier(4)->Range(64, 1024)->Unit(benchmark::kMillisecond);
+
+void lz4_decompress_obj(benchmark::State& state) {
+    const std::string obj = tel::bench::make_grid_obj(static_cast<int>(state.range(0)));
+    const auto compressed = tel::lz4_compress(std::as_bytes(std::span(obj)));
+    std::vector<std::byte> output(obj.size());
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(tel::lz4_decompress(compressed, output));
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * obj.size()));
+}
+
+BENCHMARK(lz4_decompress_obj)->RangeMultiplier(4)->Range(64, 1024)->Unit(benchmark::kMillisecond);
+
+// Many small entries read back in parallel, the way a level's assets are loaded
+void read_archive_parallel(benchmark::State& state) {
+    static tel::ThreadPool threadPool;
+    const auto entryCount = static_cast<int>(state.range(0));
+    const std::string obj = tel::bench::make_grid_obj(32);
+    tel::AssetArchiveWriter writer;
+    for (int i = 0; i < entryCount; ++i) {
+        writer.add(std::format("meshes/{}.obj", i), std::as_bytes(std::span(obj)));
+    }
+    const auto data = writer.serialize();
+    const auto archive = tel::AssetArchive::from_memory(data).value();
+    const auto paths = archive.paths();
+    for (auto _ : state) {
+        std::vector<std::future<std::expected<std::string, tel::ArchiveError>>> reads;
+        reads.reserve(paths.size());
+        for (const std::string_view path : paths) {
+            reads.emplace_back(archive.read_async(std::string(path), threadPool));
+        }
+        for (auto& read : reads) {
+            benchmark::DoNotOptimize(threadPool.wait(read));
+        }
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * obj.size() * paths.size()));
+}
+
+BENCHMARK(read_archive_parallel)->RangeMultiplier(4)->Range(16, 1024)->Unit(benchmark::kMillisecond);
+} // namespace
@@ -0,0 +1,256 @@
+// hazor-flythrough: flies the camera along a fixed path through a generated scene and reports frame times.
+//
+//     hazor-flythrough [--frames N] [--objects N] [--particles N] [--lights N] [--target-ms N]
+//                      [--path keyframes.txt] [--csv frames.csv]
+//
+// The scene is the same on every run, so the report can be compared between builds. Without --path the camera circles
+// the scene. --particles adds fountains that keep about that many particles alive between them, and --lights scatters
+// that many coloured point lights among the objects. --target-ms turns on dynamic resolution, holding GPU frame time
+// to that many milliseconds. Run with LIBGL_ALWAYS_SOFTWARE=1 to use Mesa's software
+// rasterizer, and under xvfb-run on machines without a display.
+#include "CameraPath.hpp"
+#include "Engine.hpp"
+#include "FileLoading.hpp"
+#include "GpuMemory.hpp"
+#include "MeshLoading.hpp"
+#include "SyntheticData.hpp"
+
+#include <charconv>
+#include <cmath>
+#include <format>
+#include <fstream>
+#include <glm/ext/matrix_transform.hpp>
+#include <iostream>
+#include <numbers>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+
+namespace {
+struct Arguments {
+    std::size_t frames = 1000;
+    std::size_t objects = 10'000;
+    std::size_t particles = 0;
+    std::size_t lights = 0;
+    std::optional<std::size_t> targetMilliseconds;
+    std::optional<std::string_view> path;
+    std::optional<std::string_view> csv;
+};
+
+std::optional<std::size_t> parse_count(std::string_view text) {
+    std::size_t value = 0;
+    const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (error != std::errc{} || end != text.data() + text.size() || value == 0) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+std::optional<Arguments> parse_arguments(int argc, char** argv) {
+    Arguments arguments;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const std::string_view flag = argv[i];
+        const std::string_view value = argv[i + 1];
+        if (flag == "--frames" || flag == "--objects" || flag == "--particles" || flag == "--lights") {
+            const auto count = parse_count(value);
+            if (!count) {
+                return std::nullopt;
+            }
+            (flag == "--frames"      ? arguments.frames
+             : flag == "--objects"   ? arguments.objects
+             : flag == "--particles" ? arguments.particles
+                                     : arguments.lights) = *count;
+        } else if (flag == "--target-ms") {
+            arguments.targetMilliseconds = parse_count(value);
+            if (!arguments.targetMilliseconds) {
+                return std::nullopt;
+            }
+        } else if (flag == "--path") {
+            arguments.path = value;
+        } else if (flag == "--csv") {
+            arguments.csv = value;
+        } else {
+            return std::nullopt;
+        }
+    }
+    if (argc % 2 == 0) {
+        return std::nullopt;
+    }
+    return arguments;
+}
+
+// Two laps around the scene at varying height and distance, so the view sweeps from mostly empty to all objects
+tel::CameraPath orbit_path(float radius) {
+    constexpr int keyframes = 24;
+    tel::CameraPath path;
+    for (int i = 0; i <= keyframes; ++i) {
+        const float angle = 4.0f * std::numbers::pi_v<float> * static_cast<float>(i) / keyframes;
+        const float distance = radius * (0.6f + 0.5f * std::sin(0.5f * angle));
+        const glm::vec3 position(distance * std::cos(angle), 0.15f * radius + 0.1f * distance,
+                                 distance * std::sin(angle));
+        path.add({.position = position, .target = glm::vec3(0.0f)});
+    }
+    return path;
+}
+
+// A grid of cubes with seeded jitter in position and height, on a ground plane
+bool build_scene(tel::Engine& engine, std::size_t objectCount, float spacing) {
+    auto& rendering = engine.rendering_system();
+    const auto shader = rendering.load_shader(tel::bench::embedded_file("shaders/Main.vert"),
+                                              tel::bench::embedded_file("shaders/Main.frag"));
+    const auto cube = tel::load_mesh_from_memory(tel::bench::embedded_file("Test.obj"), &engine.thread_pool());
+    if (!shader || !cube) {
+        return false;
+    }
+    const tel::MeshHandle cubeHandle = rendering.load_mesh(cube.value());
+
+    const int side = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(objectCount))));
+    const float extent = spacing * static_cast<float>(side);
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<float> jitter(-0.25f * spacing, 0.25f * spacing);
+    std::uniform_real_distribution<float> height(0.5f, 3.0f);
+
+    tel::Scene& scene = engine.current_scene();
+    scene.camera = tel::Camera::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 4.0f * extent);
+    scene.sceneObjects.reserve(objectCount + 1);
+    for (std::size_t i = 0; i < objectCount; ++i) {
+        const auto column = static_cast<float>(static_cast<int>(i) % side);
+        const auto row = static_cast<float>(static_cast<int>(i) / side);
+        const glm::vec3 position(spacing * column - 0.5f * extent + jitter(random), 0.0f,
+                                 spacing * row - 0.5f * extent + jitter(random));
+        const glm::mat4 transform = glm::scale(glm::translate(glm::identity<glm::mat4>(), position),
+                                               glm::vec3(1.0f, height(random), 1.0f));
+        scene.sceneObjects.emplace_back(tel::SceneObject{
+            .transform = transform,
+            .renderable = {.shader = shader.value(), .mesh = cubeHandle},
+        });
+    }
+
+    constexpr int groundSide = 64;
+    const float groundScale = extent / groundSide;
+    const glm::mat4 groundTransform =
+        glm::scale(glm::translate(glm::identity<glm::mat4>(), glm::vec3(-0.5f * extent, -1.0f, -0.5f * extent)),
+                   glm::vec3(groundScale, 1.0f, groundScale));
+    scene.sceneObjects.emplace_back(tel::SceneObject{
+        .transform = groundTransform,
+        .renderable = {.shader = shader.value(), .mesh = rendering.load_mesh(tel::bench::make_grid_mesh(groundSide))},
+    });
+    return true;
+}
+
+// Fountains in a ring inside the scene, each emitting just fast enough to stay at its share of the particles
+bool add_fountains(tel::Engine& engine, std::size_t particleCount, float extent) {
+    auto& rendering = engine.rendering_system();
+    const auto shader = rendering.load_shader(tel::bench::embedded_file("shaders/Particle.vert"),
+                                              tel::bench::embedded_file("shaders/Particle.frag"));
+    if (!shader) {
+        return false;
+    }
+    constexpr int fountains = 8;
+    constexpr float lifetime = 3.0f;
+    const std::size_t perFountain = (particleCount + fountains - 1) / fountains;
+    for (int i = 0; i < fountains; ++i) {
+        const float angle = 2.0f * std::numbers::pi_v<float> * static_cast<float>(i) / fountains;
+        rendering.particles().create_emitter({
+            .shader = shader.value(),
+            .position = glm::vec3(0.25f * extent * std::cos(angle), 0.0f, 0.25f * extent * std::sin(angle)),
+            .rate = static_cast<float>(perFountain) / lifetime,
+            .maxParticles = perFountain,
+            .lifetime = lifetime,
+            .lifetimeSpread = 0.0f,
+            .velocity = glm::vec3(0.0f, 12.0f, 0.0f),
+            .velocitySpread = glm::vec3(3.0f, 2.0f, 3.0f),
+            .startSize = 0.1f,
+            .startColor = glm::vec4(0.4f, 0.7f, 1.0f, 0.8f),
+            .endColor = glm::vec4(1.0f, 1.0f, 1.0f, 0.0f),
+            .seed = static_cast<std::uint32_t>(i + 1),
+        });
+    }
+    return true;
+}
+
+// Point lights just above the objects, each reaching a few of its neighbours
+void add_lights(tel::Scene& scene, std::size_t lightCount, float extent, float spacing) {
+    std::mt19937 random(4321);
+    std::uniform_real_distribution<float> across(-0.5f * extent, 0.5f * extent);
+    std::uniform_real_distribution<float> height(1.0f, 4.0f);
+    std::uniform_real_distribution<float> channel(0.2f, 1.0f);
+    scene.lights.reserve(lightCount);
+    for (std::size_t i = 0; i < lightCount; ++i) {
+        const glm::vec3 position(across(random), height(random), across(random));
+        const glm::vec3 color(channel(random), channel(random), channel(random));
+        scene.lights.push_back(tel::Light{.position = position, .radius = 2.5f * spacing, .color = color});
+    }
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    const auto arguments = parse_arguments(argc, argv);
+    if (!arguments) {
+        std::cerr << "Usage: " << argv[0]
+                  << " [--frames N] [--objects N] [--particles N] [--lights N] [--target-ms N]"
+                     " [--path keyframes.txt] [--csv frames.csv]\n";
+        return 2;
+    }
+
+    tel::RenderingOptions rendering;
+    if (arguments->targetMilliseconds) {
+        rendering.resolution = {.enabled = true,
+                                .targetFrameMilliseconds = static_cast<double>(*arguments->targetMilliseconds)};
+    }
+    tel::Engine engine({.width = 1280,
+                        .height = 720,
+                        .title = "hazor-flythrough",
+                        .visible = false,
+                        .vsync = false,
+                        .rendering = rendering});
+    constexpr float spacing = 3.0f;
+    const float extent = spacing * std::ceil(std::sqrt(static_cast<float>(arguments->objects)));
+    if (!build_scene(engine, arguments->objects, spacing) ||
+        (arguments->particles > 0 && !add_fountains(engine, arguments->particles, extent))) {
+        std::cerr << "Could not load the flythrough assets\n";
+        return 1;
+    }
+    add_lights(engine.current_scene(), arguments->lights, extent, spacing);
+
+    tel::CameraPath path;
+    if (arguments->path) {
+        const auto text = tel::load_file(*arguments->path);
+        if (!text) {
+            std::cerr << "Could not read " << *arguments->path << '\n';
+            return 1;
+        }
+        auto parsed = tel::CameraPath::parse(*text);
+        if (!parsed || parsed->empty()) {
+            std::cerr << *arguments->path << ": no keyframes"
+                      << (parsed ? std::string() : std::format(", error on line {}", parsed.error().line)) << '\n';
+            return 1;
+        }
+        path = std::move(parsed.value());
+    } else {
+        path = orbit_path(extent);
+    }
+
+    const tel::FrameProfiler profiler = engine.run_flythrough(path, {.frames = arguments->frames});
+    profiler.write_summary(std::cout);
+    if (arguments->targetMilliseconds) {
+        const tel::DynamicResolution& resolution = engine.rendering_system().dynamic_resolution();
+        std::cout << std::format("Resolution scale {:.2f} after {} changes\n", resolution.scale(),
+                                 resolution.scale_changes());
+    }
+    for (const auto& [category, stats] : tel::gpu_memory_tracker().report()) {
+        std::cout << std::format("GPU {}: {:.1f} MiB, peak {:.1f} MiB\n", tel::to_string(category),
+                                 static_cast<double>(stats.bytes) / (1 << 20),
+                                 static_cast<double>(stats.highWaterBytes) / (1 << 20));
+    }
+    if (arguments->csv) {
+        std::ofstream csv{std::string(*arguments->csv)};
+        profiler.write_csv(csv);
+        if (!csv) {
+            std::cerr << "Could not write " << *arguments->csv << '\n';
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,40 @@
+#include "ClusteredLighting.hpp"
+#include "ThreadPool.hpp"
+
+#include <benchmark/benchmark.h>
+#include <random>
+#include <vector>
+
+namespace {
+// Lights scattered through a street-sized box in front of the camera, each reaching a few metres
+std::vector<tel::Light> scatter_lights(std::size_t count) {
+    std::mt19937 random(99);
+    std::uniform_real_distribution<float> across(-100.0f, 100.0f);
+    std::uniform_real_distribution<float> height(0.0f, 10.0f);
+    std::uniform_real_distribution<float> depth(-200.0f, 0.0f);
+    std::uniform_real_distribution<float> radius(2.0f, 8.0f);
+    std::vector<tel::Light> lights;
+    lights.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        lights.push_back(tel::Light{.type = i % 4 == 0 ? tel::LightType::Spot : tel::LightType::Point,
+                                    .position = glm::vec3(across(random), height(random), depth(random)),
+                                    .radius = radius(random)});
+    }
+    return lights;
+}
+
+void bin_lights(benchmark::State& state) {
+    static tel::ThreadPool threadPool;
+    tel::ClusteredLighting lighting(&threadPool);
+    const auto lights = scatter_lights(static_cast<std::size_t>(state.range(0)));
+    const tel::Camera camera = tel::Camera::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 250.0f);
+    for (auto _ : state) {
+        lighting.update(lights, camera, 1920, 1080);
+        benchmark::DoNotOptimize(lighting.light_indices().data());
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * lights.size()));
+    state.counters["indices"] = static_cast<double>(lighting.light_indices().size());
+}
+
+BENCHMARK(bin_lights)->Arg(100)->Arg(1'000)->Arg(10'000)->Unit(benchmark::kMicrosecond);
+} // namespace
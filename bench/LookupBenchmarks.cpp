@@ -0,0 +1,47 @@
+#include "ResourceLookup.hpp"
+
+#include <benchmark/benchmark.h>
+#include <random>
+#include <vector>
+
+namespace {
+struct Resource {
+    unsigned int payload[4];
+};
+
+void lookup_add(benchmark::State& state) {
+    const auto count = static_cast<unsigned int>(state.range(0));
+    for (auto _ : state) {
+        tel::ResourceLookup<Resource> lookup;
+        for (unsigned int i = 0; i < count; ++i) {
+            benchmark::DoNotOptimize(lookup.add(Resource{{i, i, i, i}}));
+        }
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * count));
+}
+
+BENCHMARK(lookup_add)->RangeMultiplier(10)->Range(1'000, 1'000'000)->Unit(benchmark::kMillisecond);
+
+void lookup_find(benchmark::State& state) {
+    const auto count = static_cast<unsigned int>(state.range(0));
+    tel::ResourceLookup<Resource> lookup;
+    for (unsigned int i = 0; i < count; ++i) {
+        lookup.add(Resource{{i, i, i, i}});
+    }
+    // Random order so the benchmark measures the lookup rather than a prefetch-friendly sweep
+    std::vector<unsigned int> keys(4096);
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<unsigned int> distribution(0, count - 1);
+    for (auto& key : keys) {
+        key = distribution(generator);
+    }
+    std::size_t next = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(lookup.find(keys[next]));
+        next = (next + 1) % keys.size();
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()));
+}
+
+BENCHMARK(lookup_find)->RangeMultiplier(10)->Range(1'000, 1'000'000);
+} // namespace
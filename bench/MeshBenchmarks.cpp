@@ -0,0 +1,64 @@
+#include "MeshLoading.hpp"
+#include "SyntheticData.hpp"
+#include "ThreadPool.hpp"
+
+#include <benchmark/benchmark.h>
+
+namespace {
+void load_synthetic_obj(benchmark::State& state) {
+    const std::string obj = tel::bench::make_grid_obj(static_cast<int>(state.range(0)));
+    for (auto _ : state) {
+        auto mesh = tel::load_mesh_from_memory(obj);
+        benchmark::DoNotOptimize(mesh);
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * obj.size()));
+    state.counters["bytes"] = static_cast<double>(obj.size());
+}
+
+BENCHMARK(load_synthetic_obj)->RangeMultiplier(4)->Range(16, 1024)->Unit(benchmark::kMillisecond);
+
+void load_synthetic_obj_parallel(benchmark::State& state) {
+    static tel::ThreadPool threadPool;
+    const std::string obj = tel::bench::make_grid_obj(static_cast<int>(state.range(0)));
+    for (auto _ : state) {
+        auto mesh = tel::load_mesh_from_memory(obj, &threadPool);
+        benchmark::DoNotOptimize(mesh);
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * obj.size()));
+    state.counters["bytes"] = static_cast<double>(obj.size());
+}
+
+BENCHMARK(load_synthetic_obj_parallel)->RangeMultiplier(4)->Range(16, 1024)->Unit(benchmark::kMillisecond);
+
+void load_embedded_obj(benchmark::State& state) {
+    const std::string obj = tel::bench::embedded_file("Test.obj");
+    for (auto _ : state) {
+        auto mesh = tel::load_mesh_from_memory(obj);
+        benchmark::DoNotOptimize(mesh);
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * obj.size()));
+}
+
+BENCHMARK(load_embedded_obj)->Unit(benchmark::kMicrosecond);
+
+void join_meshes(benchmark::State& state) {
+    const tel::Mesh mesh = tel::bench::make_grid_mesh(static_cast<int>(state.range(0)));
+    for (auto _ : state) {
+        auto joined = tel::join(mesh, mesh);
+        benchmark::DoNotOptimize(joined);
+    }
+    state.counters["vertices"] = static_cast<double>(mesh.positions.size());
+}
+
+BENCHMARK(join_meshes)->RangeMultiplier(4)->Range(64, 2048)->Unit(benchmark::kMillisecond);
+
+void validate_mesh(benchmark::State& state) {
+    const tel::Mesh mesh = tel::bench::make_grid_mesh(static_cast<int>(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(tel::mesh_is_valid(mesh));
+    }
+    state.counters["vertices"] = static_cast<double>(mesh.positions.size());
+}
+
+BENCHMARK(validate_mesh)->RangeMultiplier(4)->Range(64, 2048)->Unit(benchmark::kMillisecond);
+} // namespace
@@ -0,0 +1,76 @@
+#include "AllocationCounting.hpp"
+#include "Meshlets.hpp"
+#include "ThreadPool.hpp"
+
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <glm/ext/matrix_transform.hpp>
+#include <numbers>
+#include <vector>
+
+namespace {
+// A closed UV sphere of radius 10 with counter-clockwise front faces, 2 * rings * segments triangles
+tel::Mesh make_sphere_mesh(int rings, int segments) {
+    tel::Mesh mesh;
+    mesh.reserve((rings + 1) * (segments + 1));
+    for (int ring = 0; ring <= rings; ++ring) {
+        for (int segment = 0; segment <= segments; ++segment) {
+            const float polar = std::numbers::pi_v<float> * static_cast<float>(ring) / rings;
+            const float azimuth = 2.0f * std::numbers::pi_v<float> * static_cast<float>(segment) / segments;
+            const glm::vec3 normal(std::sin(polar) * std::cos(azimuth), std::cos(polar),
+                                   std::sin(polar) * std::sin(azimuth));
+            mesh.positions.push_back(normal * 10.0f);
+            mesh.normals.push_back(normal);
+            mesh.texCoords.emplace_back(static_cast<float>(segment) / segments, static_cast<float>(ring) / rings);
+        }
+    }
+    for (int ring = 0; ring < rings; ++ring) {
+        for (int segment = 0; segment < segments; ++segment) {
+            const auto corner = static_cast<tel::TriangleIndex>(ring * (segments + 1) + segment);
+            const auto below = static_cast<tel::TriangleIndex>(corner + segments + 1);
+            mesh.triangles.insert(mesh.triangles.end(), {corner, corner + 1, below, corner + 1, below + 1, below});
+        }
+    }
+    return mesh;
+}
+
+void build_meshlets(benchmark::State& state) {
+    const int rings = static_cast<int>(state.range(0));
+    const tel::Mesh sphere = make_sphere_mesh(rings, 2 * rings);
+    for (auto _ : state) {
+        const tel::MeshletMesh meshlets = tel::build_meshlets(sphere);
+        benchmark::DoNotOptimize(meshlets.meshlets.data());
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * sphere.triangles.size() / 3));
+}
+
+// A row of spheres seen from one end, so frustum and cone culling both have something to do
+void cull_meshlets(benchmark::State& state) {
+    static tel::ThreadPool threadPool;
+    tel::MeshletCulling culling(&threadPool, {.enabled = true});
+    const tel::MeshletMesh meshlets = tel::build_meshlets(make_sphere_mesh(256, 512));
+    std::vector<tel::MeshletInstance> instances;
+    for (std::int64_t i = 0; i < state.range(0); ++i) {
+        const glm::vec3 offset(25.0f * static_cast<float>(i % 8), 0.0f, -25.0f * static_cast<float>(i / 8));
+        instances.push_back({.meshlets = meshlets.meshlets,
+                             .transform = glm::translate(glm::identity<glm::mat4>(), offset)});
+    }
+    tel::Camera camera = tel::Camera::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 1000.0f);
+    camera.transform =
+        glm::lookAt(glm::vec3(0.0f, 30.0f, 60.0f), glm::vec3(0.0f, 0.0f, -100.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    culling.cull(instances, camera);
+    const std::size_t allocationsBefore = tel::bench::heap_allocations();
+    for (auto _ : state) {
+        culling.cull(instances, camera);
+        benchmark::DoNotOptimize(culling.draw_ranges(0).data());
+    }
+    tel::bench::report_allocations(state, allocationsBefore);
+    const std::size_t meshletsPerCull = instances.size() * meshlets.meshlets.size();
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * meshletsPerCull));
+    state.counters["culled"] =
+        static_cast<double>(culling.meshlets_culled()) / static_cast<double>(culling.meshlets_tested());
+}
+
+BENCHMARK(build_meshlets)->Arg(64)->Arg(256)->Unit(benchmark::kMillisecond);
+BENCHMARK(cull_meshlets)->Arg(1)->Arg(16)->Arg(64)->Unit(benchmark::kMicrosecond);
+} // namespace
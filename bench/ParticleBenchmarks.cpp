@@ -0,0 +1,54 @@
+#include "Particles.hpp"
+#include "ThreadPool.hpp"
+
+#include <benchmark/benchmark.h>
+#include <vector>
+
+namespace {
+constexpr float frameSeconds = 1.0f / 60.0f;
+
+// Four emitters that together keep about the given number of particles alive, run until they have filled up
+void fill(tel::ParticleSystem& system, std::size_t particles) {
+    constexpr std::size_t emitters = 4;
+    constexpr float lifetime = 2.0f;
+    for (std::size_t i = 0; i < emitters; ++i) {
+        system.create_emitter({.shader = 0u,
+                               .rate = static_cast<float>(particles / emitters) / lifetime,
+                               .maxParticles = particles / emitters,
+                               .lifetime = lifetime,
+                               .drag = 0.1f,
+                               .seed = static_cast<std::uint32_t>(i + 1)});
+    }
+    for (float time = 0.0f; time < lifetime + 0.5f; time += frameSeconds) {
+        system.update(frameSeconds);
+    }
+}
+
+void update_particles(benchmark::State& state) {
+    static tel::ThreadPool threadPool;
+    tel::ParticleSystem particles(&threadPool);
+    fill(particles, static_cast<std::size_t>(state.range(0)));
+    for (auto _ : state) {
+        particles.update(frameSeconds);
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * particles.particle_count()));
+    state.counters["particles"] = static_cast<double>(particles.particle_count());
+}
+
+BENCHMARK(update_particles)->Arg(100'000)->Arg(300'000)->Arg(1'000'000)->Unit(benchmark::kMillisecond);
+
+void write_particle_instances(benchmark::State& state) {
+    static tel::ThreadPool threadPool;
+    tel::ParticleSystem particles(&threadPool);
+    fill(particles, static_cast<std::size_t>(state.range(0)));
+    std::vector<tel::ParticleInstance> instances(particles.particle_count());
+    for (auto _ : state) {
+        particles.write_instances(instances);
+        benchmark::DoNotOptimize(instances.data());
+    }
+    state.SetBytesProcessed(
+        static_cast<std::int64_t>(state.iterations() * instances.size() * sizeof(tel::ParticleInstance)));
+}
+
+BENCHMARK(write_particle_instances)->Arg(100'000)->Arg(300'000)->Arg(1'000'000)->Unit(benchmark::kMillisecond);
+} // namespace
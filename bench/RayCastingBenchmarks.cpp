@@ -0,0 +1,70 @@
+#include "RayCasting.hpp"
+#include "SyntheticData.hpp"
+
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <glm/geometric.hpp>
+#include <random>
+#include <vector>
+
+namespace {
+// A million-triangle grid at 708 quads a side, bent so rays meet it at every angle
+tel::Mesh make_wavy_grid(int side) {
+    tel::Mesh mesh = tel::bench::make_grid_mesh(side);
+    for (tel::Position& position : mesh.positions) {
+        position.y = 4.0f * std::sin(0.05f * position.x) * std::cos(0.05f * position.z);
+    }
+    return mesh;
+}
+
+std::vector<tel::Ray> make_rays(int side, std::size_t count) {
+    std::mt19937 random(42);
+    std::uniform_real_distribution<float> coordinate(0.0f, static_cast<float>(side));
+    std::vector<tel::Ray> rays;
+    rays.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        const glm::vec3 origin(coordinate(random), 50.0f, coordinate(random));
+        const glm::vec3 target(coordinate(random), 0.0f, coordinate(random));
+        rays.emplace_back(tel::Ray{.origin = origin, .direction = glm::normalize(target - origin)});
+    }
+    return rays;
+}
+
+void build_mesh_bvh(benchmark::State& state) {
+    const tel::Mesh mesh = make_wavy_grid(static_cast<int>(state.range(0)));
+    for (auto _ : state) {
+        auto bvh = tel::MeshBvh::build(mesh);
+        benchmark::DoNotOptimize(bvh);
+    }
+    state.counters["triangles"] = static_cast<double>(mesh.triangles.size() / 3);
+}
+
+BENCHMARK(build_mesh_bvh)->Arg(64)->Arg(256)->Arg(708)->Unit(benchmark::kMillisecond);
+
+void closest_hit(benchmark::State& state) {
+    const int side = static_cast<int>(state.range(0));
+    const tel::MeshBvh bvh = tel::MeshBvh::build(make_wavy_grid(side));
+    const std::vector<tel::Ray> rays = make_rays(side, 1024);
+    std::size_t next = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(bvh.closest_hit(rays[next]));
+        next = (next + 1) % rays.size();
+    }
+    state.counters["triangles"] = static_cast<double>(bvh.triangle_count());
+}
+
+BENCHMARK(closest_hit)->Arg(64)->Arg(256)->Arg(708)->Unit(benchmark::kMicrosecond);
+
+void any_hit(benchmark::State& state) {
+    const int side = static_cast<int>(state.range(0));
+    const tel::MeshBvh bvh = tel::MeshBvh::build(make_wavy_grid(side));
+    const std::vector<tel::Ray> rays = make_rays(side, 1024);
+    std::size_t next = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(bvh.any_hit(rays[next]));
+        next = (next + 1) % rays.size();
+    }
+}
+
+BENCHMARK(any_hit)->Arg(64)->Arg(256)->Arg(708)->Unit(benchmark::kMicrosecond);
+} // namespace
@@ -0,0 +1,89 @@
+#include "AllocationCounting.hpp"
+#include "MeshLoading.hpp"
+#include "Rendering.hpp"
+#include "SyntheticData.hpp"
+#include "ThreadPool.hpp"
+
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <glm/ext/matrix_transform.hpp>
+
+namespace {
+// One hidden window shared by every GL benchmark. Run with LIBGL_ALWAYS_SOFTWARE=1 to measure under Mesa's software
+// rasterizer, which keeps numbers comparable between machines without a GPU.
+struct GLContext {
+    tel::ThreadPool threadPool;
+    tel::Window window{1280, 720, "hazor-bench", false};
+    tel::FrameArena frameArena{1 << 20};
+    tel::Rendering rendering{&window, &threadPool, &frameArena};
+};
+
+GLContext& gl_context() {
+    static GLContext context;
+    return context;
+}
+
+tel::Program compile_main_program() {
+    const auto source = [](std::string_view path) {
+        return tel::resolve_shader_includes(tel::bench::embedded_file(path)).value();
+    };
+    auto vertexShader = tel::Shader<tel::ShaderType::Vertex>::create(source("shaders/Main.vert")).value();
+    auto fragmentShader = tel::Shader<tel::ShaderType::Fragment>::create(source("shaders/Main.frag")).value();
+    return tel::Program::create(vertexShader, fragmentShader, {}).value();
+}
+
+void uniform_location(benchmark::State& state) {
+    gl_context();
+    const tel::Program program = compile_main_program();
+    constexpr std::string_view names[] = {"model", "camera", "useAlbedo", "missing"};
+    std::size_t next = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(program.get_uniform_location(names[next]));
+        next = (next + 1) % std::size(names);
+    }
+}
+
+BENCHMARK(uniform_location);
+
+void render_synthetic_scene(benchmark::State& state) {
+    auto& context = gl_context();
+    const auto shader = context.rendering.load_shader(tel::bench::embedded_file("shaders/Main.vert"),
+                                                      tel::bench::embedded_file("shaders/Main.frag"));
+    const auto mesh = tel::load_mesh_from_memory(tel::bench::embedded_file("Test.obj"));
+    if (!shader || !mesh) {
+        state.SkipWithError("Could not load the benchmark assets");
+        return;
+    }
+    const tel::MeshHandle meshHandle = context.rendering.load_mesh(mesh.value());
+
+    const auto objectCount = static_cast<int>(state.range(0));
+    const int side = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(objectCount))));
+    tel::Scene scene{.camera = tel::Camera::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 1000.0f)};
+    scene.camera.transform = glm::lookAt(glm::vec3(0.0f, 0.5f * side, 1.5f * side), glm::vec3(0.0f),
+                                         glm::vec3(0.0f, 1.0f, 0.0f));
+    scene.sceneObjects.reserve(objectCount);
+    for (int i = 0; i < objectCount; ++i) {
+        const glm::vec3 position(3.0f * (i % side - side / 2), 0.0f, -3.0f * (i / side - side / 2));
+        scene.sceneObjects.emplace_back(tel::SceneObject{
+            .transform = glm::translate(glm::identity<glm::mat4>(), position),
+            .renderable = {.shader = shader.value(), .mesh = meshHandle},
+        });
+    }
+
+    // The first frame sizes the scratch buffers; every frame after it should allocate nothing
+    context.frameArena.reset();
+    context.rendering.render_scene(scene);
+    glFinish();
+    const std::size_t allocationsBefore = tel::bench::heap_allocations();
+    for (auto _ : state) {
+        context.frameArena.reset();
+        context.rendering.render_scene(scene);
+        // Include the GPU's share of the frame, not just command submission
+        glFinish();
+    }
+    tel::bench::report_allocations(state, allocationsBefore);
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()) * objectCount);
+}
+
+BENCHMARK(render_synthetic_scene)->RangeMultiplier(10)->Range(1'000, 100'000)->Unit(benchmark::kMillisecond);
+} // namespace
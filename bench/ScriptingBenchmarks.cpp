@@ -0,0 +1,56 @@
+#include "Scripting.hpp"
+
+#include <benchmark/benchmark.h>
+#include <glm/ext/matrix_transform.hpp>
+
+namespace {
+// Both scripts move every object by its own velocity; one crosses into C++ a few times per frame, the other several
+// times per object
+constexpr std::string_view bulkScript = R"(
+local velocities = nil
+return {
+    update = function(scene, dt)
+        if velocities == nil or #velocities ~= 3 * #scene.objects then
+            velocities = FloatArray.new(3 * #scene.objects, 1.0)
+        end
+        scene.objects:translate(velocities, dt)
+    end
+}
+)";
+
+constexpr std::string_view perObjectScript = R"(
+return {
+    update = function(scene, dt)
+        local objects = scene.objects
+        for i = 1, #objects do
+            local x, y, z = objects:position(i)
+            objects:set_position(i, x + dt, y + dt, z + dt)
+        end
+    end
+}
+)";
+
+void run_script(benchmark::State& state, std::string_view source) {
+    tel::Scripting scripting;
+    if (!scripting.load_script("bench", source)) {
+        state.SkipWithError("Could not load the script");
+        return;
+    }
+    tel::Scene scene{.camera = tel::Camera::perspective(1.0f, 1.0f, 0.1f, 100.0f)};
+    for (std::int64_t i = 0; i < state.range(0); ++i) {
+        scene.sceneObjects.push_back({.transform = glm::identity<glm::mat4>(), .renderable = {.shader = 0, .mesh = 0}});
+    }
+    for (auto _ : state) {
+        scripting.update(scene, 1.0f / 60.0f);
+        benchmark::DoNotOptimize(scene.sceneObjects.data());
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * scene.sceneObjects.size()));
+}
+
+void update_bulk(benchmark::State& state) { run_script(state, bulkScript); }
+
+void update_per_object(benchmark::State& state) { run_script(state, perObjectScript); }
+
+BENCHMARK(update_bulk)->Arg(1'000)->Arg(10'000)->Arg(100'000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(update_per_object)->Arg(1'000)->Arg(10'000)->Arg(100'000)->Unit(benchmark::kMicrosecond);
+} // namespace
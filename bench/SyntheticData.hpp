@@ -0,0 +1,56 @@
+#pragma once
+#include "EmbeddedAssets.hpp"
+#include "Mesh.hpp"
+
+#include <format>
+#include <iterator>
+#include <string>
+#include <string_view>
+
+namespace tel::bench {
+inline std::string embedded_file(std::string_view path) { return embedded_assets().read(path).value(); }
+
+// A flat grid of side x side quads written as a Wavefront OBJ with positions, texture coordinates and normals
+inline std::string make_grid_obj(int side) {
+    std::string obj;
+    auto out = std::back_inserter(obj);
+    std::format_to(out, "o Grid\n");
+    for (int y = 0; y <= side; ++y) {
+        for (int x = 0; x <= side; ++x) {
+            std::format_to(out, "v {} 0.0 {}\n", static_cast<float>(x), static_cast<float>(y));
+            std::format_to(out, "vt {} {}\n", static_cast<float>(x) / side, static_cast<float>(y) / side);
+        }
+    }
+    std::format_to(out, "vn 0.0 1.0 0.0\n");
+    for (int y = 0; y < side; ++y) {
+        for (int x = 0; x < side; ++x) {
+            // OBJ indices are 1-based
+            const int corner = y * (side + 1) + x + 1;
+            const int above = corner + side + 1;
+            std::format_to(out, "f {0}/{0}/1 {1}/{1}/1 {2}/{2}/1 {3}/{3}/1\n", corner, corner + 1, above + 1, above);
+        }
+    }
+    return obj;
+}
+
+inline Mesh make_grid_mesh(int side) {
+    Mesh mesh;
+    mesh.reserve((side + 1) * (side + 1));
+    for (int y = 0; y <= side; ++y) {
+        for (int x = 0; x <= side; ++x) {
+            mesh.positions.emplace_back(static_cast<float>(x), 0.0f, static_cast<float>(y));
+            mesh.normals.emplace_back(0.0f, 1.0f, 0.0f);
+            mesh.texCoords.emplace_back(static_cast<float>(x) / side, static_cast<float>(y) / side);
+        }
+    }
+    for (int y = 0; y < side; ++y) {
+        for (int x = 0; x < side; ++x) {
+            const auto corner = static_cast<TriangleIndex>(y * (side + 1) + x);
+            const auto above = static_cast<TriangleIndex>(corner + side + 1);
+            mesh.triangles.append_range(std::initializer_list<TriangleIndex>{corner, corner + 1, above + 1});
+            mesh.triangles.append_range(std::initializer_list<TriangleIndex>{corner, above + 1, above});
+        }
+    }
+    return mesh;
+}
+} // namespace tel::bench
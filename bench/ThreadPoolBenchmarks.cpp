@@ -0,0 +1,28 @@
+#include "AllocationCounting.hpp"
+#include "ThreadPool.hpp"
+
+#include <benchmark/benchmark.h>
+#include <vector>
+
+namespace {
+// The cost of splitting work up, with chunks too small for the work itself to matter
+void parallel_for(benchmark::State& state) {
+    static tel::ThreadPool threadPool;
+    std::vector<float> values(static_cast<std::size_t>(state.range(0)), 1.0f);
+    const auto update_values = [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            values[i] = values[i] * 0.5f + 1.0f;
+        }
+    };
+    threadPool.parallel_for(values.size(), 64, update_values);
+    const std::size_t allocationsBefore = tel::bench::heap_allocations();
+    for (auto _ : state) {
+        threadPool.parallel_for(values.size(), 64, update_values);
+        benchmark::DoNotOptimize(values.data());
+    }
+    tel::bench::report_allocations(state, allocationsBefore);
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * values.size()));
+}
+
+BENCHMARK(parallel_for)->Arg(1'024)->Arg(65'536)->Unit(benchmark::kMicrosecond);
+} // namespace
@@ -0,0 +1,83 @@
+#!/usr/bin/env python3
+"""Compares a hazor-bench JSON report against a stored baseline and flags regressions.
+
+The usual way to run it is through the build, which runs hazor-bench and compares against bench/baseline.json:
+    cmake --build build --config Release --target bench-compare
+
+On the reference machine, after a change that is meant to move the numbers, store a new baseline and commit it:
+    cmake --build build --config Release --target bench-baseline
+
+To compare a report produced by hand, e.g. with a filter:
+    hazor-bench --benchmark_format=json --benchmark_out=current.json --benchmark_repetitions=5 \
+        --benchmark_report_aggregates_only=true
+    bench/compare_benchmarks.py current.json
+
+Exits with status 1 when any benchmark is slower than the baseline by more than the threshold, or when a benchmark
+of per-frame work reports heap allocations.
+"""
+
+import argparse
+import json
+import sys
+from pathlib import Path
+
+
+def load_runs(path):
+    with open(path) as report:
+        benchmarks = json.load(report)["benchmarks"]
+    runs = {}
+    for benchmark in benchmarks:
+        # With repetitions only the median is compared; it is the most stable of the aggregates
+        if benchmark.get("run_type") == "aggregate" and benchmark.get("aggregate_name") != "median":
+            continue
+        if benchmark.get("error_occurred"):
+            continue
+        runs[benchmark["run_name"] if "run_name" in benchmark else benchmark["name"]] = benchmark
+    return runs
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("current", type=Path)
+    parser.add_argument("--baseline", type=Path, default=Path(__file__).with_name("baseline.json"))
+    parser.add_argument("--threshold", type=float, default=0.10,
+                        help="relative slowdown that counts as a regression (default: 0.10)")
+    parser.add_argument("--metric", choices=["real_time", "cpu_time"], default="real_time")
+    args = parser.parse_args()
+
+    if not args.baseline.exists():
+        print(f"No baseline at {args.baseline}; store one from a known-good build with the bench-baseline target.")
+        return 2
+
+    baseline = {name: run[args.metric] for name, run in load_runs(args.baseline).items()}
+    current_runs = load_runs(args.current)
+    current = {name: run[args.metric] for name, run in current_runs.items()}
+
+    regressions = 0
+    width = max((len(name) for name in current), default=0)
+    for name, time in sorted(current.items()):
+        # Benchmarks of per-frame work count their heap allocations, and any at all is a regression
+        allocations = current_runs[name].get("allocations", 0)
+        allocation_flag = f"  ALLOCATES {allocations:g} per iteration" if allocations > 0 else ""
+        if allocation_flag:
+            regressions += 1
+        if name not in baseline:
+            print(f"{name:<{width}}  new{allocation_flag}")
+            continue
+        change = (time - baseline[name]) / baseline[name]
+        flag = ""
+        if change > args.threshold:
+            flag = "  REGRESSION"
+            regressions += 1
+        elif change < -args.threshold:
+            flag = "  improved"
+        print(f"{name:<{width}}  {baseline[name]:>14.3f} -> {time:>14.3f}  {change:+8.1%}{flag}{allocation_flag}")
+    for name in sorted(baseline.keys() - current.keys()):
+        print(f"{name:<{width}}  missing from current report")
+
+    print(f"\n{regressions} regression(s) over {args.threshold:.0%}")
+    return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
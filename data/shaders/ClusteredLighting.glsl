@@ -0,0 +1,60 @@
+// Point and spot lights binned by tel::ClusteredLighting into clusters of the view frustum; each fragment only visits
+// the lights of its own cluster. Layouts must match ClusteredLighting.hpp.
+struct ClusterLight {
+    vec4 positionRadius;
+    vec4 colorIntensity;
+    // w is the cosine of the outer cone angle, or below -1 for point lights
+    vec4 directionCosOuter;
+    vec4 cosInner;
+};
+
+layout (std430, binding = 1) readonly buffer ClusterLights {
+    ClusterLight clusterLights[];
+};
+
+// Offset into clusterLightIndices and count, per cluster
+layout (std430, binding = 2) readonly buffer ClusterRanges {
+    uvec2 clusterRanges[];
+};
+
+layout (std430, binding = 3) readonly buffer ClusterLightIndices {
+    uint clusterLightIndices[];
+};
+
+layout (std430, binding = 4) readonly buffer ClusterGrid {
+    mat4 clusterView;
+    // Tiles across, tiles up, depth slices, and whether slices are spaced by the log of depth
+    uvec4 clusterGridSize;
+    // Pixels to tiles, then depth to slices as scale and bias
+    vec4 clusterSlicing;
+};
+
+uint cluster_index(vec3 worldPosition) {
+    float depth = -(clusterView * vec4(worldPosition, 1.0)).z;
+    float slicedDepth = clusterGridSize.w != 0u ? log(max(depth, 1e-30)) : depth;
+    vec3 position = vec3(gl_FragCoord.xy * clusterSlicing.xy, slicedDepth * clusterSlicing.z + clusterSlicing.w);
+    uvec3 cell = uvec3(clamp(ivec3(floor(position)), ivec3(0), ivec3(clusterGridSize.xyz) - 1));
+    return cell.x + clusterGridSize.x * (cell.y + clusterGridSize.y * cell.z);
+}
+
+// Diffuse light reaching a surface from every light in its cluster
+vec3 clustered_lighting(vec3 worldPosition, vec3 normal) {
+    uvec2 range = clusterRanges[cluster_index(worldPosition)];
+    vec3 total = vec3(0.0);
+    for (uint i = range.x; i < range.x + range.y; ++i) {
+        ClusterLight light = clusterLights[clusterLightIndices[i]];
+        vec3 toLight = light.positionRadius.xyz - worldPosition;
+        float distanceSquared = dot(toLight, toLight);
+        vec3 direction = toLight * inversesqrt(max(distanceSquared, 1e-8));
+        // Inverse square, windowed to reach zero at the light's radius so cutting it off there leaves no seam
+        float ratio = distanceSquared / (light.positionRadius.w * light.positionRadius.w);
+        float window = clamp(1.0 - ratio * ratio, 0.0, 1.0);
+        float attenuation = window * window / (distanceSquared + 1.0);
+        if (light.directionCosOuter.w >= -1.0) {
+            float cosAngle = dot(-direction, light.directionCosOuter.xyz);
+            attenuation *= smoothstep(light.directionCosOuter.w, light.cosInner.x, cosAngle);
+        }
+        total += light.colorIntensity.rgb * light.colorIntensity.a * attenuation * max(dot(normal, direction), 0.0);
+    }
+    return total;
+}
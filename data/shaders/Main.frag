@@ -1,11 +1,21 @@
 #version 450 core
 
+#include "ClusteredLighting.glsl"
+
 in vec3 interNormal;
+in vec2 interTexCoord;
+in vec3 interWorldPosition;
+
+uniform sampler2DArray albedo;
+uniform int albedoLayer;
+uniform bool useAlbedo;
 
 vec3 lightDir = normalize(vec3(0.0f, 0.0f, -1.0f));
 
 void main() {
     vec3 normal = normalize(interNormal);
     float diff = max(dot(normal, -lightDir), 0.0f);
-    gl_FragColor = vec4(vec3(1.0f, 1.0f, 1.0f) * (diff + 0.1), 1.0f);
+    vec3 color = useAlbedo ? texture(albedo, vec3(interTexCoord, albedoLayer)).rgb : vec3(1.0f, 1.0f, 1.0f);
+    vec3 lighting = vec3(diff + 0.1) + clustered_lighting(interWorldPosition, normal);
+    gl_FragColor = vec4(color * lighting, 1.0f);
 }
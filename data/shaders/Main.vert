@@ -2,14 +2,33 @@
 
 layout (location = 0) in vec3 position;
 layout (location = 1) in vec3 normal;
+layout (location = 2) in vec2 texCoord;
+layout (location = 3) in uvec4 joints;
+layout (location = 4) in vec4 weights;
+
+layout (std430, binding = 0) readonly buffer SkinningPalettes {
+    mat4 palettes[];
+};
 
 out vec3 interNormal;
+out vec2 interTexCoord;
+out vec3 interWorldPosition;
 
 uniform mat4 model;
 uniform mat4 camera;
+// Where the object's joint matrices start in palettes, negative if it is not animated
+uniform int paletteOffset = -1;
 
 void main() {
-    vec4 worldPosition = model * vec4(position, 1.0);
-    interNormal = mat3(transpose(inverse(model))) * normal;
+    mat4 skinnedModel = model;
+    if (paletteOffset >= 0) {
+        uvec4 indices = uint(paletteOffset) + joints;
+        skinnedModel = model * (weights.x * palettes[indices.x] + weights.y * palettes[indices.y] +
+                                weights.z * palettes[indices.z] + weights.w * palettes[indices.w]);
+    }
+    vec4 worldPosition = skinnedModel * vec4(position, 1.0);
+    interNormal = mat3(transpose(inverse(skinnedModel))) * normal;
+    interTexCoord = texCoord;
+    interWorldPosition = worldPosition.xyz;
     gl_Position = camera * worldPosition;
 }
@@ -0,0 +1,15 @@
+#version 450 core
+
+in vec2 interCorner;
+in vec4 interColor;
+
+out vec4 fragColor;
+
+void main() {
+    // Round, with the edge faded out
+    float falloff = 1.0 - smoothstep(0.5, 1.0, length(interCorner));
+    if (falloff <= 0.0) {
+        discard;
+    }
+    fragColor = vec4(interColor.rgb, interColor.a * falloff);
+}
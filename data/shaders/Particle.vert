@@ -0,0 +1,20 @@
+#version 450 core
+
+layout (location = 0) in vec4 positionSize;
+layout (location = 1) in vec4 color;
+
+out vec2 interCorner;
+out vec4 interColor;
+
+uniform mat4 camera;
+uniform vec3 cameraRight;
+uniform vec3 cameraUp;
+
+void main() {
+    // A triangle strip over the corners of a camera-facing square, from (-1, -1) to (1, 1)
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1) * 2.0 - 1.0;
+    vec3 worldPosition = positionSize.xyz + (cameraRight * corner.x + cameraUp * corner.y) * positionSize.w;
+    interCorner = corner;
+    interColor = color;
+    gl_Position = camera * vec4(worldPosition, 1.0);
+}
@@ -0,0 +1,28 @@
+#version 450 core
+
+in vec2 interTexCoord;
+
+out vec4 fragColor;
+
+uniform sampler2D scene;
+// 0 for bilinear, 1 for edge-aware
+uniform int upscaleFilter;
+
+void main() {
+    vec3 color = texture(scene, interTexCoord).rgb;
+    if (upscaleFilter == 1) {
+        // The four neighbours one source texel away bound how far sharpening may push the colour
+        vec2 texel = 1.0 / vec2(textureSize(scene, 0));
+        vec3 left = texture(scene, interTexCoord - vec2(texel.x, 0.0)).rgb;
+        vec3 right = texture(scene, interTexCoord + vec2(texel.x, 0.0)).rgb;
+        vec3 down = texture(scene, interTexCoord - vec2(0.0, texel.y)).rgb;
+        vec3 up = texture(scene, interTexCoord + vec2(0.0, texel.y)).rgb;
+        vec3 low = min(color, min(min(left, right), min(down, up)));
+        vec3 high = max(color, max(max(left, right), max(down, up)));
+        // Flat areas are sharpened most, strong edges least, so noise is not amplified where it already stands out
+        vec3 amount = sqrt(clamp(min(low, 1.0 - high) / max(high, 1e-4), 0.0, 1.0)) * 0.2;
+        vec3 sharpened = color + (4.0 * color - (left + right + down + up)) * amount;
+        color = clamp(sharpened, low, high);
+    }
+    fragColor = vec4(color, 1.0);
+}
@@ -0,0 +1,10 @@
+#version 450 core
+
+out vec2 interTexCoord;
+
+// One triangle covering the whole screen, from the vertex index alone
+void main() {
+    vec2 corner = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    interTexCoord = corner;
+    gl_Position = vec4(corner * 2.0 - 1.0, 0.0, 1.0);
+}
@@ -0,0 +1,172 @@
+#pragma once
+#include "RenderingHandles.hpp"
+#include "ResourceLookup.hpp"
+#include "ThreadPool.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtc/type_precision.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace tel {
+// Up to four joints influence each vertex
+using JointIndices = glm::u8vec4;
+using JointWeights = glm::vec4;
+
+// Per-vertex skinning data, kept apart from Mesh so meshes that are not skinned carry none of it. Weights of each
+// vertex sum to one.
+struct SkinWeights {
+    std::vector<JointIndices> joints;
+    std::vector<JointWeights> weights;
+};
+
+[[nodiscard]] inline std::size_t size_in_bytes(const SkinWeights& skin) {
+    return skin.joints.size() * sizeof(JointIndices) + skin.weights.size() * sizeof(JointWeights);
+}
+
+struct JointTransform {
+    glm::vec3 translation{0.0f};
+    glm::quat rotation{1.0f, 0.0f, 0.0f, 0.0f};
+    glm::vec3 scale{1.0f};
+};
+
+// Joints are ordered so that every parent comes before its children, which lets poses be composed in one pass
+struct Skeleton {
+    std::vector<std::string> names;
+    // -1 for roots
+    std::vector<std::int32_t> parents;
+    std::vector<JointTransform> restPose;
+    // Takes the mesh from model space into each joint's space in the pose it was bound in
+    std::vector<glm::mat4> inverseBindMatrices;
+
+    [[nodiscard]] std::size_t joint_count() const { return parents.size(); }
+};
+
+// Meshes index joints with a byte
+constexpr std::size_t maxSkeletonJoints = 256;
+
+template <typename T>
+struct Keyframe {
+    float time;
+    T value;
+};
+
+// Keys of one joint in seconds, sorted by time. A joint without keys for a component holds its rest pose value.
+struct JointTrack {
+    std::vector<Keyframe<glm::vec3>> translations;
+    std::vector<Keyframe<glm::quat>> rotations;
+    std::vector<Keyframe<glm::vec3>> scales;
+};
+
+// Translation, rotation and scale of a joint as floats, in that order, with the rotation as x, y, z, w
+constexpr std::size_t jointComponentCount = 10;
+
+// A clip resampled at a fixed rate. Each sample holds one array per transform component with an entry for every joint,
+// padded to a multiple of 8, so sampling and blending work on many joints at a time and never need a tail loop.
+class AnimationClip {
+  public:
+    // tracks has one entry per joint of the skeleton; rotations between source keys are interpolated spherically
+    static AnimationClip resample(const Skeleton& skeleton, std::span<const JointTrack> tracks, float duration,
+                                  float sampleRate = 30.0f);
+
+    [[nodiscard]] float duration() const { return clipDuration; }
+
+    [[nodiscard]] std::size_t joint_count() const { return jointCount; }
+
+    // Entries per component array
+    [[nodiscard]] std::size_t joint_stride() const { return jointStride; }
+
+    [[nodiscard]] std::size_t sample_count() const { return sampleCount; }
+
+    // Samples per second; slightly above the requested rate so the last sample lands exactly on the end
+    [[nodiscard]] float sample_rate() const { return sampleRate; }
+
+    // jointComponentCount arrays of joint_stride() floats
+    [[nodiscard]] const float* sample(std::size_t index) const {
+        return samples.data() + index * jointComponentCount * jointStride;
+    }
+
+  private:
+    std::vector<float> samples;
+    std::size_t jointCount = 0;
+    std::size_t jointStride = 0;
+    std::size_t sampleCount = 0;
+    float clipDuration = 0.0f;
+    float sampleRate = 0.0f;
+};
+
+struct AnimationLayer {
+    AnimationClipHandle clip;
+    float time = 0.0f;
+    float speed = 1.0f;
+    // Relative to the other layers of the instance
+    float weight = 1.0f;
+    // Otherwise the clip holds its last pose once it ends
+    bool loop = true;
+};
+
+// Poses any number of skeleton instances each frame. Instances are split across the thread pool; each one blends its
+// layers' samples with a kernel that runs 8 joints at a time on AVX2, then composes the joint hierarchy and writes one
+// skinning matrix per joint into a shared palette that the renderer uploads whole.
+class Animation {
+  public:
+    explicit Animation(ThreadPool* threadPool);
+
+    SkeletonHandle add_skeleton(Skeleton skeleton);
+
+    // The clip must have been resampled for a skeleton with the same joints as the instances that play it
+    AnimationClipHandle add_clip(AnimationClip clip);
+
+    AnimationHandle create_instance(SkeletonHandle skeleton);
+
+    void remove_instance(AnimationHandle instance);
+
+    // Blended by weight; an instance without layers, or whose layers all have zero weight, holds its rest pose
+    [[nodiscard]] std::vector<AnimationLayer>& layers(AnimationHandle instance);
+
+    // Advances every layer and poses every instance
+    void update(float deltaSeconds);
+
+    // Skinning matrices of every instance, as of the last update
+    [[nodiscard]] std::span<const glm::mat4> palettes() const { return palette; }
+
+    // Where the instance's matrices start in palettes(); empty until the first update after it was created
+    [[nodiscard]] std::optional<std::uint32_t> palette_offset(AnimationHandle instance);
+
+    [[nodiscard]] std::size_t instance_count() const { return instances.size(); }
+
+  private:
+    struct SkeletonData {
+        Skeleton skeleton;
+        std::size_t jointStride;
+        // Laid out like a clip sample
+        std::vector<float> restPose;
+    };
+
+    struct Instance {
+        SkeletonHandle skeleton;
+        std::vector<AnimationLayer> layers;
+        std::optional<std::uint32_t> paletteOffset;
+    };
+
+    ThreadPool* threadPool;
+    ResourceLookup<SkeletonData> skeletons{MemorySubsystem::Animation};
+    ResourceLookup<AnimationClip> clips{MemorySubsystem::Animation};
+    ResourceLookup<Instance> instances{MemorySubsystem::Animation};
+    std::vector<glm::mat4> palette;
+    // Kept between frames so their capacity is reused
+    std::vector<std::pair<const SkeletonData*, Instance*>> frameInstances;
+    bool useAvx2;
+
+    void advance(std::vector<AnimationLayer>& layers, float deltaSeconds);
+
+    void pose(const SkeletonData& skeleton, const Instance& instance);
+};
+} // namespace tel
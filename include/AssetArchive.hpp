@@ -0,0 +1,96 @@
+#pragma once
+#include "MappedFile.hpp"
+#include "ThreadPool.hpp"
+
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <future>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace tel {
+enum class ArchiveError { CannotOpen, InvalidFormat, NotFound, CorruptEntry };
+
+enum class ArchiveCompression : std::uint32_t { None, Lz4 };
+
+struct ArchiveEntryInfo {
+    std::string_view path;
+    std::size_t size;
+    std::size_t storedSize;
+    ArchiveCompression compression;
+};
+
+// Many assets packed into one file: a header, a table of contents sorted by path hash, the paths, and then each
+// entry's data, compressed separately so any one of them can be read without touching the rest. Opening reads only
+// the table of contents; entries are decompressed when they are asked for, on worker threads with read_async.
+// Archives are little-endian.
+class AssetArchive {
+  public:
+    static std::expected<AssetArchive, ArchiveError> open(const std::filesystem::path& file);
+
+    // For archives that are already in memory, such as ones embedded in the binary. data must outlive the archive.
+    static std::expected<AssetArchive, ArchiveError> from_memory(std::span<const std::byte> data);
+
+    [[nodiscard]] bool contains(std::string_view path) const { return find_entry(path) != nullptr; }
+
+    [[nodiscard]] std::optional<ArchiveEntryInfo> find(std::string_view path) const;
+
+    [[nodiscard]] std::expected<std::string, ArchiveError> read(std::string_view path) const;
+
+    // The archive must outlive the returned future
+    std::future<std::expected<std::string, ArchiveError>> read_async(std::string path, ThreadPool& threadPool) const;
+
+    // Entries stored uncompressed can be used in place, without a copy
+    [[nodiscard]] std::optional<std::string_view> view(std::string_view path) const;
+
+    [[nodiscard]] std::vector<std::string_view> paths() const;
+
+    [[nodiscard]] std::size_t size() const { return entries.size(); }
+
+  private:
+    struct Entry {
+        std::uint64_t pathHash;
+        std::string_view path;
+        std::span<const std::byte> stored;
+        std::size_t size;
+        ArchiveCompression compression;
+    };
+
+    MappedFile file;
+    std::vector<Entry> entries;
+
+    [[nodiscard]] const Entry* find_entry(std::string_view path) const;
+
+    static std::expected<std::vector<Entry>, ArchiveError> read_table_of_contents(std::span<const std::byte> data);
+};
+
+// Builds an archive, e.g. from the hazor-pack tool at build time
+class AssetArchiveWriter {
+  public:
+    // Entries that do not shrink by at least compressionThreshold are stored uncompressed, so they can be viewed in
+    // place and cost nothing to read
+    void add(std::string path, std::span<const std::byte> contents, bool compress = true);
+
+    [[nodiscard]] std::vector<std::byte> serialize() const;
+
+    std::expected<void, ArchiveError> write(const std::filesystem::path& file) const;
+
+  private:
+    static constexpr double compressionThreshold = 0.9;
+
+    struct PendingEntry {
+        std::string path;
+        std::vector<std::byte> stored;
+        std::size_t size;
+        ArchiveCompression compression;
+    };
+
+    std::vector<PendingEntry> pending;
+};
+
+[[nodiscard]] std::uint64_t archive_path_hash(std::string_view path);
+} // namespace tel
@@ -7,20 +7,34 @@ namespace tel {
 class Camera {
   public:
     static Camera perspective(float fov, float aspectRatio, float nearClipping, float farClipping) {
-        return Camera(glm::perspective(fov, aspectRatio, nearClipping, farClipping));
+        return Camera(glm::perspective(fov, aspectRatio, nearClipping, farClipping), nearClipping, farClipping, true);
     }
 
     static Camera orthographic(float left, float top, float right, float bottom) {
-        return Camera(glm::ortho(left, right, bottom, top));
+        return Camera(glm::ortho(left, right, bottom, top), -1.0f, 1.0f, false);
     }
 
     [[nodiscard]] glm::mat4 matrix() const { return projection * transform; }
 
+    [[nodiscard]] const glm::mat4& projection_matrix() const { return projection; }
+
+    // Distances in front of the camera between which anything is drawn
+    [[nodiscard]] float near_clipping() const { return nearClipping; }
+
+    [[nodiscard]] float far_clipping() const { return farClipping; }
+
+    [[nodiscard]] bool is_perspective() const { return perspectiveProjection; }
+
     glm::mat4 transform = glm::identity<glm::mat4>();
 
   private:
-    explicit Camera(const glm::mat4& mat) : projection(mat) {}
+    Camera(const glm::mat4& mat, float nearClipping, float farClipping, bool perspectiveProjection)
+        : projection(mat), nearClipping(nearClipping), farClipping(farClipping),
+          perspectiveProjection(perspectiveProjection) {}
 
     glm::mat4 projection;
+    float nearClipping;
+    float farClipping;
+    bool perspectiveProjection;
 };
-} // namespace tel
\ No newline at end of file
+} // namespace tel
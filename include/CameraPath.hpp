@@ -0,0 +1,55 @@
+#pragma once
+#include "Camera.hpp"
+
+#include <cstddef>
+#include <expected>
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace tel {
+struct CameraKeyframe {
+    glm::vec3 position;
+    // The point the camera looks at
+    glm::vec3 target;
+};
+
+struct CameraPathError {
+    // 1-based line of the text that could not be read
+    std::size_t line;
+};
+
+// A smooth camera path through keyframes, for replaying the same flight every run. Positions and targets follow
+// Catmull-Rom splines, which pass through every keyframe.
+class CameraPath {
+  public:
+    CameraPath() = default;
+
+    explicit CameraPath(std::vector<CameraKeyframe> keyframes) : keyframes(std::move(keyframes)) {}
+
+    // Reads one keyframe per line as "px py pz tx ty tz"; blank lines and lines starting with # are skipped
+    static std::expected<CameraPath, CameraPathError> parse(std::string_view text);
+
+    [[nodiscard]] std::string serialize() const;
+
+    void add(const CameraKeyframe& keyframe) { keyframes.emplace_back(keyframe); }
+
+    // Appends where the camera is and the point a unit in front of it
+    void record(const Camera& camera);
+
+    // t runs from 0 at the first keyframe to 1 at the last, spending the same time between each pair
+    [[nodiscard]] CameraKeyframe sample(float t) const;
+
+    // A view matrix for Camera::transform
+    [[nodiscard]] glm::mat4 view_at(float t) const;
+
+    [[nodiscard]] std::size_t size() const { return keyframes.size(); }
+
+    [[nodiscard]] bool empty() const { return keyframes.empty(); }
+
+  private:
+    std::vector<CameraKeyframe> keyframes;
+};
+} // namespace tel
@@ -0,0 +1,123 @@
+#pragma once
+#include "Camera.hpp"
+#include "Light.hpp"
+#include "ThreadPool.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <glm/ext/matrix_float4x4.hpp>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <span>
+#include <vector>
+
+namespace tel {
+struct ClusteredLightingOptions {
+    // Tiles across and up the screen, and slices from the near to the far plane. Perspective cameras space the slices
+    // exponentially, so clusters far away are as deep as they are wide rather than long thin slivers.
+    std::uint32_t tilesX = 16;
+    std::uint32_t tilesY = 9;
+    std::uint32_t depthSlices = 24;
+};
+
+// The shader storage layouts, which must match data/shaders/ClusteredLighting.glsl
+struct GpuLight {
+    glm::vec4 positionRadius;
+    glm::vec4 colorIntensity;
+    // w is the cosine of the outer cone angle, or below -1 for point lights
+    glm::vec4 directionCosOuter;
+    // x is the cosine of the inner cone angle
+    glm::vec4 cosInner;
+};
+static_assert(sizeof(GpuLight) == 64);
+
+// The cluster's lights are light_indices()[offset, offset + count)
+struct ClusterRange {
+    std::uint32_t offset;
+    std::uint32_t count;
+};
+
+// A fragment's tile is its pixel scaled by slicing.xy, and its slice is slicing.z * depth + slicing.w, where depth is
+// how far in front of the camera it is, or the log of that when size.w is set
+struct ClusterGrid {
+    glm::mat4 view;
+    glm::uvec4 size;
+    glm::vec4 slicing;
+};
+static_assert(sizeof(ClusterGrid) == 96);
+
+// Clustered forward lighting: the view frustum is cut into a grid of clusters, and each frame every point and spot
+// light is binned into the clusters its sphere of influence touches, so a fragment only visits the handful of lights
+// that can reach its cluster rather than every light in the scene. Binning runs a slice per task on the thread pool,
+// narrowing the lights down slice by slice, then row by row, then cluster by cluster, testing 8 spheres at a time with
+// AVX2 when available.
+class ClusteredLighting {
+  public:
+    explicit ClusteredLighting(ThreadPool* threadPool, const ClusteredLightingOptions& options = {});
+
+    // The viewport only changes how fragments find their tile, not the clusters themselves
+    void update(std::span<const Light> lights, const Camera& camera, int viewportWidth, int viewportHeight);
+
+    // As of the last update, ready to upload
+    [[nodiscard]] std::span<const GpuLight> lights() const { return gpuLights; }
+
+    [[nodiscard]] std::span<const ClusterRange> cluster_ranges() const { return ranges; }
+
+    [[nodiscard]] std::span<const std::uint32_t> light_indices() const { return indices; }
+
+    [[nodiscard]] const ClusterGrid& grid() const { return gridHeader; }
+
+    [[nodiscard]] std::size_t cluster_count() const { return ranges.size(); }
+
+    // The cluster the shaders pick for a fragment at this pixel and this far in front of the camera
+    [[nodiscard]] std::size_t cluster_at(glm::vec2 pixel, float viewDepth) const;
+
+  private:
+    struct Bounds {
+        glm::vec3 min;
+        glm::vec3 max;
+    };
+
+    // Light spheres in view space, padded to whole blocks of 8 with spheres too far away to touch any cluster
+    struct Spheres {
+        std::vector<float> x;
+        std::vector<float> y;
+        std::vector<float> z;
+        std::vector<float> radius;
+        std::vector<std::uint32_t> light;
+        std::size_t count = 0;
+
+        void reserve(std::size_t spheres);
+
+        void push(const Spheres& from, std::size_t index);
+
+        void pad();
+    };
+
+    ThreadPool* threadPool;
+    ClusteredLightingOptions options;
+    // The clusters are rebuilt whenever the projection changes
+    glm::mat4 clusterProjection{0.0f};
+    std::vector<Bounds> clusterBounds;
+    // Unions of the clusters in each slice, and in each row of tiles within a slice
+    std::vector<Bounds> sliceBounds;
+    std::vector<Bounds> rowBounds;
+    Spheres viewSpheres;
+    // Each slice's lights, concatenated into indices once every slice is binned
+    std::vector<std::vector<std::uint32_t>> sliceIndices;
+    std::vector<GpuLight> gpuLights;
+    std::vector<ClusterRange> ranges;
+    std::vector<std::uint32_t> indices;
+    ClusterGrid gridHeader{};
+    bool useAvx2;
+
+    void build_clusters(const Camera& camera);
+
+    void bin_slice(std::uint32_t slice);
+
+    [[nodiscard]] std::uint32_t overlapping(const Spheres& spheres, std::size_t first, const Bounds& bounds) const;
+
+    void filter(const Spheres& spheres, const Bounds& bounds, Spheres& out) const;
+};
+} // namespace tel
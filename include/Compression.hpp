@@ -0,0 +1,22 @@
+#pragma once
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace tel {
+// A self-contained codec for the LZ4 block format: byte-aligned literal runs and back-references into a 64 KiB
+// window, so decompression is little more than memcpy. The compressor is the greedy single-probe variant, which
+// trades some ratio for speed; archives are packed once at build time and decompressed on every load.
+[[nodiscard]] constexpr std::size_t lz4_max_compressed_size(std::size_t size) { return size + size / 255 + 16; }
+
+// Each length byte adds at most 255 bytes of output, so no valid input expands by more than that
+[[nodiscard]] constexpr std::size_t lz4_max_decompressed_size(std::size_t compressedSize) {
+    return compressedSize * 255;
+}
+
+[[nodiscard]] std::vector<std::byte> lz4_compress(std::span<const std::byte> input);
+
+// output must be exactly the size of the original data. Returns false on malformed input instead of reading or
+// writing out of bounds.
+[[nodiscard]] bool lz4_decompress(std::span<const std::byte> input, std::span<std::byte> output);
+} // namespace tel
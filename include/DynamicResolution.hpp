@@ -0,0 +1,64 @@
+#pragma once
+#include <cstddef>
+#include <glm/vec2.hpp>
+
+namespace tel {
+enum class UpscaleFilter {
+    Bilinear,
+    // Bilinear, then sharpened by however much contrast there is around each pixel and clamped to its neighbours, so
+    // edges regain some of the crispness lost to scaling without ringing
+    EdgeAware
+};
+
+struct DynamicResolutionOptions {
+    // Otherwise the scene is drawn straight into the window's framebuffer at full size
+    bool enabled = false;
+    // GPU time per frame to hold, in milliseconds
+    double targetFrameMilliseconds = 1000.0 / 60.0;
+    // Fractions of the output size along each axis
+    float minScale = 0.5f;
+    float maxScale = 1.0f;
+    // Scales are multiples of this, so render targets are only reallocated on a real change
+    float scaleStep = 0.05f;
+    UpscaleFilter filter = UpscaleFilter::Bilinear;
+};
+
+// Picks the scale the scene is rendered at from measured GPU frame times. Shading cost goes roughly with the number of
+// pixels, the square of the scale, so the scale moves by the square root of how far the smoothed frame time is from
+// the target. It drops as far as needed at once when frames run over, but only climbs a step at a time and only with
+// headroom to spare, and after each change ignores enough frames for the timer queries in flight to drain.
+class DynamicResolution {
+  public:
+    explicit DynamicResolution(const DynamicResolutionOptions& options = {});
+
+    void record_gpu_time(double milliseconds);
+
+    [[nodiscard]] float scale() const { return currentScale; }
+
+    // At least one pixel along each axis
+    [[nodiscard]] glm::ivec2 render_size(glm::ivec2 outputSize) const;
+
+    [[nodiscard]] const DynamicResolutionOptions& options() const { return settings; }
+
+    [[nodiscard]] std::size_t scale_changes() const { return changes; }
+
+  private:
+    // How heavily each new measurement counts towards the smoothed frame time
+    static constexpr double smoothing = 0.2;
+    // The scale only climbs while frames take less than this share of the target
+    static constexpr double climbHeadroom = 0.85;
+    // Frames ignored after a change, more than the GPU timer has in flight
+    static constexpr std::size_t settleFrames = 6;
+
+    DynamicResolutionOptions settings;
+    float currentScale;
+    // Negative until there is a measurement at the current scale
+    double smoothedMilliseconds = -1.0;
+    std::size_t framesToSettle = 0;
+    std::size_t changes = 0;
+
+    [[nodiscard]] float quantize(float scale) const;
+
+    void change_scale(float scale);
+};
+} // namespace tel
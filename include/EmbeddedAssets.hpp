@@ -0,0 +1,7 @@
+#pragma once
+#include "AssetArchive.hpp"
+
+namespace tel {
+// The archive packed from data/ at build time and linked into the binary
+const AssetArchive& embedded_assets();
+} // namespace tel
@@ -1,39 +1,157 @@
 #pragma once
+#include "CameraPath.hpp"
+#include "FrameArena.hpp"
+#include "FrameProfiler.hpp"
 #include "InputManager.hpp"
 #include "Rendering.hpp"
 #include "Scene.hpp"
+#include "Scripting.hpp"
+#include "ThreadPool.hpp"
+#include "WorldStreaming.hpp"
+#include "rendering_internals/GpuTimer.hpp"
+#include <chrono>
 #include <filesystem>
 #include <sol/sol.hpp>
 
 namespace tel {
+struct EngineOptions {
+    int width = 800;
+    int height = 600;
+    const char* title = "Test";
+    // A hidden window still renders, so benchmarks can run without showing anything
+    bool visible = true;
+    bool vsync = true;
+    // Texture and mesh residency budgets, among others
+    RenderingOptions rendering{};
+};
+
+struct FlythroughOptions {
+    std::size_t frames = 1000;
+    // Run at the start of the path and not recorded, so shader compilation, streaming and caches have settled
+    std::size_t warmupFrames = 60;
+    // Animations and particles advance by this much every frame however long it took, so every run looks the same
+    float secondsPerFrame = 1.0f / 60.0f;
+};
+
 class Engine {
   public:
-    Engine()
-        : window(std::make_unique<Window>(800, 600, "Test")), rendering(std::make_unique<Rendering>(window.get())),
-          inputManager(std::make_unique<InputManager>(window.get())) {}
+    explicit Engine(const EngineOptions& options = {})
+        : threadPool(std::make_unique<ThreadPool>()),
+          window(std::make_unique<Window>(options.width, options.height, options.title, options.visible)),
+          frameArena(std::make_unique<FrameArena>(frameArenaSize)),
+          rendering(std::make_unique<Rendering>(window.get(), threadPool.get(), frameArena.get(), options.rendering)),
+          inputManager(std::make_unique<InputManager>(window.get())), scripting(std::make_unique<Scripting>()) {
+        window->set_vsync(options.vsync);
+    }
 
     Rendering& rendering_system() { return *rendering; }
 
     Scene& current_scene() { return currentScene; }
 
+    // Every loaded script's update runs once per frame, before animation, so what they move is drawn that frame
+    Scripting& scripting_system() { return *scripting; }
+
+    ThreadPool& thread_pool() { return *threadPool; }
+
+    // Reset at the start of every frame; anything allocated from it must not outlive the frame
+    FrameArena& frame_arena() { return *frameArena; }
+
+    // From then on the current scene's streamed objects follow its camera through the world
+    WorldStreaming& enable_world_streaming(WorldStreaming::LoadMesh loadMesh,
+                                           const WorldStreamingOptions& options = {}) {
+        worldStreaming =
+            std::make_unique<WorldStreaming>(rendering.get(), threadPool.get(), std::move(loadMesh), options);
+        return *worldStreaming;
+    }
+
+    [[nodiscard]] WorldStreaming* world_streaming() { return worldStreaming.get(); }
+
     void start_main_loop() {
         assert(ready_to_start());
+        auto previousFrame = std::chrono::steady_clock::now();
         while (!window->should_close()) {
-            window->poll_events();
-            inputManager->handle_input();
-            rendering->render_scene(currentScene);
-            window->swap_buffers();
+            const auto frameStart = std::chrono::steady_clock::now();
+            run_frame(std::chrono::duration<float>(frameStart - previousFrame).count(), nullptr, nullptr);
+            previousFrame = frameStart;
         }
     }
 
+    // Flies the current scene's camera along path over a fixed number of frames and times every frame, the same way
+    // each run, so results can be compared between builds
+    FrameProfiler run_flythrough(const CameraPath& path, const FlythroughOptions& options = {}) {
+        assert(ready_to_start());
+        FrameProfiler profiler;
+        GpuTimer gpuTimer;
+        const auto record_gpu_time = [&](std::size_t frame, double milliseconds) {
+            profiler.record_gpu_time(frame, milliseconds);
+        };
+        for (std::size_t frame = 0; frame < options.warmupFrames + options.frames && !window->should_close(); ++frame) {
+            if (frame < options.warmupFrames) {
+                currentScene.camera.transform = path.view_at(0.0f);
+                run_frame(options.secondsPerFrame, nullptr, nullptr);
+                continue;
+            }
+            const std::size_t recorded = frame - options.warmupFrames;
+            const float t = options.frames > 1 ? static_cast<float>(recorded) / static_cast<float>(options.frames - 1)
+                                               : 0.0f;
+            currentScene.camera.transform = path.view_at(t);
+            profiler.begin_frame();
+            gpuTimer.begin(recorded, record_gpu_time);
+            run_frame(options.secondsPerFrame, &profiler, &gpuTimer);
+            profiler.end_frame();
+            gpuTimer.collect(record_gpu_time);
+        }
+        gpuTimer.collect(record_gpu_time, true);
+        return profiler;
+    }
+
     [[nodiscard]] bool ready_to_start() const {
-        return rendering != nullptr && inputManager != nullptr && window != nullptr;
+        return threadPool != nullptr && rendering != nullptr && inputManager != nullptr && window != nullptr &&
+               scripting != nullptr;
     }
 
   private:
+    std::unique_ptr<ThreadPool> threadPool;
+    static constexpr std::size_t frameArenaSize = 1 << 20;
+
     std::unique_ptr<Window> window;
+    std::unique_ptr<FrameArena> frameArena;
     std::unique_ptr<Rendering> rendering;
     std::unique_ptr<InputManager> inputManager;
+    std::unique_ptr<WorldStreaming> worldStreaming;
+    std::unique_ptr<Scripting> scripting;
     Scene currentScene{.camera = Camera::perspective(45.0f, 4.0f / 3.0f, 0.1f, 100.0f)};
+
+    template <typename Func>
+    static void timed(FrameProfiler* profiler, FramePhase phase, Func&& func) {
+        if (profiler == nullptr) {
+            func();
+            return;
+        }
+        const auto timer = profiler->time(phase);
+        func();
+    }
+
+    // The GPU timer, if any, covers the rendering commands and has been started by the caller
+    void run_frame(float deltaSeconds, FrameProfiler* profiler, GpuTimer* gpuTimer) {
+        frameArena->reset();
+        timed(profiler, FramePhase::Input, [&] {
+            window->poll_events();
+            inputManager->handle_input();
+        });
+        timed(profiler, FramePhase::Streaming, [&] {
+            if (worldStreaming) {
+                worldStreaming->update(currentScene);
+            }
+        });
+        timed(profiler, FramePhase::Scripts, [&] { scripting->update(currentScene, deltaSeconds); });
+        timed(profiler, FramePhase::Animation, [&] { rendering->animation().update(deltaSeconds); });
+        timed(profiler, FramePhase::Particles, [&] { rendering->particles().update(deltaSeconds); });
+        timed(profiler, FramePhase::Rendering, [&] { rendering->render_scene(currentScene); });
+        if (gpuTimer != nullptr) {
+            gpuTimer->end();
+        }
+        timed(profiler, FramePhase::Present, [&] { window->swap_buffers(); });
+    }
 };
 } // namespace tel
@@ -0,0 +1,109 @@
+#pragma once
+#include "MemoryTracking.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <memory_resource>
+#include <mutex>
+#include <vector>
+
+namespace tel {
+// Linear allocator for memory that only lives until the end of the frame. Allocating is a lock-free pointer bump,
+// so worker threads can use it too; deallocating does nothing and reset() frees everything at once. Allocations that
+// do not fit fall back to the upstream resource, and the next reset grows the arena so the following frames fit.
+class FrameArena : public std::pmr::memory_resource {
+  public:
+    explicit FrameArena(std::size_t capacity,
+                        std::pmr::memory_resource* upstream = tracked_resource(MemorySubsystem::FrameArena))
+        : upstream(upstream) {
+        allocate_block(capacity);
+    }
+
+    FrameArena(const FrameArena&) = delete;
+
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    ~FrameArena() override {
+        release_overflow();
+        upstream->deallocate(block, blockSize, alignof(std::max_align_t));
+    }
+
+    // Must not overlap with any allocation; everything handed out since the last reset becomes invalid
+    void reset() {
+        const std::size_t needed = used() + overflowBytes;
+        highWater = std::max(highWater, needed);
+        release_overflow();
+        if (needed > blockSize) {
+            upstream->deallocate(block, blockSize, alignof(std::max_align_t));
+            allocate_block(std::bit_ceil(needed));
+        }
+        offset.store(0, std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] std::size_t used() const { return std::min(offset.load(std::memory_order_relaxed), blockSize); }
+
+    [[nodiscard]] std::size_t capacity() const { return blockSize; }
+
+    // Largest amount one frame has needed, including what spilled to the upstream resource
+    [[nodiscard]] std::size_t high_water() const { return highWater; }
+
+    [[nodiscard]] std::size_t overflow_allocations() const { return totalOverflowAllocations; }
+
+  private:
+    struct Overflow {
+        void* memory;
+        std::size_t bytes;
+        std::size_t alignment;
+    };
+
+    std::pmr::memory_resource* upstream;
+    std::byte* block = nullptr;
+    std::size_t blockSize = 0;
+    std::atomic<std::size_t> offset = 0;
+    std::size_t highWater = 0;
+    std::mutex overflowMutex;
+    std::vector<Overflow> overflow;
+    std::size_t overflowBytes = 0;
+    std::size_t totalOverflowAllocations = 0;
+
+    void allocate_block(std::size_t size) {
+        block = static_cast<std::byte*>(upstream->allocate(size, alignof(std::max_align_t)));
+        blockSize = size;
+    }
+
+    void release_overflow() {
+        for (const auto& [memory, bytes, alignment] : overflow) {
+            upstream->deallocate(memory, bytes, alignment);
+        }
+        overflow.clear();
+        overflowBytes = 0;
+    }
+
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        std::size_t current = offset.load(std::memory_order_relaxed);
+        while (true) {
+            const std::size_t aligned = (current + alignment - 1) / alignment * alignment;
+            if (aligned + bytes > blockSize) {
+                break;
+            }
+            if (offset.compare_exchange_weak(current, aligned + bytes, std::memory_order_relaxed)) {
+                return block + aligned;
+            }
+        }
+        std::scoped_lock lock(overflowMutex);
+        void* memory = upstream->allocate(bytes, alignment);
+        overflow.emplace_back(memory, bytes, alignment);
+        overflowBytes += bytes;
+        ++totalOverflowAllocations;
+        return memory;
+    }
+
+    void do_deallocate(void*, std::size_t, std::size_t) override {}
+
+    [[nodiscard]] bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+} // namespace tel
@@ -0,0 +1,92 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <optional>
+#include <ostream>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace tel {
+// The parts of a main-loop iteration timed separately
+enum class FramePhase { Input, Streaming, Scripts, Animation, Particles, Rendering, Present, Count };
+
+constexpr std::size_t framePhaseCount = static_cast<std::size_t>(FramePhase::Count);
+
+std::string_view to_string(FramePhase phase);
+
+struct FrameSample {
+    std::array<double, framePhaseCount> phaseMilliseconds{};
+    // Wall time of the whole frame, including anything between the phases
+    double cpuMilliseconds = 0.0;
+    // Filled in frames later, once the GPU has finished the frame, and missing if timer queries are unavailable
+    std::optional<double> gpuMilliseconds;
+};
+
+struct TimingSummary {
+    double mean = 0.0;
+    double p50 = 0.0;
+    double p95 = 0.0;
+    double p99 = 0.0;
+    double worst = 0.0;
+    std::size_t worstFrame = 0;
+    std::size_t samples = 0;
+};
+
+// Nearest-rank percentiles; an empty input gives an all-zero summary
+[[nodiscard]] TimingSummary summarize(std::span<const double> milliseconds);
+
+// Records how long each frame and each of its phases took. Spikes are what players notice, so summaries report
+// percentiles and the worst frame rather than just an average.
+class FrameProfiler {
+  public:
+    class PhaseTimer {
+      public:
+        PhaseTimer(const PhaseTimer&) = delete;
+
+        PhaseTimer& operator=(const PhaseTimer&) = delete;
+
+        ~PhaseTimer();
+
+      private:
+        friend class FrameProfiler;
+
+        PhaseTimer(FrameSample* sample, FramePhase phase)
+            : sample(sample), phase(phase), start(std::chrono::steady_clock::now()) {}
+
+        FrameSample* sample;
+        FramePhase phase;
+        std::chrono::steady_clock::time_point start;
+    };
+
+    void begin_frame();
+
+    // Adds the time until the returned timer is destroyed to the phase of the current frame
+    [[nodiscard]] PhaseTimer time(FramePhase phase);
+
+    void end_frame();
+
+    void record_gpu_time(std::size_t frame, double milliseconds);
+
+    // Index of the frame between begin_frame and end_frame
+    [[nodiscard]] std::size_t current_frame() const { return frames.size() - 1; }
+
+    [[nodiscard]] std::span<const FrameSample> samples() const { return frames; }
+
+    [[nodiscard]] TimingSummary cpu_summary() const;
+
+    [[nodiscard]] TimingSummary phase_summary(FramePhase phase) const;
+
+    [[nodiscard]] TimingSummary gpu_summary() const;
+
+    // One row per frame, milliseconds, with the GPU column left empty for frames that have no measurement
+    void write_csv(std::ostream& out) const;
+
+    void write_summary(std::ostream& out) const;
+
+  private:
+    std::vector<FrameSample> frames;
+    std::chrono::steady_clock::time_point frameStart;
+};
+} // namespace tel
@@ -0,0 +1,123 @@
+#pragma once
+#include "Image.hpp"
+#include "ThreadPool.hpp"
+#include "rendering_internals/Fence.hpp"
+#include "rendering_internals/Framebuffer.hpp"
+#include "rendering_internals/ReadbackBuffer.hpp"
+
+#include <GL/glew.h>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <optional>
+#include <vector>
+
+namespace tel {
+enum class ReadbackFormat { Rgba8, Bgra8, Rgb8, Depth32F };
+
+[[nodiscard]] constexpr std::size_t bytes_per_pixel(ReadbackFormat format) {
+    return format == ReadbackFormat::Rgb8 ? 3 : 4;
+}
+
+// In pixels from the top-left corner, the same way window and mouse coordinates are given
+struct ReadbackRegion {
+    int x = 0;
+    int y = 0;
+    int width = 0;
+    int height = 0;
+};
+
+struct ReadbackRequest {
+    // The whole framebuffer when empty
+    std::optional<ReadbackRegion> region;
+    ReadbackFormat format = ReadbackFormat::Rgba8;
+    // Which colour attachment to read; the default framebuffer always reads its back buffer
+    GLenum attachment = GL_COLOR_ATTACHMENT0;
+};
+
+// Tightly packed pixels, rows top to bottom
+struct ReadbackResult {
+    int width = 0;
+    int height = 0;
+    ReadbackFormat format = ReadbackFormat::Rgba8;
+    std::vector<std::byte> pixels;
+    // Increases by one with every read, so results that arrive out of order can be put back in order
+    std::uint64_t sequence = 0;
+};
+
+// The result has to be Rgba8
+[[nodiscard]] Image to_image(ReadbackResult result);
+
+using ReadbackCallback = std::function<void(ReadbackResult)>;
+
+struct FramebufferReadbackOptions {
+    // Reads that can be in flight at once; a read issued while all of them are busy has to wait for the oldest
+    std::size_t bufferCount = 4;
+};
+
+// Reads pixels back from framebuffers without stalling the pipeline. Each read is copied by the GPU into one of a ring
+// of persistently mapped pixel buffer objects and followed by a fence; update() notices finished fences without
+// blocking and hands the mapped memory to a worker, which crops, flips and converts it and calls the callback there.
+// Results therefore arrive one or more frames after the read was issued.
+class FramebufferReadback {
+  public:
+    using BindFramebuffer = std::function<void(const Framebuffer&)>;
+
+    // Framebuffers are bound to be read through bindFramebuffer, so the caller's cache of bound objects stays right
+    FramebufferReadback(ThreadPool* threadPool, const FramebufferReadbackOptions& options,
+                        BindFramebuffer bindFramebuffer);
+
+    FramebufferReadback(const FramebufferReadback&) = delete;
+
+    FramebufferReadback& operator=(const FramebufferReadback&) = delete;
+
+    // Delivers every read still in flight before releasing the buffers
+    ~FramebufferReadback();
+
+    // Queues the copy on the GL thread. The callback is called from a worker thread, or from update() without one.
+    void read(const Framebuffer& framebuffer, const ReadbackRequest& request, ReadbackCallback callback);
+
+    // Becomes ready after a later update() has seen the copy finish, so never wait on it on the GL thread without
+    // calling update() or finish()
+    [[nodiscard]] std::future<ReadbackResult> read(const Framebuffer& framebuffer, const ReadbackRequest& request = {});
+
+    // Starts conversion of every copy the GPU has finished; never blocks. Call once per frame on the GL thread.
+    void update();
+
+    // Blocks until every read issued so far has been delivered
+    void finish();
+
+    // Reads issued but not yet delivered
+    [[nodiscard]] std::size_t in_flight() const;
+
+    // How often a read had to wait because every buffer was still busy; above zero means bufferCount is too small
+    [[nodiscard]] std::size_t stalls() const { return stallCount; }
+
+  private:
+    enum class State { Free, Copying, Converting };
+
+    struct Slot {
+        ReadbackBuffer buffer;
+        State state = State::Free;
+        Fence fence;
+        ReadbackResult result;
+        ReadbackCallback callback;
+        std::future<void> conversion;
+    };
+
+    ThreadPool* threadPool;
+    BindFramebuffer bindFramebuffer;
+    std::vector<Slot> slots;
+    std::uint64_t nextSequence = 0;
+    std::size_t stallCount = 0;
+
+    Slot& acquire(std::size_t bytes);
+
+    void start_conversion(Slot& slot);
+
+    void wait_for_copy(Slot& slot);
+
+    void wait_for_conversion(Slot& slot);
+};
+} // namespace tel
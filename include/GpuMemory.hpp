@@ -0,0 +1,100 @@
+#pragma once
+#include "MemoryTracking.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <string_view>
+#include <utility>
+
+namespace tel {
+enum class GpuMemoryCategory { MeshBuffers, Textures, RenderTargets, StreamingBuffers, Count };
+
+[[nodiscard]] constexpr std::string_view to_string(GpuMemoryCategory category) {
+    switch (category) {
+    case GpuMemoryCategory::MeshBuffers:
+        return "MeshBuffers";
+    case GpuMemoryCategory::Textures:
+        return "Textures";
+    case GpuMemoryCategory::RenderTargets:
+        return "RenderTargets";
+    case GpuMemoryCategory::StreamingBuffers:
+        return "StreamingBuffers";
+    default:
+        std::unreachable();
+    }
+}
+
+constexpr auto gpuMemoryCategoryCount = static_cast<std::size_t>(GpuMemoryCategory::Count);
+
+using GpuMemoryReport = std::array<std::pair<GpuMemoryCategory, AllocationStats>, gpuMemoryCategoryCount>;
+
+// Bytes of buffer and texture storage the engine has asked the driver for, by category. The driver may pad or
+// compress, so these are what was requested rather than what is resident, but they grow and shrink with it. Updated
+// from the GL thread and readable from any.
+class GpuMemoryTracker {
+  public:
+    void record_allocation(GpuMemoryCategory category, std::size_t bytes);
+
+    void record_deallocation(GpuMemoryCategory category, std::size_t bytes);
+
+    [[nodiscard]] AllocationStats stats(GpuMemoryCategory category) const;
+
+    [[nodiscard]] GpuMemoryReport report() const;
+
+    [[nodiscard]] std::size_t total_bytes() const;
+
+  private:
+    struct Counters {
+        std::atomic<std::size_t> bytes = 0;
+        std::atomic<std::size_t> highWaterBytes = 0;
+        std::atomic<std::size_t> allocations = 0;
+        std::atomic<std::size_t> liveAllocations = 0;
+    };
+
+    std::array<Counters, gpuMemoryCategoryCount> counters;
+};
+
+GpuMemoryTracker& gpu_memory_tracker();
+
+// Accounts for one block of GPU storage for as long as it lives, so the object owning the storage only has to hold
+// one of these alongside its GL name
+class GpuAllocation {
+  public:
+    GpuAllocation() = default;
+
+    GpuAllocation(GpuMemoryCategory category, std::size_t bytes) : category(category), bytes(bytes) {
+        gpu_memory_tracker().record_allocation(category, bytes);
+    }
+
+    GpuAllocation(const GpuAllocation&) = delete;
+
+    GpuAllocation& operator=(const GpuAllocation&) = delete;
+
+    GpuAllocation(GpuAllocation&& other) noexcept
+        : category(other.category), bytes(std::exchange(other.bytes, 0)) {}
+
+    GpuAllocation& operator=(GpuAllocation&& other) noexcept {
+        if (this != &other) {
+            release();
+            category = other.category;
+            bytes = std::exchange(other.bytes, 0);
+        }
+        return *this;
+    }
+
+    ~GpuAllocation() { release(); }
+
+    [[nodiscard]] std::size_t size() const { return bytes; }
+
+  private:
+    GpuMemoryCategory category = GpuMemoryCategory::MeshBuffers;
+    std::size_t bytes = 0;
+
+    void release() {
+        if (bytes != 0) {
+            gpu_memory_tracker().record_deallocation(category, std::exchange(bytes, 0));
+        }
+    }
+};
+} // namespace tel
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <expected>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace tel {
+// Tightly packed 8-bit pixels, rows top to bottom: grey, grey and alpha, RGB or RGBA for one to four channels
+struct Image {
+    int width = 0;
+    int height = 0;
+    int channels = 4;
+    std::vector<std::byte> pixels;
+
+    [[nodiscard]] std::size_t size_in_bytes() const { return pixels.size(); }
+};
+
+struct ImageLoadError {
+    std::string reason;
+};
+
+[[nodiscard]] constexpr int mip_level_count(int width, int height) {
+    return std::bit_width(static_cast<unsigned int>(std::max({width, height, 1})));
+}
+
+[[nodiscard]] constexpr int mip_dimension(int baseDimension, int level) { return std::max(baseDimension >> level, 1); }
+
+std::expected<Image, ImageLoadError> load_image_from_memory(std::string_view data);
+
+// Box-filters the image down to the next mip level
+[[nodiscard]] Image downsample(const Image& image);
+
+// Returns the full chain, starting with the image itself and ending with the 1x1 level
+[[nodiscard]] std::vector<Image> generate_mip_chain(Image image);
+} // namespace tel
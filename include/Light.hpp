@@ -0,0 +1,20 @@
+#pragma once
+#include <glm/vec3.hpp>
+
+namespace tel {
+enum class LightType { Point, Spot };
+
+struct Light {
+    LightType type = LightType::Point;
+    glm::vec3 position{0.0f};
+    // Nothing further away than this is lit
+    float radius = 10.0f;
+    glm::vec3 color{1.0f};
+    float intensity = 1.0f;
+    // Spot lights only: where the cone points, and half-angles in radians of the fully lit cone and of the cone the
+    // light fades out towards
+    glm::vec3 direction{0.0f, -1.0f, 0.0f};
+    float innerConeAngle = 0.3f;
+    float outerConeAngle = 0.5f;
+};
+} // namespace tel
@@ -0,0 +1,39 @@
+#pragma once
+#include "FileLoading.hpp"
+#include "Moving.hpp"
+
+#include <cstddef>
+#include <expected>
+#include <filesystem>
+#include <span>
+
+namespace tel {
+// A read-only view of a whole file mapped into memory. Pages are only read from disk when first touched, so opening a
+// large file is cheap and parts that are never read cost nothing.
+class MappedFile {
+  public:
+    MappedFile() = default;
+
+    static std::expected<MappedFile, FileLoadError> open(const std::filesystem::path& file);
+
+    MappedFile(const MappedFile&) = delete;
+
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept = default;
+
+    MappedFile& operator=(MappedFile&& other) noexcept = default;
+
+    ~MappedFile();
+
+    [[nodiscard]] std::span<const std::byte> bytes() const {
+        return {static_cast<const std::byte*>(address.value()), size.value()};
+    }
+
+  private:
+    MappedFile(void* address, std::size_t size) : address(address), size(size) {}
+
+    Moving<void*, nullptr, EngagedMoveAssignBehavior::Assert> address;
+    Moving<std::size_t> size;
+};
+} // namespace tel
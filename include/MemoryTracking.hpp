@@ -0,0 +1,124 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <limits>
+#include <memory_resource>
+#include <string_view>
+#include <utility>
+
+namespace tel {
+enum class MemorySubsystem {
+    General,
+    Input,
+    Meshes,
+    Rendering,
+    Textures,
+    FrameArena,
+    Animation,
+    Particles,
+    Scripting,
+    Raycasting,
+    Count
+};
+
+[[nodiscard]] constexpr std::string_view to_string(MemorySubsystem subsystem) {
+    switch (subsystem) {
+    case MemorySubsystem::General:
+        return "General";
+    case MemorySubsystem::Input:
+        return "Input";
+    case MemorySubsystem::Meshes:
+        return "Meshes";
+    case MemorySubsystem::Rendering:
+        return "Rendering";
+    case MemorySubsystem::Textures:
+        return "Textures";
+    case MemorySubsystem::FrameArena:
+        return "FrameArena";
+    case MemorySubsystem::Animation:
+        return "Animation";
+    case MemorySubsystem::Particles:
+        return "Particles";
+    case MemorySubsystem::Scripting:
+        return "Scripting";
+    case MemorySubsystem::Raycasting:
+        return "Raycasting";
+    default:
+        std::unreachable();
+    }
+}
+
+struct AllocationStats {
+    std::size_t bytes = 0;
+    std::size_t highWaterBytes = 0;
+    std::size_t allocations = 0;
+    std::size_t liveAllocations = 0;
+};
+
+constexpr auto memorySubsystemCount = static_cast<std::size_t>(MemorySubsystem::Count);
+
+using MemoryReport = std::array<std::pair<MemorySubsystem, AllocationStats>, memorySubsystemCount>;
+
+// Per-subsystem allocation counters. Updates are lock-free so tracked allocations can come from any thread.
+class MemoryTracker {
+  public:
+    void record_allocation(MemorySubsystem subsystem, std::size_t bytes);
+
+    void record_deallocation(MemorySubsystem subsystem, std::size_t bytes);
+
+    [[nodiscard]] AllocationStats stats(MemorySubsystem subsystem) const;
+
+    [[nodiscard]] MemoryReport report() const;
+
+    // Warns once when the subsystem's live bytes exceed the limit, to catch unbounded growth early
+    void set_limit(MemorySubsystem subsystem, std::size_t bytes);
+
+  private:
+    struct Counters {
+        std::atomic<std::size_t> bytes = 0;
+        std::atomic<std::size_t> highWaterBytes = 0;
+        std::atomic<std::size_t> allocations = 0;
+        std::atomic<std::size_t> liveAllocations = 0;
+        std::atomic<std::size_t> limit = std::numeric_limits<std::size_t>::max();
+        std::atomic<bool> warned = false;
+    };
+
+    std::array<Counters, memorySubsystemCount> counters;
+
+    Counters& counters_for(MemorySubsystem subsystem) { return counters[static_cast<std::size_t>(subsystem)]; }
+};
+
+MemoryTracker& memory_tracker();
+
+// Forwards to an upstream resource and records every allocation against a subsystem
+class TrackingResource : public std::pmr::memory_resource {
+  public:
+    explicit TrackingResource(MemorySubsystem subsystem,
+                              std::pmr::memory_resource* upstream = std::pmr::new_delete_resource())
+        : subsystem(subsystem), upstream(upstream) {}
+
+  private:
+    MemorySubsystem subsystem;
+    std::pmr::memory_resource* upstream;
+
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        void* memory = upstream->allocate(bytes, alignment);
+        memory_tracker().record_allocation(subsystem, bytes);
+        return memory;
+    }
+
+    void do_deallocate(void* memory, std::size_t bytes, std::size_t alignment) override {
+        upstream->deallocate(memory, bytes, alignment);
+        memory_tracker().record_deallocation(subsystem, bytes);
+    }
+
+    [[nodiscard]] bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+// A process-wide heap resource that accounts to the given subsystem
+std::pmr::memory_resource* tracked_resource(MemorySubsystem subsystem);
+} // namespace tel
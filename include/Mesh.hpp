@@ -2,6 +2,8 @@
 #include "Util.hpp"
 
 #include <functional>
+#include <glm/vec2.hpp>
+#include <glm/common.hpp>
 #include <glm/vec3.hpp>
 #include <ranges>
 #include <vector>
@@ -11,11 +13,15 @@ using Position = glm::vec3;
 
 using Normal = glm::vec3;
 
+using TexCoord = glm::vec2;
+
 using TriangleIndex = unsigned int;
 
 struct Mesh {
     std::vector<Position> positions;
     std::vector<Normal> normals;
+    // Optional: either empty or one per position
+    std::vector<TexCoord> texCoords;
     std::vector<TriangleIndex> triangles;
 
     [[nodiscard]] auto vertex_attributes() const { return std::tie(positions, normals); }
@@ -25,25 +31,58 @@ struct Mesh {
         // version
         positions.reserve(capacity);
         normals.reserve(capacity);
+        texCoords.reserve(capacity);
         //  There will be at least as many triangle indices as there are vertices, so reserve extra
         triangles.reserve(capacity * 3 / 2);
     }
 };
 
 inline [[nodiscard]] Mesh join(Mesh first, Mesh second) {
+    const auto triangleOffset = static_cast<TriangleIndex>(first.positions.size());
     Mesh combined = std::move(first);
-    unsigned int triangleOffset = first.positions.size();
     combined.positions.append_range(second.positions);
     combined.normals.append_range(second.normals);
+    // A mesh without texture coordinates joined to one with them gets zeroes, so they stay one per position
+    if (!combined.texCoords.empty() || !second.texCoords.empty()) {
+        combined.texCoords.resize(triangleOffset);
+        combined.texCoords.append_range(second.texCoords);
+        combined.texCoords.resize(combined.positions.size());
+    }
     combined.triangles.append_range(second.triangles |
                                     std::views::transform(std::bind_front(std::plus{}, triangleOffset)));
     return combined;
 }
 
+struct BoundingBox {
+    Position min{};
+    Position max{};
+};
+
+[[nodiscard]] inline BoundingBox compute_bounds(const Mesh& mesh) {
+    if (mesh.positions.empty()) {
+        return {};
+    }
+    BoundingBox bounds{.min = mesh.positions.front(), .max = mesh.positions.front()};
+    for (const Position& position : mesh.positions) {
+        bounds.min = glm::min(bounds.min, position);
+        bounds.max = glm::max(bounds.max, position);
+    }
+    return bounds;
+}
+
+// What the mesh takes once uploaded, which is the same as its CPU-side streams
+[[nodiscard]] inline std::size_t size_in_bytes(const Mesh& mesh) {
+    return mesh.positions.size() * sizeof(Position) + mesh.normals.size() * sizeof(Normal) +
+           mesh.texCoords.size() * sizeof(TexCoord) + mesh.triangles.size() * sizeof(TriangleIndex);
+}
+
 [[nodiscard]] constexpr bool mesh_is_valid(const Mesh& mesh) {
     if (mesh.triangles.empty()) {
         return mesh.positions.empty();
     }
+    if (!mesh.texCoords.empty() && mesh.texCoords.size() != mesh.positions.size()) {
+        return false;
+    }
     const TriangleIndex maxIndex = std::ranges::max(mesh.triangles);
     return all_of([&](const auto& vec) { return vec.size() > maxIndex; }, mesh.vertex_attributes());
 }
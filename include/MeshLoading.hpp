@@ -1,10 +1,33 @@
 #pragma once
+#include "Animation.hpp"
 #include "Mesh.hpp"
 
 #include <expected>
+#include <string>
+#include <string_view>
+#include <vector>
 
 namespace tel {
+class ThreadPool;
+
 struct MeshLoadError {};
 
-std::expected<Mesh, MeshLoadError> load_mesh_from_memory(std::string_view data);
+// OBJ files go through the native parser, in parallel if a thread pool is given; everything else, and any OBJ the
+// native parser gives up on, through Assimp
+std::expected<Mesh, MeshLoadError> load_mesh_from_memory(std::string_view data, ThreadPool* threadPool = nullptr);
+
+// A mesh bound to a skeleton, along with the skeleton's animations
+struct SkinnedModel {
+    Mesh mesh;
+    SkinWeights skin;
+    Skeleton skeleton;
+    std::vector<AnimationClip> clips;
+    // Parallel to clips
+    std::vector<std::string> clipNames;
+};
+
+// Through Assimp. Every node in the file becomes a joint, so parts of the model without bones of their own follow the
+// node they hang from. Clips are resampled at sampleRate. Fails for files with more joints than maxSkeletonJoints.
+std::expected<SkinnedModel, MeshLoadError> load_skinned_model_from_memory(std::string_view data,
+                                                                          float sampleRate = 30.0f);
 } // namespace tel
\ No newline at end of file
@@ -0,0 +1,24 @@
+#pragma once
+#include "Mesh.hpp"
+#include "MeshLoading.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <functional>
+#include <limits>
+
+namespace tel {
+struct MeshResidencyOptions {
+    // GPU bytes of mesh buffers above which the least recently drawn meshes are evicted at the end of a frame, to be
+    // uploaded again the next time something draws them. Unlimited by default, in which case no copies are kept.
+    std::size_t budget = std::numeric_limits<std::size_t>::max();
+    // Meshes drawn within this many frames are kept even over budget, so what is on screen is never evicted only to be
+    // uploaded again straight away
+    std::uint64_t graceFrames = 2;
+};
+
+// Produces a mesh again once its GPU copy has been evicted, such as by reading the file it came from. Runs on the
+// thread pool.
+using MeshLoader = std::function<std::expected<Mesh, MeshLoadError>()>;
+} // namespace tel
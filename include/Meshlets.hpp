@@ -0,0 +1,114 @@
+#pragma once
+#include "Camera.hpp"
+#include "Mesh.hpp"
+#include "ThreadPool.hpp"
+#include "Transform.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <span>
+#include <vector>
+
+namespace tel {
+struct MeshletOptions {
+    bool enabled = false;
+    // Smaller meshes are drawn whole, since culling them piece by piece costs more than drawing what it would save
+    std::size_t minTriangles = 4096;
+    // Per meshlet; the usual limits for mesh shaders, which keep meshlets small enough to be bounded tightly
+    std::size_t maxVertices = 64;
+    std::size_t maxTriangles = 124;
+    // Also skips meshlets that face entirely away from the camera. Only correct for meshes with counter-clockwise front
+    // faces that are never seen from behind.
+    bool coneCulling = true;
+};
+
+// A patch of neighbouring triangles, with a bounding sphere for frustum culling and a cone bounding its normals for
+// backface culling
+struct Meshlet {
+    // The meshlet's triangles are indices [firstIndex, firstIndex + indexCount) of MeshletMesh::triangles
+    std::uint32_t firstIndex;
+    std::uint32_t indexCount;
+    glm::vec3 center;
+    float radius;
+    // Every triangle faces away from a camera behind the apex whose direction to it is within the cone around the
+    // axis, that is one for which dot(normalize(coneApex - camera), coneAxis) >= coneCutoff. The cutoff is above 1
+    // when the normals spread too far for any camera to qualify.
+    glm::vec3 coneApex;
+    glm::vec3 coneAxis;
+    float coneCutoff;
+};
+
+struct MeshletMesh {
+    std::vector<Meshlet> meshlets;
+    // The mesh's triangles, reordered so that each meshlet's are contiguous
+    std::vector<TriangleIndex> triangles;
+};
+
+// Grows each meshlet from a seed triangle by repeatedly adding the neighbouring triangle that brings in the fewest new
+// vertices, until either limit is reached or no neighbour fits, then seeds the next from the first triangle left over
+[[nodiscard]] MeshletMesh build_meshlets(const Mesh& mesh, const MeshletOptions& options = {});
+
+struct MeshletInstance {
+    std::span<const Meshlet> meshlets;
+    Transform transform;
+};
+
+// Indices [firstIndex, firstIndex + indexCount) of an instance's reordered triangles, ready for a multi-draw
+struct MeshletDrawRange {
+    std::uint32_t firstIndex;
+    std::uint32_t indexCount;
+};
+
+// Culls meshlets against the view frustum and by their normal cones, in each instance's own space so that neither the
+// spheres nor the cones have to be transformed. All the instances' meshlets are split across the thread pool together,
+// so one huge mesh is culled as much in parallel as many smaller ones, and runs of surviving meshlets that are next
+// to each other are merged into a single draw range.
+class MeshletCulling {
+  public:
+    MeshletCulling(ThreadPool* threadPool, const MeshletOptions& options);
+
+    void cull(std::span<const MeshletInstance> instances, const Camera& camera);
+
+    // An instance's surviving meshlets as of the last cull, empty if none of them are visible
+    [[nodiscard]] std::span<const MeshletDrawRange> draw_ranges(std::size_t instance) const {
+        return std::span(drawRanges).subspan(firstRange[instance], firstRange[instance + 1] - firstRange[instance]);
+    }
+
+    [[nodiscard]] const MeshletOptions& options() const { return meshletOptions; }
+
+    // Totals over every cull so far
+    [[nodiscard]] std::size_t meshlets_tested() const { return meshletsTested; }
+
+    [[nodiscard]] std::size_t meshlets_culled() const { return meshletsCulled; }
+
+    [[nodiscard]] std::size_t triangles_culled() const { return trianglesCulled; }
+
+  private:
+    // The camera as seen from one instance
+    struct InstanceView {
+        // Left, right, bottom, top, near and far, normalized so spheres can be tested by distance
+        glm::vec4 planes[6];
+        // The camera's position, or for orthographic cameras the direction it looks in
+        glm::vec3 eye;
+        bool coneCulling;
+    };
+
+    ThreadPool* threadPool;
+    MeshletOptions meshletOptions;
+    // Kept between culls so their capacity is reused
+    std::vector<InstanceView> views;
+    // Where each instance's meshlets start among all of them, with the total at the end
+    std::vector<std::size_t> firstMeshlet;
+    std::vector<std::uint8_t> visible;
+    std::vector<MeshletDrawRange> drawRanges;
+    std::vector<std::size_t> firstRange;
+    bool perspective = true;
+    std::size_t meshletsTested = 0;
+    std::size_t meshletsCulled = 0;
+    std::size_t trianglesCulled = 0;
+
+    [[nodiscard]] bool is_visible(const Meshlet& meshlet, const InstanceView& view) const;
+};
+} // namespace tel
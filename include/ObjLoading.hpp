@@ -0,0 +1,17 @@
+#pragma once
+#include "MeshLoading.hpp"
+
+#include <string_view>
+
+namespace tel {
+class ThreadPool;
+
+// Looks at the first few lines only: true if each of them is something a Wavefront OBJ file may contain
+[[nodiscard]] bool looks_like_obj(std::string_view data);
+
+// Parses positions, texture coordinates, normals and polygonal faces, fanning faces into triangles and merging
+// corners that share the same v/vt/vn indices into one vertex. The file is split into line-aligned chunks that are
+// parsed in parallel when a thread pool is given. Fails on anything it does not handle (free-form geometry, line
+// continuations, malformed numbers or indices), so the caller can fall back to a general importer.
+std::expected<Mesh, MeshLoadError> load_obj_from_memory(std::string_view data, ThreadPool* threadPool = nullptr);
+} // namespace tel
@@ -0,0 +1,94 @@
+#pragma once
+#include "Mesh.hpp"
+#include "ResourceLookup.hpp"
+#include "Scene.hpp"
+#include "ThreadPool.hpp"
+
+#include <cstdint>
+#include <glm/mat4x4.hpp>
+#include <span>
+#include <vector>
+
+namespace tel {
+struct OcclusionCullingOptions {
+    bool enabled = true;
+    // Resolution of the software depth buffer occluders are rasterized into
+    int width = 256;
+    int height = 128;
+};
+
+struct OcclusionQuery {
+    BoundingBox bounds;
+    Transform transform;
+};
+
+// A triangle set up for rasterization: the edge functions opposite each vertex as a * x + b * y + c, positive inside,
+// the vertex depths in [0, 1] and the clamped pixel bounds
+struct OccluderTriangle {
+    float edgeA[3];
+    float edgeB[3];
+    float edgeC[3];
+    float depth[3];
+    float inverseArea;
+    int minX;
+    int maxX;
+    int minY;
+    int maxY;
+};
+
+// Rasterizes occluders into a small CPU depth buffer and tests object bounds against a min/max depth pyramid built
+// from it, so nothing has to be read back from the GPU. Everything runs on the thread pool; the rasterizer uses 8-wide
+// AVX2 edge functions when the CPU supports them.
+class OcclusionCulling {
+  public:
+    OcclusionCulling(ThreadPool* threadPool, const OcclusionCullingOptions& options);
+
+    OccluderHandle add_occluder_mesh(const Mesh& mesh);
+
+    // Writes one flag per query, nonzero if the object may be visible
+    void cull(std::span<const Occluder> occluders, const glm::mat4& viewProjection,
+              std::span<const OcclusionQuery> queries, std::span<std::uint8_t> visible);
+
+    void render_occluders(std::span<const Occluder> occluders, const glm::mat4& viewProjection);
+
+    // Conservative: anything crossing the near plane or not fully behind occluders counts as visible
+    [[nodiscard]] bool is_visible(const OcclusionQuery& query) const;
+
+    [[nodiscard]] const OcclusionCullingOptions& options() const { return cullingOptions; }
+
+  private:
+    struct OccluderMesh {
+        std::vector<Position> positions;
+        std::vector<TriangleIndex> triangles;
+    };
+
+    struct DepthLevel {
+        int width;
+        int height;
+        // Farthest occluder depth below each texel
+        std::vector<float> depth;
+        // Nearest occluder depth below each texel
+        std::vector<float> nearest;
+    };
+
+    ThreadPool* threadPool;
+    OcclusionCullingOptions cullingOptions;
+    ResourceLookup<OccluderMesh> occluderMeshes;
+    // Rows are padded to a multiple of 8 so the wide rasterizer never needs a tail loop
+    int stride;
+    std::vector<float> depthBuffer;
+    std::vector<DepthLevel> pyramid;
+    // Kept between frames so their capacity is reused
+    std::vector<const OccluderMesh*> frameMeshes;
+    std::vector<std::vector<OccluderTriangle>> perOccluderTriangles;
+    std::vector<OccluderTriangle> triangles;
+    glm::mat4 currentViewProjection{1.0f};
+    bool useAvx2;
+
+    void setup_triangles(std::span<const Occluder> occluders, const glm::mat4& viewProjection);
+
+    void rasterize_rows(int beginRow, int endRow);
+
+    void build_pyramid();
+};
+} // namespace tel
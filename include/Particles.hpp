@@ -0,0 +1,112 @@
+#pragma once
+#include "Initializations.hpp"
+#include "RenderingHandles.hpp"
+#include "ResourceLookup.hpp"
+#include "ThreadPool.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <span>
+#include <vector>
+
+namespace tel {
+struct ParticleEmitterSettings {
+    MustInit<ShaderHandle> shader;
+    glm::vec3 position{0.0f};
+    // New particles start anywhere in a box this far from the position along each axis
+    glm::vec3 positionSpread{0.0f};
+    // Per second
+    float rate = 1000.0f;
+    // Emission pauses while this many particles are alive
+    std::size_t maxParticles = 100'000;
+    // In seconds, each particle's lifetime is up to lifetimeSpread away from lifetime
+    float lifetime = 2.0f;
+    float lifetimeSpread = 0.5f;
+    glm::vec3 velocity{0.0f, 2.0f, 0.0f};
+    glm::vec3 velocitySpread{1.0f};
+    glm::vec3 acceleration{0.0f, -9.81f, 0.0f};
+    // Share of its velocity a particle loses per second
+    float drag = 0.0f;
+    // Size and colour go linearly from start to end over each particle's life
+    float startSize = 0.05f;
+    float endSize = 0.0f;
+    glm::vec4 startColor{1.0f};
+    glm::vec4 endColor{1.0f, 1.0f, 1.0f, 0.0f};
+    // Otherwise blended by alpha, which does not sort particles and so only suits soft or uniform colours
+    bool additive = false;
+    std::uint32_t seed = 1;
+};
+
+// What each particle's billboard is drawn from, one per instance
+struct ParticleInstance {
+    glm::vec3 position;
+    float size;
+    // RGBA8, red in the lowest byte
+    std::uint32_t color;
+};
+static_assert(sizeof(ParticleInstance) == 20);
+
+// One instanced draw: the emitter's particles are instances [first, first + count) of write_instances' output
+struct ParticleBatch {
+    ShaderHandle shader;
+    bool additive;
+    std::size_t first;
+    std::size_t count;
+};
+
+// Simulates particles as structures of arrays, one stream per component with room for every particle an emitter may
+// have, so nothing is allocated while running. Each update integrates and ages every particle 8 at a time with AVX2
+// when available, split across the thread pool, removes the dead by moving the last live particle into their place and
+// spawns new ones at the end.
+class ParticleSystem {
+  public:
+    explicit ParticleSystem(ThreadPool* threadPool);
+
+    ParticleEmitterHandle create_emitter(const ParticleEmitterSettings& settings);
+
+    void remove_emitter(ParticleEmitterHandle emitter);
+
+    // Changes apply from the next update; maxParticles is fixed once the emitter is created
+    [[nodiscard]] ParticleEmitterSettings& settings(ParticleEmitterHandle emitter);
+
+    void update(float deltaSeconds);
+
+    [[nodiscard]] std::size_t particle_count() const { return liveParticles; }
+
+    // As of the last update
+    [[nodiscard]] std::span<const ParticleBatch> batches() const { return frameBatches; }
+
+    // Writes particle_count() instances, for example straight into mapped GPU memory
+    void write_instances(std::span<ParticleInstance> instances);
+
+  private:
+    enum Stream { PositionX, PositionY, PositionZ, VelocityX, VelocityY, VelocityZ, Age, Lifetime, StreamCount };
+
+    struct Emitter {
+        ParticleEmitterSettings settings;
+        std::size_t capacity;
+        std::array<std::vector<float>, StreamCount> streams;
+        std::size_t count = 0;
+        // Fractions of a particle carried over to the next update
+        float pendingSpawns = 0.0f;
+        std::uint32_t random;
+    };
+
+    ThreadPool* threadPool;
+    ResourceLookup<Emitter> emitters{MemorySubsystem::Particles};
+    std::vector<ParticleBatch> frameBatches;
+    // Parallel to frameBatches
+    std::vector<const Emitter*> frameEmitters;
+    std::size_t liveParticles = 0;
+    bool useAvx2;
+
+    void integrate(Emitter& emitter, float deltaSeconds);
+
+    void kill(Emitter& emitter);
+
+    static void spawn(Emitter& emitter, float deltaSeconds);
+};
+} // namespace tel
@@ -0,0 +1,127 @@
+#pragma once
+#include "Camera.hpp"
+#include "Mesh.hpp"
+#include "RenderingHandles.hpp"
+#include "Scene.hpp"
+
+#include <array>
+#include <cstdint>
+#include <glm/mat4x4.hpp>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace tel {
+// Hits are reported as distances along direction, which is in world units when direction has unit length. The
+// direction is deliberately not normalized when moved into object space, so distances stay comparable between
+// objects with different scales.
+struct Ray {
+    glm::vec3 origin{};
+    glm::vec3 direction{0.0f, 0.0f, -1.0f};
+    float maxDistance = std::numeric_limits<float>::infinity();
+};
+
+// A ray from the camera through a pixel, with the pixel given from the top-left corner like window coordinates
+[[nodiscard]] Ray pick_ray(const Camera& camera, glm::vec2 pixel, glm::vec2 viewportSize);
+
+struct MeshHit {
+    float distance;
+    // Index of the triangle in the mesh, so tel::Mesh::triangles[3 * triangle] is its first corner
+    std::uint32_t triangle;
+    // Weights of the second and third corner; the first has 1 - x - y
+    glm::vec2 barycentric;
+};
+
+// A bounding volume hierarchy over a mesh's triangles, built with the surface area heuristic over binned centroids.
+// Immutable once built, so any number of threads can query it at once.
+class MeshBvh {
+  public:
+    static MeshBvh build(const Mesh& mesh);
+
+    [[nodiscard]] std::optional<MeshHit> closest_hit(const Ray& ray) const;
+
+    // Stops at the first triangle found, for line-of-sight and shadow queries
+    [[nodiscard]] bool any_hit(const Ray& ray) const;
+
+    [[nodiscard]] const BoundingBox& bounds() const { return meshBounds; }
+
+    [[nodiscard]] std::size_t triangle_count() const { return triangleIds.size(); }
+
+    [[nodiscard]] std::size_t node_count() const { return nodes.size(); }
+
+    [[nodiscard]] std::size_t size_in_bytes() const;
+
+    // What a BVH over that many triangles can take at most, for budgeting before it is built
+    [[nodiscard]] static std::size_t max_size_in_bytes(std::size_t triangleCount);
+
+  private:
+    // Children of an inner node are stored next to each other, so one index finds both
+    struct Node {
+        glm::vec3 min;
+        // First child of an inner node, first triangle of a leaf
+        std::uint32_t leftOrFirst;
+        glm::vec3 max;
+        // Zero for inner nodes
+        std::uint32_t count;
+    };
+    static_assert(sizeof(Node) == 32);
+
+    // Triangles in leaf order as a corner and the two edges leaving it, one stream per coordinate so a leaf can be
+    // tested 8 triangles at a time. Every stream is padded so 8-wide loads starting at any triangle stay inside it.
+    struct TriangleStreams {
+        std::array<std::vector<float>, 3> corner;
+        std::array<std::vector<float>, 3> edge1;
+        std::array<std::vector<float>, 3> edge2;
+    };
+
+    std::vector<Node> nodes;
+    TriangleStreams triangles;
+    // Original index of each triangle in leaf order
+    std::vector<std::uint32_t> triangleIds;
+    BoundingBox meshBounds{};
+    bool useAvx2 = false;
+
+    template <bool anyHit>
+    bool traverse(const Ray& ray, MeshHit& hit) const;
+};
+
+struct SceneHit {
+    float distance;
+    glm::vec3 position;
+    // Index into Scene::sceneObjects, or into Scene::streamedObjects when streamed is set
+    std::size_t object;
+    bool streamed;
+    MeshHandle mesh;
+    std::uint32_t triangle;
+    glm::vec2 barycentric;
+};
+
+// A snapshot of a scene's objects for ray queries. Rays are tested against each object's world-space bounds, then
+// moved into object space by the inverse of its transform and traced through its mesh's BVH. Holds no references into
+// the scene, so it can be queried from worker threads while the scene changes.
+class RaycastScene {
+  public:
+    void add(const SceneObject& object, std::shared_ptr<const MeshBvh> bvh, std::size_t index, bool streamed);
+
+    [[nodiscard]] std::optional<SceneHit> closest_hit(const Ray& ray) const;
+
+    [[nodiscard]] bool any_hit(const Ray& ray) const;
+
+    [[nodiscard]] std::size_t size() const { return instances.size(); }
+
+  private:
+    struct Instance {
+        glm::mat4 worldToObject;
+        BoundingBox worldBounds;
+        std::shared_ptr<const MeshBvh> bvh;
+        MeshHandle mesh;
+        std::size_t object;
+        bool streamed;
+    };
+
+    std::vector<Instance> instances;
+};
+} // namespace tel
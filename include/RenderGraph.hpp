@@ -0,0 +1,109 @@
+#pragma once
+#include "rendering_internals/Framebuffer.hpp"
+#include "rendering_internals/RenderTargetPool.hpp"
+
+#include <expected>
+#include <functional>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace tel {
+using RenderTargetHandle = unsigned int;
+
+struct RenderPassContext {
+    // Null for passes that write no targets
+    const Framebuffer* framebuffer;
+    std::span<const Texture* const> targets;
+
+    // The storage behind a target this pass declared, e.g. to sample one it reads
+    [[nodiscard]] const Texture& texture(RenderTargetHandle target) const { return *targets[target]; }
+};
+
+struct RenderGraphError {
+    std::string pass;
+};
+
+// A frame described as passes that declare which targets they read and write. Compiling culls every pass whose
+// output nothing consumes, orders the rest by their dependencies, and works out how long each transient target
+// lives so executing can hand out pooled storage just for that span.
+class RenderGraph {
+  public:
+    class PassBuilder {
+      public:
+        void read(RenderTargetHandle target);
+
+        void write(RenderTargetHandle target);
+
+        // Keeps the pass even if nothing reads what it writes
+        void has_side_effects();
+
+      private:
+        friend class RenderGraph;
+
+        PassBuilder(RenderGraph* graph, std::size_t pass) : graph(graph), pass(pass) {}
+
+        RenderGraph* graph;
+        std::size_t pass;
+    };
+
+    using Setup = std::function<void(PassBuilder&)>;
+    using Execute = std::function<void(const RenderPassContext&)>;
+    using BindFramebuffer = std::function<void(const Framebuffer&)>;
+
+    RenderTargetHandle create_target(std::string name, const RenderTargetOptions& options);
+
+    // Takes effect from the next execute, without recompiling; the pool hands out storage of the new size
+    void resize_target(RenderTargetHandle target, int width, int height);
+
+    // Targets outside the graph, such as the window's framebuffer. Imported targets always count as used.
+    RenderTargetHandle import_framebuffer(std::string name, const Framebuffer& framebuffer);
+
+    void add_pass(std::string name, const Setup& setup, Execute execute);
+
+    std::expected<void, RenderGraphError> compile();
+
+    void execute(RenderTargetPool& pool, const BindFramebuffer& bindFramebuffer);
+
+    [[nodiscard]] std::span<const std::size_t> execution_order() const { return order; }
+
+    [[nodiscard]] bool is_culled(std::size_t pass) const { return passes[pass].culled; }
+
+    [[nodiscard]] std::size_t pass_count() const { return passes.size(); }
+
+  private:
+    struct Target {
+        std::string name;
+        RenderTargetOptions options;
+        const Framebuffer* imported = nullptr;
+        std::vector<std::size_t> writers;
+        std::vector<std::size_t> readers;
+        // Positions in the execution order of the first and last pass touching the target
+        std::size_t firstUse = 0;
+        std::size_t lastUse = 0;
+    };
+
+    struct Pass {
+        std::string name;
+        Execute execute;
+        std::vector<RenderTargetHandle> reads;
+        std::vector<RenderTargetHandle> writes;
+        bool sideEffects = false;
+        bool culled = false;
+    };
+
+    std::vector<Target> targets;
+    std::vector<Pass> passes;
+    std::vector<std::size_t> order;
+    bool compiled = false;
+    // Scratch space for execute(), kept so running the same graph every frame does not allocate
+    std::vector<const Texture*> physical;
+    std::vector<const Texture*> attachments;
+
+    void cull();
+
+    std::expected<void, RenderGraphError> sort();
+
+    void compute_lifetimes();
+};
+} // namespace tel
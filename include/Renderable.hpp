@@ -2,9 +2,14 @@
 #include "Initializations.hpp"
 #include "RenderingHandles.hpp"
 
+#include <optional>
+
 namespace tel {
 struct Renderable {
     MustInit<ShaderHandle> shader;
     MustInit<MeshHandle> mesh;
+    std::optional<TextureHandle> texture{};
+    // Poses a mesh loaded with skin weights; without it the mesh is drawn in its bind pose
+    std::optional<AnimationHandle> animation{};
 };
 } // namespace tel
\ No newline at end of file
@@ -1,47 +1,46 @@
 #pragma once
+#include "Animation.hpp"
+#include "ClusteredLighting.hpp"
+#include "DynamicResolution.hpp"
+#include "EmbeddedAssets.hpp"
+#include "FrameArena.hpp"
+#include "FramebufferReadback.hpp"
+#include "GpuMemory.hpp"
 #include "Mesh.hpp"
+#include "MeshResidency.hpp"
+#include "Meshlets.hpp"
+#include "OcclusionCulling.hpp"
+#include "Particles.hpp"
+#include "RayCasting.hpp"
+#include "RenderGraph.hpp"
 #include "RenderingHandles.hpp"
+#include "ResourceLookup.hpp"
 #include "Scene.hpp"
+#include "TextureStreaming.hpp"
+#include "ThreadPool.hpp"
 #include "Util.hpp"
 #include "Window.hpp"
 #include "rendering_internals/ElementBuffer.hpp"
 #include "rendering_internals/Framebuffer.hpp"
 #include "rendering_internals/GPUMesh.hpp"
+#include "rendering_internals/GpuTimer.hpp"
+#include "rendering_internals/InstanceBuffer.hpp"
+#include "rendering_internals/RenderTargetPool.hpp"
 #include "rendering_internals/Shader.hpp"
+#include "rendering_internals/ShaderIncludes.hpp"
+#include "rendering_internals/ShaderStorageBuffer.hpp"
 #include "rendering_internals/VertexArray.hpp"
 #include "rendering_internals/VertexBuffer.hpp"
 #include <glm/gtc/type_ptr.hpp>
 
+#include <array>
+#include <concepts>
+#include <cstddef>
 #include <iostream>
-#include <unordered_map>
+#include <limits>
+#include <memory>
 
 namespace tel {
-template <typename T>
-class ResourceLookup {
-  public:
-    using Handle = unsigned int;
-
-    Handle add(T resource) {
-        Handle currentHandle = nextHandle;
-        lookup.emplace(currentHandle, std::move(resource));
-        ++nextHandle;
-        return currentHandle;
-    }
-
-    template <typename Key>
-    [[nodiscard]] T* find(const Key& key) {
-        auto iter = lookup.find(key);
-        if (iter != lookup.end()) {
-            return &iter->second;
-        }
-        return nullptr;
-    }
-
-  private:
-    std::unordered_map<Handle, T> lookup;
-    Handle nextHandle = 0;
-};
-
 template <typename T>
 constexpr GLenum gl_enum();
 
@@ -55,44 +54,255 @@ constexpr GLenum gl_enum<unsigned int>() {
     return GL_UNSIGNED_INT;
 }
 
+struct MeshLoadOptions {
+    // Builds a BVH on the thread pool so raycast_scene can hit the mesh. It lives as long as the mesh and is accounted
+    // to MemorySubsystem::Raycasting.
+    bool raycastable = false;
+};
+
+struct RenderingOptions {
+    TextureStreamingOptions textures{};
+    OcclusionCullingOptions occlusion{};
+    FramebufferReadbackOptions readback{};
+    ClusteredLightingOptions lighting{};
+    MeshResidencyOptions meshes{};
+    DynamicResolutionOptions resolution{};
+    MeshletOptions meshlets{};
+};
+
 class Rendering {
   public:
-    explicit Rendering(Window* window) : window(window) {
+    // Per-frame scratch memory comes from frameArena, which the caller resets between frames
+    Rendering(Window* window, ThreadPool* threadPool, FrameArena* frameArena, const RenderingOptions& options = {})
+        : window(window), threadPool(threadPool), frameArena(frameArena),
+          textureStreaming(threadPool, options.textures), occlusionCulling(threadPool, options.occlusion),
+          readback(threadPool, options.readback, [this](const Framebuffer& framebuffer) { bind(framebuffer); }),
+          skeletalAnimation(threadPool), skinningPalettes(ShaderStorageBuffer::create()), particleSystem(threadPool),
+          particleInstances(InstanceBuffer::create()), particleVertexArray(VertexArray::create()),
+          clusteredLighting(threadPool, options.lighting), lightBuffer(ShaderStorageBuffer::create()),
+          clusterRangeBuffer(ShaderStorageBuffer::create()), lightIndexBuffer(ShaderStorageBuffer::create()),
+          clusterGridBuffer(ShaderStorageBuffer::create()), meshResidency(options.meshes),
+          dynamicResolution(options.resolution), fullscreenVertexArray(VertexArray::create()),
+          meshletCulling(threadPool, options.meshlets) {
         glEnable(GL_DEBUG_OUTPUT);
         glDebugMessageCallback(debug_callback, nullptr);
         glEnable(GL_DEPTH_TEST);
+        link_particle_attributes();
+        if (options.resolution.enabled) {
+            upscaleShader = load_upscale_shader();
+        }
+        sceneGraph = create_scene_graph();
     }
 
     void render_scene(const Scene& scene) {
-        begin_frame(window->default_framebuffer());
-        for (const auto& object : scene.sceneObjects) {
+        sceneToDraw = &scene;
+        const glm::ivec2 size = render_size();
+        update_lighting(scene, size);
+        if (!upscaleShader) {
+            render(sceneGraph);
+            return;
+        }
+        sceneGraph.resize_target(sceneColorTarget, size.x, size.y);
+        sceneGraph.resize_target(sceneDepthTarget, size.x, size.y);
+        const auto record = [this](std::size_t, double milliseconds) {
+            dynamicResolution.record_gpu_time(milliseconds);
+        };
+        resolutionTimer.begin(frameIndex, record);
+        render(sceneGraph);
+        resolutionTimer.end();
+        resolutionTimer.collect(record);
+    }
+
+    // Runs every pass that contributes to an imported target, with transient targets drawn from a shared pool
+    void render(RenderGraph& graph) {
+        textureStreaming.update(frameIndex);
+        upload_skinning_palettes();
+        graph.execute(renderTargets, [this](const Framebuffer& framebuffer) { bind(framebuffer); });
+        enforce_mesh_budget();
+        for (auto& [request, callback] : pendingCaptures) {
+            readback.read(window->default_framebuffer(), request, std::move(callback));
+        }
+        pendingCaptures.clear();
+        readback.update();
+        renderTargets.end_frame();
+        ++frameIndex;
+    }
+
+    // Both object lists are culled in one batch, so the occluders are rasterized and meshlets culled once a frame
+    void draw_scene(const Scene& scene) {
+        const std::array<std::span<const SceneObject>, 2> objectLists{scene.sceneObjects, scene.streamedObjects};
+        const std::size_t objectCount = scene.sceneObjects.size() + scene.streamedObjects.size();
+        std::pmr::vector<std::uint8_t> visible(objectCount, frameArena);
+        cull_occluded(scene, objectLists, visible);
+        std::pmr::vector<std::size_t> meshletInstances(objectCount, frameArena);
+        cull_meshlets(scene, objectLists, visible, meshletInstances);
+        std::size_t first = 0;
+        for (const std::span<const SceneObject> objects : objectLists) {
+            draw_objects(scene, objects, std::span(visible).subspan(first, objects.size()),
+                         std::span(meshletInstances).subspan(first, objects.size()));
+            first += objects.size();
+        }
+    }
+
+    // With one visibility flag and meshlet instance per object, from culling
+    void draw_objects(const Scene& scene, std::span<const SceneObject> objects, std::span<const std::uint8_t> visible,
+                      std::span<const std::size_t> meshletInstances) {
+        for (const auto& [object, isVisible, meshletInstance] : std::views::zip(objects, visible, meshletInstances)) {
+            if (!isVisible) {
+                continue;
+            }
             const auto meshObject = lookups.get_lookup<GPUMesh>().find(object.renderable.mesh);
+            assert(meshObject);
+            const auto ranges = meshletInstance == wholeMesh ? std::span<const MeshletDrawRange>()
+                                                             : meshletCulling.draw_ranges(meshletInstance);
+            if (meshletInstance != wholeMesh && ranges.empty()) {
+                continue;
+            }
+            if (!make_resident(*meshObject)) {
+                continue;
+            }
+            meshObject->lastDrawnFrame = frameIndex;
             const auto shader = lookups.get_lookup<Program>().find(object.renderable.shader);
             bind(*shader);
-            assert(meshObject);
             assert(shader);
             set_uniform(*shader, "model", object.transform);
             set_uniform(*shader, "camera", scene.camera.matrix());
-            draw(*meshObject);
+            bind_albedo(*shader, object.renderable.texture);
+            set_uniform(*shader, "paletteOffset", palette_offset(object.renderable));
+            if (meshletInstance == wholeMesh) {
+                draw(*meshObject);
+            } else {
+                draw(*meshObject, ranges);
+            }
         }
     }
 
-    MeshHandle load_mesh(const Mesh& mesh) {
-        GPUMesh meshObject = create_with_buffers();
-        meshObject.numIndices = mesh.triangles.size();
-        stream(meshObject.elementBuffer, mesh.triangles);
-        stream(meshObject, mesh);
-        return lookups.get_lookup<GPUMesh>().add(std::move(meshObject));
+    // Under a finite mesh budget a copy of the mesh is kept in memory, to upload again from once it is evicted
+    MeshHandle load_mesh(const Mesh& mesh, const MeshLoadOptions& options = {}) {
+        return add_mesh(mesh, nullptr, MeshSource{.copy = copy_if_evictable(mesh)}, options);
+    }
+
+    // Rather than a copy being kept, an evicted mesh is produced again by reload on the thread pool the next time it is
+    // drawn, and skipped until it has been uploaded
+    MeshHandle load_mesh(const Mesh& mesh, MeshLoader reload, const MeshLoadOptions& options = {}) {
+        return add_mesh(mesh, nullptr, MeshSource{.load = std::move(reload)}, options);
+    }
+
+    // Each vertex follows up to four joints of whichever animation instance the renderable drawing it names. Ray
+    // queries and culling still use the bind pose.
+    MeshHandle load_mesh(const Mesh& mesh, const SkinWeights& skin, const MeshLoadOptions& options = {}) {
+        assert(skin.joints.size() == mesh.positions.size() && skin.weights.size() == mesh.positions.size());
+        auto skinCopy = copy_if_evictable(skin);
+        return add_mesh(mesh, &skin, MeshSource{.copy = copy_if_evictable(mesh), .skin = std::move(skinCopy)},
+                        options);
+    }
+
+    // Nothing in the scene may still refer to the mesh
+    void unload_mesh(MeshHandle mesh) {
+        const GPUMesh* meshObject = lookups.get_lookup<GPUMesh>().find(mesh);
+        assert(meshObject);
+        if (meshObject->resident) {
+            residentMeshBytes -= meshObject->size_in_bytes();
+        }
+        forget_bound_buffers();
+        lookups.get_lookup<GPUMesh>().remove(mesh);
+    }
+
+    // GPU memory held by the meshes currently uploaded, which MeshResidencyOptions::budget applies to
+    [[nodiscard]] std::size_t resident_mesh_bytes() const { return residentMeshBytes; }
+
+    [[nodiscard]] std::size_t mesh_evictions() const { return meshEvictions; }
+
+    // Meshes split into meshlets, and how many of their meshlets and triangles have been culled so far
+    [[nodiscard]] const MeshletCulling& meshlet_culling() const { return meshletCulling; }
+
+    // A snapshot of the scene's objects for picking and line-of-sight queries, safe to query from any thread. Only
+    // objects whose mesh was loaded raycastable are in it, and not until the mesh's BVH has been built.
+    [[nodiscard]] RaycastScene raycast_scene(const Scene& scene) {
+        using namespace std::chrono_literals;
+        RaycastScene raycastScene;
+        const auto add_objects = [&](std::span<const SceneObject> objects, bool streamed) {
+            for (const auto& [index, object] : std::views::enumerate(objects)) {
+                const auto meshObject = lookups.get_lookup<GPUMesh>().find(object.renderable.mesh);
+                assert(meshObject);
+                if (meshObject->bvh.valid() && meshObject->bvh.wait_for(0s) == std::future_status::ready) {
+                    raycastScene.add(object, meshObject->bvh.get(), static_cast<std::size_t>(index), streamed);
+                }
+            }
+        };
+        add_objects(scene.sceneObjects, false);
+        add_objects(scene.streamedObjects, true);
+        return raycastScene;
+    }
+
+    // Occluders only ever hide objects from the CPU culling, so a few large, simple meshes work best
+    OccluderHandle load_occluder(const Mesh& mesh) { return occlusionCulling.add_occluder_mesh(mesh); }
+
+    // Decoding, mip generation and upload happen in the background; the texture is drawn once it is resident
+    TextureHandle load_texture(std::string encodedData, const TextureLoadOptions& options = {}) {
+        return textureStreaming.request(std::move(encodedData), options);
+    }
+
+    TextureHandle load_texture(Image image, const TextureLoadOptions& options = {}) {
+        return textureStreaming.request(std::move(image), options);
+    }
+
+    void unload_texture(TextureHandle texture) { textureStreaming.unload(texture); }
+
+    [[nodiscard]] const TextureStreaming& texture_streaming() const { return textureStreaming; }
+
+    [[nodiscard]] const RenderTargetPool& render_targets() const { return renderTargets; }
+
+    // Reads the backbuffer once the next frame has been drawn, without waiting for the GPU; see FramebufferReadback
+    void capture(const ReadbackRequest& request, ReadbackCallback callback) {
+        pendingCaptures.emplace_back(request, std::move(callback));
+    }
+
+    [[nodiscard]] std::future<ReadbackResult> capture(const ReadbackRequest& request = {}) {
+        auto promise = std::make_shared<std::promise<ReadbackResult>>();
+        auto future = promise->get_future();
+        capture(request, [promise](ReadbackResult result) { promise->set_value(std::move(result)); });
+        return future;
+    }
+
+    // For reading framebuffers other than the backbuffer; update() is already called once per frame
+    FramebufferReadback& framebuffer_readback() { return readback; }
+
+    // Posed by the engine once per frame; the resulting palettes are uploaded before drawing
+    Animation& animation() { return skeletalAnimation; }
+
+    // Updated by the engine once per frame; every emitter is drawn over the scene with one instanced draw
+    ParticleSystem& particles() { return particleSystem; }
+
+    // The scene's lights as binned for the last frame drawn with render_scene
+    [[nodiscard]] const ClusteredLighting& clustered_lighting() const { return clusteredLighting; }
+
+    [[nodiscard]] const DynamicResolution& dynamic_resolution() const { return dynamicResolution; }
+
+    // What render_scene draws the scene at before upscaling it to the backbuffer, which is the backbuffer's own size
+    // unless dynamic resolution is enabled
+    [[nodiscard]] glm::ivec2 render_size() const {
+        const Framebuffer& backbuffer = window->default_framebuffer();
+        const glm::ivec2 outputSize(backbuffer.width(), backbuffer.height());
+        return upscaleShader ? dynamicResolution.render_size(outputSize) : outputSize;
     }
 
     std::expected<ShaderHandle, ShaderCompilationError> load_shader(const std::string_view& vertexCode,
                                                                     const std::string_view& fragmentCode,
                                                                     const ProgramOptions& options = {}) {
-        auto vertexShader = Shader<ShaderType::Vertex>::create(vertexCode);
+        const auto vertexSource = resolve_shader_includes(vertexCode);
+        if (!vertexSource.has_value()) {
+            return std::unexpected(vertexSource.error());
+        }
+        const auto fragmentSource = resolve_shader_includes(fragmentCode);
+        if (!fragmentSource.has_value()) {
+            return std::unexpected(fragmentSource.error());
+        }
+        auto vertexShader = Shader<ShaderType::Vertex>::create(vertexSource.value());
         if (!vertexShader.has_value()) {
             return std::unexpected(vertexShader.error());
         }
-        auto fragmentShader = Shader<ShaderType::Fragment>::create(fragmentCode);
+        auto fragmentShader = Shader<ShaderType::Fragment>::create(fragmentSource.value());
         if (!fragmentShader.has_value()) {
             return std::unexpected(fragmentShader.error());
         }
@@ -116,6 +326,9 @@ class Rendering {
     template <typename... ResourceTypes>
     class Lookups {
       public:
+        // One subsystem per resource type, in the same order, for the lookups' memory to be accounted to
+        explicit Lookups(std::same_as<MemorySubsystem> auto... subsystems) : lookups(subsystems...) {}
+
         template <typename T>
         ResourceLookup<T>& get_lookup() {
             return std::get<ResourceLookup<T>>(lookups);
@@ -125,33 +338,298 @@ class Rendering {
         std::tuple<ResourceLookup<ResourceTypes>...> lookups;
     };
 
-    Lookups<GPUMesh, Program> lookups;
+    Lookups<GPUMesh, Program> lookups{MemorySubsystem::Meshes, MemorySubsystem::Rendering};
     Window* window;
+    ThreadPool* threadPool;
+    FrameArena* frameArena;
+    TextureStreaming textureStreaming;
+    RenderTargetPool renderTargets;
+    OcclusionCulling occlusionCulling;
+    FramebufferReadback readback;
+    std::vector<std::pair<ReadbackRequest, ReadbackCallback>> pendingCaptures;
+    Animation skeletalAnimation;
+    ShaderStorageBuffer skinningPalettes;
+    ParticleSystem particleSystem;
+    InstanceBuffer particleInstances;
+    VertexArray particleVertexArray;
+    ClusteredLighting clusteredLighting;
+    ShaderStorageBuffer lightBuffer;
+    ShaderStorageBuffer clusterRangeBuffer;
+    ShaderStorageBuffer lightIndexBuffer;
+    ShaderStorageBuffer clusterGridBuffer;
+    // Built once; the scene pass draws whichever scene render_scene was last given
+    RenderGraph sceneGraph;
+    const Scene* sceneToDraw = nullptr;
+    std::uint64_t frameIndex = 0;
+    MeshResidencyOptions meshResidency;
+    std::size_t residentMeshBytes = 0;
+    std::size_t meshEvictions = 0;
+    DynamicResolution dynamicResolution;
+    // Times each render_scene on the GPU for dynamic resolution, which only runs with an upscale shader
+    GpuTimer resolutionTimer;
+    std::optional<ShaderHandle> upscaleShader;
+    // Upscaling draws one triangle from the vertex index alone, but a vertex array still has to be bound
+    VertexArray fullscreenVertexArray;
+    RenderTargetHandle sceneColorTarget = 0;
+    RenderTargetHandle sceneDepthTarget = 0;
+    MeshletCulling meshletCulling;
+    // Marks objects whose mesh is drawn in one piece rather than meshlet by meshlet
+    static constexpr std::size_t wholeMesh = std::numeric_limits<std::size_t>::max();
 
     template <typename T>
-    void stream(const VertexBuffer<T>& buffer, std::span<const T> data) {
+    void stream(VertexBuffer<T>& buffer, std::span<const T> data) {
         if (data.empty()) {
             std::cout << "Empty buffer!\n";
             return;
         }
         bind(buffer);
         glBufferStorage(GL_ARRAY_BUFFER, data.size_bytes(), data.data(), 0);
+        buffer.account(data.size_bytes());
     }
 
-    void stream(const GPUMesh& gpuMesh, const Mesh& mesh) {
+    void stream(GPUMesh& gpuMesh, const Mesh& mesh) {
         auto func = [&]<size_t... indices>(std::index_sequence<indices...>) {
             (stream(std::get<indices>(gpuMesh.attachments), std::span(std::get<indices>(mesh.vertex_attributes()))),
              ...);
         };
-        func(std::make_index_sequence<std::tuple_size_v<decltype(gpuMesh.attachments)>>{});
+        func(std::make_index_sequence<std::tuple_size_v<decltype(mesh.vertex_attributes())>>{});
+        if (mesh.texCoords.empty()) {
+            // The attribute then reads as zero rather than from a buffer with no storage
+            bind(gpuMesh.vertexArray);
+            glDisableVertexAttribArray(texCoordLocation);
+            return;
+        }
+        stream(std::get<texCoordLocation>(gpuMesh.attachments), std::span(mesh.texCoords));
     }
 
-    void stream(const ElementBuffer& elementBuffer, std::span<const ElementBuffer::Index> data) {
+    void stream(ElementBuffer& elementBuffer, std::span<const ElementBuffer::Index> data) {
         if (data.empty()) {
             return;
         }
         bind(elementBuffer);
         glBufferStorage(GL_ELEMENT_ARRAY_BUFFER, static_cast<long long>(data.size_bytes()), data.data(), 0);
+        elementBuffer.account(data.size_bytes());
+    }
+
+    // The copy's vectors use the default allocator, so their bytes are accounted to MemorySubsystem::Meshes by hand
+    template <typename T>
+    std::shared_ptr<const T> copy_if_evictable(const T& data) const {
+        if (meshResidency.budget == std::numeric_limits<std::size_t>::max()) {
+            return nullptr;
+        }
+        const std::size_t bytes = size_in_bytes(data);
+        memory_tracker().record_allocation(MemorySubsystem::Meshes, bytes);
+        return std::shared_ptr<const T>(new T(data), [bytes](const T* copy) {
+            memory_tracker().record_deallocation(MemorySubsystem::Meshes, bytes);
+            delete copy;
+        });
+    }
+
+    MeshHandle add_mesh(const Mesh& mesh, const SkinWeights* skin, MeshSource source, const MeshLoadOptions& options) {
+        GPUMesh meshObject{};
+        meshObject.bounds = compute_bounds(mesh);
+        meshObject.source = std::move(source);
+        meshObject.lastDrawnFrame = frameIndex;
+        upload(meshObject, mesh, skin);
+        if (options.raycastable) {
+            meshObject.bvh = build_bvh(mesh);
+        }
+        return lookups.get_lookup<GPUMesh>().add(std::move(meshObject));
+    }
+
+    // The geometry is copied for the build and freed once it is done; only the BVH itself is kept
+    std::shared_future<std::shared_ptr<const MeshBvh>> build_bvh(const Mesh& mesh) {
+        Mesh geometry{.positions = mesh.positions, .triangles = mesh.triangles};
+        return threadPool
+            ->submit([geometry = std::move(geometry)] {
+                auto* bvh = new MeshBvh(MeshBvh::build(geometry));
+                const std::size_t bytes = bvh->size_in_bytes();
+                memory_tracker().record_allocation(MemorySubsystem::Raycasting, bytes);
+                return std::shared_ptr<const MeshBvh>(bvh, [bytes](const MeshBvh* built) {
+                    memory_tracker().record_deallocation(MemorySubsystem::Raycasting, bytes);
+                    delete built;
+                });
+            })
+            .share();
+    }
+
+    // Large static meshes are split into meshlets again every upload, which reorders their triangles the same way
+    void upload(GPUMesh& meshObject, const Mesh& mesh, const SkinWeights* skin) {
+        create_buffers(meshObject);
+        meshObject.numIndices = mesh.triangles.size();
+        const MeshletOptions& meshletOptions = meshletCulling.options();
+        if (meshletOptions.enabled && !skin && mesh.triangles.size() / 3 >= meshletOptions.minTriangles) {
+            MeshletMesh split = build_meshlets(mesh, meshletOptions);
+            stream(meshObject.elementBuffer, split.triangles);
+            meshObject.meshlets = std::move(split.meshlets);
+        } else {
+            stream(meshObject.elementBuffer, mesh.triangles);
+        }
+        stream(meshObject, mesh);
+        if (skin) {
+            meshObject.skinJoints = VertexBuffer<JointIndices>::create();
+            meshObject.skinWeights = VertexBuffer<JointWeights>::create();
+            stream(meshObject.skinJoints, std::span<const JointIndices>(skin->joints));
+            stream(meshObject.skinWeights, std::span<const JointWeights>(skin->weights));
+            bind(meshObject.vertexArray);
+            bind(meshObject.skinJoints);
+            glVertexAttribIPointer(jointIndicesLocation, 4, GL_UNSIGNED_BYTE, sizeof(JointIndices), nullptr);
+            glEnableVertexAttribArray(jointIndicesLocation);
+            bind(meshObject.skinWeights);
+            glVertexAttribPointer(jointWeightsLocation, 4, GL_FLOAT, false, sizeof(JointWeights), nullptr);
+            glEnableVertexAttribArray(jointWeightsLocation);
+        }
+        meshObject.resident = true;
+        residentMeshBytes += meshObject.size_in_bytes();
+    }
+
+    // Uploads an evicted mesh again, straight away from a copy in memory or once its loader has finished. False while
+    // the mesh cannot be drawn yet.
+    bool make_resident(GPUMesh& meshObject) {
+        using namespace std::chrono_literals;
+        if (meshObject.resident) {
+            return true;
+        }
+        const MeshSource& source = meshObject.source;
+        if (source.copy) {
+            upload(meshObject, *source.copy, source.skin.get());
+            return true;
+        }
+        if (!meshObject.reloading.valid()) {
+            meshObject.reloading = threadPool->submit(source.load);
+            return false;
+        }
+        if (meshObject.reloading.wait_for(0s) != std::future_status::ready) {
+            return false;
+        }
+        // A failed reload is tried again the next time the mesh is drawn
+        const auto reloaded = meshObject.reloading.get();
+        if (!reloaded) {
+            std::cout << "Could not reload an evicted mesh\n";
+            return false;
+        }
+        upload(meshObject, *reloaded, source.skin.get());
+        return true;
+    }
+
+    // Evicts the least recently drawn meshes that can be uploaded again, until the rest fit in the budget
+    void enforce_mesh_budget() {
+        if (residentMeshBytes <= meshResidency.budget) {
+            return;
+        }
+        std::pmr::vector<GPUMesh*> candidates(frameArena);
+        for (auto& [handle, meshObject] : lookups.get_lookup<GPUMesh>()) {
+            if (meshObject.resident && meshObject.source.can_reload() &&
+                meshObject.lastDrawnFrame + meshResidency.graceFrames <= frameIndex) {
+                candidates.push_back(&meshObject);
+            }
+        }
+        std::ranges::sort(candidates, {}, [](const GPUMesh* meshObject) { return meshObject->lastDrawnFrame; });
+        for (GPUMesh* meshObject : candidates) {
+            if (residentMeshBytes <= meshResidency.budget) {
+                break;
+            }
+            residentMeshBytes -= meshObject->size_in_bytes();
+            forget_bound_buffers();
+            meshObject->release_buffers();
+            meshObject->resident = false;
+            ++meshEvictions;
+        }
+    }
+
+    // The names of deleted buffers can be handed out again right away, so what is bound is no longer known
+    void forget_bound_buffers() {
+        currentlyBound.vao = 0;
+        currentlyBound.vbo = 0;
+        currentlyBound.ebo = 0;
+    }
+
+    // Must match the layouts in the vertex shader
+    static constexpr GLuint texCoordLocation = 2;
+    static constexpr GLuint jointIndicesLocation = 3;
+    static constexpr GLuint jointWeightsLocation = 4;
+    static constexpr GLuint skinningPaletteBinding = 0;
+    static constexpr GLuint particlePositionSizeLocation = 0;
+    static constexpr GLuint particleColorLocation = 1;
+    // Must match data/shaders/ClusteredLighting.glsl
+    static constexpr GLuint lightBinding = 1;
+    static constexpr GLuint clusterRangeBinding = 2;
+    static constexpr GLuint lightIndexBinding = 3;
+    static constexpr GLuint clusterGridBinding = 4;
+
+    void upload_skinning_palettes() {
+        const auto palettes = skeletalAnimation.palettes();
+        if (palettes.empty()) {
+            return;
+        }
+        skinningPalettes.upload(std::as_bytes(palettes));
+        skinningPalettes.bind(skinningPaletteBinding);
+    }
+
+    // Bins the lights for the size the scene is drawn at and uploads the clusters for shaders to read
+    void update_lighting(const Scene& scene, glm::ivec2 viewportSize) {
+        clusteredLighting.update(scene.lights, scene.camera, viewportSize.x, viewportSize.y);
+        lightBuffer.upload(std::as_bytes(clusteredLighting.lights()));
+        clusterRangeBuffer.upload(std::as_bytes(clusteredLighting.cluster_ranges()));
+        lightIndexBuffer.upload(std::as_bytes(clusteredLighting.light_indices()));
+        clusterGridBuffer.upload(std::as_bytes(std::span(&clusteredLighting.grid(), 1)));
+        lightBuffer.bind(lightBinding);
+        clusterRangeBuffer.bind(clusterRangeBinding);
+        lightIndexBuffer.bind(lightIndexBinding);
+        clusterGridBuffer.bind(clusterGridBinding);
+    }
+
+    // Four corners of a billboard from the vertex index, and position, size and colour from the instance
+    void link_particle_attributes() {
+        bind(particleVertexArray);
+        glBindBuffer(GL_ARRAY_BUFFER, particleInstances.underlying());
+        currentlyBound.vbo = particleInstances.underlying();
+        glVertexAttribPointer(particlePositionSizeLocation, 4, GL_FLOAT, false, sizeof(ParticleInstance), nullptr);
+        glVertexAttribPointer(particleColorLocation, 4, GL_UNSIGNED_BYTE, true, sizeof(ParticleInstance),
+                              reinterpret_cast<const void*>(offsetof(ParticleInstance, color)));
+        for (const GLuint location : {particlePositionSizeLocation, particleColorLocation}) {
+            glEnableVertexAttribArray(location);
+            glVertexAttribDivisor(location, 1);
+        }
+    }
+
+    // After the opaque scene, testing depth against it without writing any
+    void draw_particles(const Scene& scene) {
+        const std::size_t count = particleSystem.particle_count();
+        if (count == 0) {
+            return;
+        }
+        particleSystem.write_instances(particleInstances.map<ParticleInstance>(count));
+        particleInstances.unmap();
+
+        // The view matrix's rows are the camera's axes in world space
+        const glm::mat4& view = scene.camera.transform;
+        const glm::vec3 cameraRight(view[0][0], view[1][0], view[2][0]);
+        const glm::vec3 cameraUp(view[0][1], view[1][1], view[2][1]);
+        bind(particleVertexArray);
+        glEnable(GL_BLEND);
+        glDepthMask(GL_FALSE);
+        for (const ParticleBatch& batch : particleSystem.batches()) {
+            const auto shader = lookups.get_lookup<Program>().find(batch.shader);
+            assert(shader);
+            set_uniform(*shader, "camera", scene.camera.matrix());
+            set_uniform(*shader, "cameraRight", cameraRight);
+            set_uniform(*shader, "cameraUp", cameraUp);
+            glBlendFunc(GL_SRC_ALPHA, batch.additive ? GL_ONE : GL_ONE_MINUS_SRC_ALPHA);
+            glDrawArraysInstancedBaseInstance(GL_TRIANGLE_STRIP, 0, 4, static_cast<GLsizei>(batch.count),
+                                              static_cast<GLuint>(batch.first));
+        }
+        glDepthMask(GL_TRUE);
+        glDisable(GL_BLEND);
+    }
+
+    // Negative for renderables that are not animated, or whose instance has not been posed yet
+    int palette_offset(const Renderable& renderable) {
+        if (!renderable.animation) {
+            return -1;
+        }
+        const auto offset = skeletalAnimation.palette_offset(*renderable.animation);
+        return offset ? static_cast<int>(*offset) : -1;
     }
 
     static void GLAPIENTRY debug_callback(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length,
@@ -171,6 +649,21 @@ class Rendering {
                        nullptr);
     }
 
+    // Only the given ranges of the element buffer, in one multi-draw
+    void draw(const GPUMesh& meshObject, std::span<const MeshletDrawRange> ranges) {
+        std::pmr::vector<GLsizei> counts(frameArena);
+        std::pmr::vector<const void*> offsets(frameArena);
+        counts.reserve(ranges.size());
+        offsets.reserve(ranges.size());
+        for (const MeshletDrawRange& range : ranges) {
+            counts.push_back(static_cast<GLsizei>(range.indexCount));
+            offsets.push_back(reinterpret_cast<const void*>(range.firstIndex * sizeof(ElementBuffer::Index)));
+        }
+        bind(meshObject.vertexArray);
+        glMultiDrawElements(GL_TRIANGLES, counts.data(), gl_enum<ElementBuffer::Index>(), offsets.data(),
+                            static_cast<GLsizei>(ranges.size()));
+    }
+
     void bind(const VertexArray& vertexArray) {
         if (currentlyBound.vao != vertexArray.underlying()) {
             glBindVertexArray(vertexArray.underlying());
@@ -192,6 +685,135 @@ class Rendering {
         }
     }
 
+    // Null if the shaders are missing or do not compile, in which case the scene is drawn at full size
+    std::optional<ShaderHandle> load_upscale_shader() {
+        const auto vertexCode = embedded_assets().read("shaders/Upscale.vert");
+        const auto fragmentCode = embedded_assets().read("shaders/Upscale.frag");
+        if (!vertexCode || !fragmentCode) {
+            std::cout << "Could not find the upscale shaders; dynamic resolution is disabled\n";
+            return std::nullopt;
+        }
+        const auto shader = load_shader(*vertexCode, *fragmentCode);
+        if (!shader) {
+            std::cout << "Could not compile the upscale shaders; dynamic resolution is disabled\n";
+            return std::nullopt;
+        }
+        return *shader;
+    }
+
+    // With dynamic resolution the scene is drawn into transient targets that render_scene resizes every frame, and
+    // then stretched over the backbuffer
+    RenderGraph create_scene_graph() {
+        RenderGraph graph;
+        const auto backbuffer = graph.import_framebuffer("backbuffer", window->default_framebuffer());
+        const auto draw_frame = [this](const RenderPassContext& context) {
+            begin_frame(*context.framebuffer);
+            draw_scene(*sceneToDraw);
+            draw_particles(*sceneToDraw);
+        };
+        if (!upscaleShader) {
+            graph.add_pass("scene", [=](RenderGraph::PassBuilder& builder) { builder.write(backbuffer); }, draw_frame);
+            return graph;
+        }
+        const glm::ivec2 size = render_size();
+        sceneColorTarget = graph.create_target("sceneColor", {.width = size.x, .height = size.y});
+        sceneDepthTarget = graph.create_target(
+            "sceneDepth", {.width = size.x, .height = size.y, .internalFormat = GL_DEPTH_COMPONENT24});
+        graph.add_pass(
+            "scene",
+            [this](RenderGraph::PassBuilder& builder) {
+                builder.write(sceneColorTarget);
+                builder.write(sceneDepthTarget);
+            },
+            draw_frame);
+        graph.add_pass(
+            "upscale",
+            [this, backbuffer](RenderGraph::PassBuilder& builder) {
+                builder.read(sceneColorTarget);
+                builder.write(backbuffer);
+            },
+            [this](const RenderPassContext& context) { upscale(context.texture(sceneColorTarget)); });
+        return graph;
+    }
+
+    // Covers the whole framebuffer, so nothing needs clearing first
+    void upscale(const Texture& scene) {
+        const auto shader = lookups.get_lookup<Program>().find(*upscaleShader);
+        assert(shader);
+        set_uniform(*shader, "scene", 0);
+        set_uniform(*shader, "upscaleFilter",
+                    static_cast<int>(dynamicResolution.options().filter == UpscaleFilter::EdgeAware));
+        // Pooled targets come and go as the size changes, so a name matching the cached one may be a new texture
+        glBindTextureUnit(0, scene.underlying());
+        currentlyBound.texture = scene.underlying();
+        bind(fullscreenVertexArray);
+        glDisable(GL_DEPTH_TEST);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        glEnable(GL_DEPTH_TEST);
+    }
+
+    // Culls the meshlets of every visible object whose mesh has them, in one batch across the thread pool, and gives
+    // each object its instance in meshletCulling or wholeMesh
+    void cull_meshlets(const Scene& scene, std::span<const std::span<const SceneObject>> objectLists,
+                       std::span<const std::uint8_t> visible, std::span<std::size_t> instances) {
+        std::pmr::vector<MeshletInstance> meshletInstances(frameArena);
+        for (const auto& [object, isVisible, instance] :
+             std::views::zip(objectLists | std::views::join, visible, instances)) {
+            instance = wholeMesh;
+            if (!isVisible) {
+                continue;
+            }
+            const auto meshObject = lookups.get_lookup<GPUMesh>().find(object.renderable.mesh);
+            assert(meshObject);
+            if (meshObject->meshlets.empty()) {
+                continue;
+            }
+            instance = meshletInstances.size();
+            meshletInstances.push_back({.meshlets = meshObject->meshlets, .transform = object.transform});
+        }
+        if (!meshletInstances.empty()) {
+            meshletCulling.cull(meshletInstances, scene.camera);
+        }
+    }
+
+    void cull_occluded(const Scene& scene, std::span<const std::span<const SceneObject>> objectLists,
+                       std::span<std::uint8_t> visible) {
+        std::pmr::vector<OcclusionQuery> queries(frameArena);
+        queries.reserve(visible.size());
+        for (const SceneObject& object : objectLists | std::views::join) {
+            const auto meshObject = lookups.get_lookup<GPUMesh>().find(object.renderable.mesh);
+            assert(meshObject);
+            queries.emplace_back(meshObject->bounds, object.transform);
+        }
+        occlusionCulling.cull(scene.occluders, scene.camera.matrix(), queries, visible);
+    }
+
+    void bind(const Framebuffer& framebuffer) {
+        if (currentlyBound.fbo != framebuffer.underlying()) {
+            glBindFramebuffer(GL_FRAMEBUFFER, framebuffer.underlying());
+            currentlyBound.fbo = framebuffer.underlying();
+        }
+        glViewport(0, 0, framebuffer.width(), framebuffer.height());
+    }
+
+    void bind(const TextureBinding& texture) {
+        if (currentlyBound.texture != texture.texture) {
+            glBindTextureUnit(0, texture.texture);
+            currentlyBound.texture = texture.texture;
+        }
+    }
+
+    void bind_albedo(const Program& program, const std::optional<TextureHandle>& texture) {
+        const auto binding = texture ? textureStreaming.use(*texture, frameIndex) : std::nullopt;
+        set_uniform(program, "useAlbedo", static_cast<int>(binding.has_value()));
+        if (!binding) {
+            return;
+        }
+        bind(*binding);
+        set_uniform(program, "albedo", 0);
+        set_uniform(program, "albedoLayer", binding->layer);
+    }
+
     void force_binding(const VertexArray& vertexArray) {
         glBindVertexArray(vertexArray.underlying());
         currentlyBound.vao = vertexArray.underlying();
@@ -217,6 +839,10 @@ class Rendering {
         }
         if constexpr (std::is_same_v<T, glm::mat4>) {
             glUniformMatrix4fv(location.value(), 1, GL_FALSE, glm::value_ptr(value));
+        } else if constexpr (std::is_same_v<T, int>) {
+            glUniform1i(location.value(), value);
+        } else if constexpr (std::is_same_v<T, glm::vec3>) {
+            glUniform3fv(location.value(), 1, glm::value_ptr(value));
         }
     }
 
@@ -233,14 +859,12 @@ class Rendering {
         }
     }
 
-    GPUMesh create_with_buffers() {
-        GPUMesh mesh{};
+    void create_buffers(GPUMesh& mesh) {
         mesh.vertexArray = VertexArray::create();
         mesh.elementBuffer = ElementBuffer::create();
         bind(mesh.vertexArray);
         for_each(mesh.attachments, []<typename T>(T& attachment) { attachment = T::create(); });
         link_attachments(mesh);
-        return mesh;
     }
 
     template <size_t index, typename Attachment>
@@ -5,4 +5,10 @@ using MeshHandle = unsigned int;
 using TextureHandle = unsigned int;
 using ShaderHandle = unsigned int;
 using RenderableHandle = unsigned int;
+using OccluderHandle = unsigned int;
+using SkeletonHandle = unsigned int;
+using AnimationClipHandle = unsigned int;
+using AnimationHandle = unsigned int;
+using ParticleEmitterHandle = unsigned int;
+using ScriptHandle = unsigned int;
 } // namespace tel
\ No newline at end of file
@@ -0,0 +1,61 @@
+#pragma once
+#include "MemoryTracking.hpp"
+
+#include <memory_resource>
+#include <unordered_map>
+#include <utility>
+
+namespace tel {
+template <typename T>
+class ResourceLookup {
+  public:
+    using Handle = unsigned int;
+
+    explicit ResourceLookup(MemorySubsystem subsystem = MemorySubsystem::General)
+        : nodes(tracked_resource(subsystem)), lookup(&nodes) {}
+
+    Handle add(T resource) {
+        Handle currentHandle = nextHandle;
+        lookup.emplace(currentHandle, std::move(resource));
+        ++nextHandle;
+        return currentHandle;
+    }
+
+    // Handles are never reused, so a removed handle stays invalid
+    bool remove(Handle handle) { return lookup.erase(handle) > 0; }
+
+    template <typename Key>
+    [[nodiscard]] T* find(const Key& key) {
+        auto iter = lookup.find(key);
+        if (iter != lookup.end()) {
+            return &iter->second;
+        }
+        return nullptr;
+    }
+
+    template <typename Key>
+    [[nodiscard]] const T* find(const Key& key) const {
+        auto iter = lookup.find(key);
+        if (iter != lookup.end()) {
+            return &iter->second;
+        }
+        return nullptr;
+    }
+
+    [[nodiscard]] auto begin() { return lookup.begin(); }
+
+    [[nodiscard]] auto end() { return lookup.end(); }
+
+    [[nodiscard]] auto begin() const { return lookup.begin(); }
+
+    [[nodiscard]] auto end() const { return lookup.end(); }
+
+    [[nodiscard]] std::size_t size() const { return lookup.size(); }
+
+  private:
+    // Map nodes are all the same size, so they come from fixed-size pools rather than the general heap
+    std::pmr::unsynchronized_pool_resource nodes;
+    std::pmr::unordered_map<Handle, T> lookup;
+    Handle nextHandle = 0;
+};
+} // namespace tel
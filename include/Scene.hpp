@@ -1,6 +1,8 @@
 #pragma once
 #include "Camera.hpp"
+#include "Light.hpp"
 #include "Renderable.hpp"
+#include "RenderingHandles.hpp"
 #include "Transform.hpp"
 
 namespace tel {
@@ -9,8 +11,19 @@ struct SceneObject {
     Renderable renderable;
 };
 
+// Simplified geometry that hides whatever is behind it from the occlusion culling; not drawn itself
+struct Occluder {
+    Transform transform;
+    OccluderHandle mesh;
+};
+
 struct Scene {
     std::vector<SceneObject> sceneObjects;
+    // Filled by WorldStreaming with the objects of the cells currently loaded around the camera
+    std::vector<SceneObject> streamedObjects;
+    std::vector<Occluder> occluders;
+    // Binned into clusters of the view frustum every frame, so each fragment is only shaded by lights that reach it
+    std::vector<Light> lights;
     Camera camera;
 };
 } // namespace tel
\ No newline at end of file
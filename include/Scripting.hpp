@@ -0,0 +1,167 @@
+#pragma once
+#include "RenderingHandles.hpp"
+#include "ResourceLookup.hpp"
+#include "Scene.hpp"
+
+#include <cstddef>
+#include <expected>
+#include <sol/sol.hpp>
+#include <span>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+namespace tel {
+// A flat array of floats owned by a script, for moving data in and out of the scene in bulk. Its arithmetic covers
+// the whole array in one call, so a script updating thousands of objects crosses into C++ a handful of times rather
+// than thousands. Indices are 1-based, as everywhere else in Lua.
+class FloatArray {
+  public:
+    FloatArray() = default;
+
+    explicit FloatArray(std::size_t size, float value = 0.0f) : values(size, value) {}
+
+    [[nodiscard]] std::size_t size() const { return values.size(); }
+
+    void resize(std::size_t size) { values.resize(size); }
+
+    [[nodiscard]] float get(std::size_t index) const { return values.at(index - 1); }
+
+    void set(std::size_t index, float value) { values.at(index - 1) = value; }
+
+    void fill(float value);
+
+    // Element by element; both arrays must be the same size
+    void add(const FloatArray& other);
+
+    void multiply(const FloatArray& other);
+
+    void scale(float factor);
+
+    // this += other * factor
+    void add_scaled(const FloatArray& other, float factor);
+
+    void clamp(float min, float max);
+
+    [[nodiscard]] float sum() const;
+
+    [[nodiscard]] std::span<float> data() { return values; }
+
+    [[nodiscard]] std::span<const float> data() const { return values; }
+
+  private:
+    std::vector<float> values;
+};
+
+// A view of a scene's objects, never a copy, so what a script writes lands straight in the scene. Positions go in and
+// out three floats per object, and whole transforms sixteen, column by column. Arrays of the wrong size are raised as
+// Lua errors.
+class ObjectArray {
+  public:
+    explicit ObjectArray(std::vector<SceneObject>* objects = nullptr) : objects(objects) {}
+
+    [[nodiscard]] std::size_t size() const { return objects->size(); }
+
+    // Resizes out to fit
+    void read_positions(FloatArray& out) const;
+
+    void write_positions(const FloatArray& positions);
+
+    // Moves every object by its offset times factor, e.g. velocities and the frame's duration
+    void translate(const FloatArray& offsets, float factor);
+
+    void translate_all(float x, float y, float z);
+
+    void read_transforms(FloatArray& out) const;
+
+    void write_transforms(const FloatArray& transforms);
+
+    // For the odd object a script singles out; whole arrays should go through the calls above
+    [[nodiscard]] std::tuple<float, float, float> position(std::size_t index) const;
+
+    void set_position(std::size_t index, float x, float y, float z);
+
+  private:
+    std::vector<SceneObject>* objects;
+
+    void check_size(const FloatArray& values, std::size_t perObject) const;
+};
+
+// What each script's update is given every frame
+class ScriptScene {
+  public:
+    ObjectArray objects;
+    // Rebuilt by world streaming every frame, so changes do not last
+    ObjectArray streamed;
+
+    void point_at(Scene& scene);
+
+    // The camera's view matrix, sixteen floats column by column
+    void read_camera(FloatArray& out) const;
+
+    void write_camera(const FloatArray& view);
+
+  private:
+    Camera* camera = nullptr;
+};
+
+struct ScriptError {
+    std::string script;
+    std::string message;
+};
+
+struct ScriptStats {
+    double lastMilliseconds = 0.0;
+    double totalMilliseconds = 0.0;
+    std::size_t updates = 0;
+    // Set when update raises an error, after which the script is not run again
+    bool failed = false;
+};
+
+// Runs Lua scripts once per frame. A script is compiled to bytecode once, when loaded, and returns a table whose
+// update(scene, deltaSeconds) is then called every frame with the scene as bulk views rather than one binding per
+// object. Scripts run in the order they were loaded, each timed on its own, and the Lua heap is accounted to
+// MemorySubsystem::Scripting.
+class Scripting {
+  public:
+    Scripting();
+
+    Scripting(const Scripting&) = delete;
+
+    Scripting& operator=(const Scripting&) = delete;
+
+    // The source may also be bytecode from compile
+    std::expected<ScriptHandle, ScriptError> load_script(std::string name, std::string_view source);
+
+    void unload_script(ScriptHandle script);
+
+    // Bytecode that loads without being parsed again, e.g. to pack into an asset archive ahead of time
+    std::expected<std::string, ScriptError> compile(std::string_view name, std::string_view source);
+
+    void update(Scene& scene, float deltaSeconds);
+
+    [[nodiscard]] const ScriptStats* stats(ScriptHandle script) const;
+
+    // All scripts' update time in the last frame
+    [[nodiscard]] double last_update_milliseconds() const { return lastUpdateMilliseconds; }
+
+    // For binding anything else a game's scripts need
+    sol::state& lua() { return state; }
+
+  private:
+    struct Script {
+        std::string name;
+        sol::protected_function update;
+        ScriptStats stats;
+    };
+
+    sol::state state;
+    ResourceLookup<Script> scripts{MemorySubsystem::Scripting};
+    std::vector<ScriptHandle> updateOrder;
+    ScriptScene scriptScene;
+    double lastUpdateMilliseconds = 0.0;
+
+    void register_types();
+};
+} // namespace tel
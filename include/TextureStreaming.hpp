@@ -0,0 +1,133 @@
+#pragma once
+#include "Image.hpp"
+#include "RenderingHandles.hpp"
+#include "ResourceLookup.hpp"
+#include "ThreadPool.hpp"
+#include "rendering_internals/StagingBuffer.hpp"
+#include "rendering_internals/Texture.hpp"
+
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <limits>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <variant>
+#include <vector>
+
+namespace tel {
+struct TextureLoadOptions {
+    bool generateMips = true;
+    // Stores the texture as a layer of a 2D-array texture shared with other batched textures of the same size, so
+    // they can all be drawn from one binding. Batched textures are never trimmed by the residency cap.
+    bool batch = false;
+};
+
+struct TextureStreamingOptions {
+    std::size_t stagingBufferSize = 64 << 20;
+    // Bytes copied into the staging buffer per update, bounding how long an update can hold the GL thread
+    std::size_t uploadBudgetPerFrame = 16 << 20;
+    // GPU bytes of standalone textures above which unused textures start losing their top mips
+    std::size_t residencyCap = std::numeric_limits<std::size_t>::max();
+    // How many frames a texture must go unused before it can be trimmed
+    std::uint64_t evictionGraceFrames = 120;
+    int layersPerArray = 64;
+};
+
+// Everything a draw needs to sample a texture. Every texture is exposed as a 2D array so shaders only need a single
+// sampler2DArray; standalone textures simply have one layer.
+struct TextureBinding {
+    GLuint texture = 0;
+    int layer = 0;
+};
+
+class TextureStreaming {
+  public:
+    TextureStreaming(ThreadPool* threadPool, const TextureStreamingOptions& options);
+
+    TextureHandle request(std::string encodedData, const TextureLoadOptions& options = {});
+
+    TextureHandle request(Image image, const TextureLoadOptions& options = {});
+
+    // Frees the texture's storage, or returns its layer to the array, and drops the source it was decoded from. The
+    // handle is invalid afterwards.
+    void unload(TextureHandle handle);
+
+    // Collects finished decodes, uploads as much as the budget allows, recycles staging memory and enforces the
+    // residency cap. Call once per frame on the GL thread.
+    void update(std::uint64_t frame);
+
+    // Returns nullopt while the texture is still streaming in. Marks the texture as used this frame, and brings back
+    // the mips of a trimmed texture.
+    std::optional<TextureBinding> use(TextureHandle handle, std::uint64_t frame);
+
+    [[nodiscard]] std::size_t resident_bytes() const { return residentBytes; }
+
+  private:
+    using DecodeResult = std::expected<std::vector<Image>, ImageLoadError>;
+    using Source = std::variant<std::string, Image>;
+
+    enum class State { Decoding, Uploading, Resident, Failed };
+
+    struct ArrayKey {
+        int width;
+        int height;
+        int levels;
+        int channels;
+
+        auto operator<=>(const ArrayKey&) const = default;
+    };
+
+    struct TextureArray {
+        Texture texture;
+        std::vector<int> freeLayers;
+    };
+
+    struct StreamedTexture {
+        TextureLoadOptions options;
+        std::shared_ptr<const Source> source;
+        State state = State::Decoding;
+        std::future<DecodeResult> decoding;
+        std::vector<Image> mips;
+        std::size_t nextUploadLevel = 0;
+        // Standalone storage; the array slot is used instead when batched
+        Texture texture;
+        // Storage being filled while a trimmed texture is restored, swapped in once complete
+        Texture restoring;
+        std::optional<ArrayKey> arrayKey;
+        std::size_t arrayIndex = 0;
+        int layer = 0;
+        int droppedLevels = 0;
+        std::uint64_t lastUsedFrame = 0;
+    };
+
+    ThreadPool* threadPool;
+    TextureStreamingOptions options;
+    StagingBuffer staging;
+    ResourceLookup<StreamedTexture> textures;
+    std::deque<TextureHandle> uploadQueue;
+    // Kept between frames, since a cap the resident textures cannot be trimmed below is checked again every frame
+    std::vector<StreamedTexture*> evictionCandidates;
+    std::map<ArrayKey, std::vector<TextureArray>> arrays;
+    std::size_t residentBytes = 0;
+
+    TextureHandle add(std::shared_ptr<const Source> source, const TextureLoadOptions& loadOptions);
+
+    void start_decoding(StreamedTexture& texture);
+
+    void begin_upload(StreamedTexture& texture);
+
+    bool upload_level(StreamedTexture& texture, std::size_t& budget);
+
+    void finish_upload(StreamedTexture& texture);
+
+    std::pair<std::size_t, int> allocate_layer(const ArrayKey& key);
+
+    void enforce_residency(std::uint64_t frame);
+
+    void drop_top_level(StreamedTexture& texture);
+};
+} // namespace tel
@@ -0,0 +1,217 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <stop_token>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace tel {
+class ThreadPool {
+  public:
+    explicit ThreadPool(unsigned int numThreads = default_thread_count()) {
+        workers.reserve(numThreads);
+        for (unsigned int i = 0; i < numThreads; ++i) {
+            workers.emplace_back([this](std::stop_token stopToken) { work(stopToken); });
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    ThreadPool(ThreadPool&&) = delete;
+
+    ThreadPool& operator=(ThreadPool&&) = delete;
+
+    ~ThreadPool() = default;
+
+    template <typename Func>
+    std::future<std::invoke_result_t<std::decay_t<Func>>> submit(Func&& func) {
+        using Result = std::invoke_result_t<std::decay_t<Func>>;
+        std::packaged_task<Result()> task(std::forward<Func>(func));
+        auto future = task.get_future();
+        {
+            std::scoped_lock lock(mutex);
+            tasks.emplace(std::move(task));
+        }
+        condition.notify_one();
+        return future;
+    }
+
+    // Calls func(begin, end) over [0, count) in chunks of at most grainSize, using the calling thread as one of the
+    // workers. Safe to call from inside a task: while waiting, the caller runs queued tasks instead of blocking.
+    // Nothing is allocated, so it can run many times a frame: the job stays on the caller's stack while workers take
+    // chunks of it.
+    template <typename Func>
+    void parallel_for(std::size_t count, std::size_t grainSize, Func&& func) {
+        if (count == 0) {
+            return;
+        }
+        grainSize = std::max<std::size_t>(grainSize, 1);
+        const std::size_t numChunks = (count + grainSize - 1) / grainSize;
+        if (numChunks == 1 || workers.empty()) {
+            func(std::size_t{0}, count);
+            return;
+        }
+        const auto run_chunk = [&func, count, grainSize](std::size_t chunk) {
+            const std::size_t begin = chunk * grainSize;
+            func(begin, std::min(begin + grainSize, count));
+        };
+        using RunChunk = decltype(run_chunk);
+        ParallelJob job(
+            [](const void* chunks, std::size_t chunk) { (*static_cast<const RunChunk*>(chunks))(chunk); }, &run_chunk,
+            numChunks);
+        const bool shared = share(job);
+        if (shared) {
+            for (std::size_t helper = 1; helper < std::min(numChunks, workers.size() + 1); ++helper) {
+                condition.notify_one();
+            }
+        }
+        job.run_chunks();
+        if (!shared) {
+            return;
+        }
+        withdraw(job);
+        // Every chunk has been claimed by now, so the wait is only for workers still inside theirs
+        while (job.helpers.load(std::memory_order_acquire) != 0) {
+            if (!run_pending_task()) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    template <typename T>
+    T wait(std::future<T>& future) {
+        using namespace std::chrono_literals;
+        while (future.wait_for(0s) != std::future_status::ready) {
+            if (!run_pending_task()) {
+                future.wait_for(100us);
+            }
+        }
+        return future.get();
+    }
+
+    [[nodiscard]] std::size_t thread_count() const { return workers.size(); }
+
+    static unsigned int default_thread_count() { return std::max(std::thread::hardware_concurrency(), 2u) - 1; }
+
+  private:
+    // A parallel_for in progress. Chunks are claimed by bumping nextChunk, and helpers counts the workers that have
+    // picked the job up and not yet finished with it.
+    class ParallelJob {
+      public:
+        using RunChunk = void (*)(const void* chunks, std::size_t chunk);
+
+        ParallelJob(RunChunk run, const void* chunks, std::size_t numChunks)
+            : run(run), chunks(chunks), numChunks(numChunks) {}
+
+        std::atomic<std::size_t> helpers = 0;
+
+        [[nodiscard]] bool has_chunks_left() const { return nextChunk.load(std::memory_order_relaxed) < numChunks; }
+
+        void run_chunks() {
+            for (std::size_t chunk = next(); chunk < numChunks; chunk = next()) {
+                run(chunks, chunk);
+            }
+        }
+
+      private:
+        RunChunk run;
+        const void* chunks;
+        std::size_t numChunks;
+        std::atomic<std::size_t> nextChunk = 0;
+
+        std::size_t next() { return nextChunk.fetch_add(1, std::memory_order_relaxed); }
+    };
+
+    // Far more than nested parallel_for calls ever reach; once full, callers run their chunks themselves
+    static constexpr std::size_t maxParallelJobs = 64;
+
+    std::mutex mutex;
+    std::condition_variable_any condition;
+    std::queue<std::move_only_function<void()>> tasks;
+    std::array<ParallelJob*, maxParallelJobs> jobs{};
+    std::size_t jobCount = 0;
+    // Declared last so the workers are stopped and joined before the queue they read from is destroyed
+    std::vector<std::jthread> workers;
+
+    bool share(ParallelJob& job) {
+        std::scoped_lock lock(mutex);
+        if (jobCount == jobs.size()) {
+            return false;
+        }
+        jobs[jobCount++] = &job;
+        return true;
+    }
+
+    void withdraw(ParallelJob& job) {
+        std::scoped_lock lock(mutex);
+        remove_job(std::ranges::find(jobs.begin(), jobs.begin() + jobCount, &job));
+    }
+
+    // Only called with the mutex held
+    void remove_job(std::array<ParallelJob*, maxParallelJobs>::iterator job) {
+        if (job != jobs.begin() + jobCount) {
+            *job = jobs[--jobCount];
+        }
+    }
+
+    // Only called with the mutex held. Jobs with every chunk claimed are dropped on the way, so idle workers do not
+    // keep picking them up until their callers withdraw them.
+    ParallelJob* join_job() {
+        auto job = jobs.begin();
+        while (job != jobs.begin() + jobCount) {
+            if ((*job)->has_chunks_left()) {
+                (*job)->helpers.fetch_add(1, std::memory_order_relaxed);
+                return *job;
+            }
+            remove_job(job);
+        }
+        return nullptr;
+    }
+
+    // Chunks of a parallel_for come before queued tasks, since their caller is waiting on them. Unlocks the lock.
+    bool run_next(std::unique_lock<std::mutex>& lock) {
+        if (ParallelJob* job = join_job()) {
+            lock.unlock();
+            job->run_chunks();
+            job->helpers.fetch_sub(1, std::memory_order_release);
+            return true;
+        }
+        if (tasks.empty()) {
+            lock.unlock();
+            return false;
+        }
+        std::move_only_function<void()> task = std::move(tasks.front());
+        tasks.pop();
+        lock.unlock();
+        task();
+        return true;
+    }
+
+    bool run_pending_task() {
+        std::unique_lock lock(mutex);
+        return run_next(lock);
+    }
+
+    void work(const std::stop_token& stopToken) {
+        while (!stopToken.stop_requested()) {
+            std::unique_lock lock(mutex);
+            if (!condition.wait(lock, stopToken, [this] { return jobCount > 0 || !tasks.empty(); })) {
+                return;
+            }
+            run_next(lock);
+        }
+    }
+};
+} // namespace tel
@@ -1,11 +1,13 @@
 #pragma once
 
+#include "MemoryTracking.hpp"
 #include "rendering_internals/Framebuffer.hpp"
 
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
 #include <cassert>
 #include <memory>
+#include <memory_resource>
 #include <span>
 #include <stdexcept>
 #include <vector>
@@ -13,11 +15,11 @@
 namespace tel {
 class Window {
   public:
-    Window(int width, int height, const char* title)
+    Window(int width, int height, const char* title, bool visible = true)
         : width(width), height(height), defaultFramebuffer(Framebuffer::define_default_framebuffer(
                                             FramebufferOptions{.width = width, .height = height})) {
         initialize_glfw();
-        set_window_hints();
+        set_window_hints(visible);
         window = std::unique_ptr<GLFWwindow, Deleter>(glfwCreateWindow(width, height, title, nullptr, nullptr));
         glfwMakeContextCurrent(window.get());
         initialize_glew();
@@ -29,10 +31,19 @@ class Window {
 
     [[nodiscard]] bool should_close() const { return glfwWindowShouldClose(window.get()); }
 
-    void poll_events() { glfwPollEvents(); }
+    // Key events only describe the frame they arrived in
+    void poll_events() {
+        keysPressed.clear();
+        keysReleased.clear();
+        keysRepeated.clear();
+        glfwPollEvents();
+    }
 
     void swap_buffers() { glfwSwapBuffers(window.get()); }
 
+    // Off lets frames run as fast as they can, which is what timing them needs
+    void set_vsync(bool enabled) { glfwSwapInterval(enabled ? 1 : 0); }
+
     [[nodiscard]] int get_render_width() const { return renderWidth; }
 
     [[nodiscard]] int get_render_height() const { return renderHeight; }
@@ -41,6 +52,8 @@ class Window {
 
     [[nodiscard]] std::span<const int> released_keys() const { return keysReleased; }
 
+    [[nodiscard]] std::span<const int> repeated_keys() const { return keysRepeated; }
+
     [[nodiscard]] const Framebuffer& default_framebuffer() const { return defaultFramebuffer; }
 
   private:
@@ -53,12 +66,13 @@ class Window {
     int width;
     int height;
     std::unique_ptr<GLFWwindow, Deleter> window;
-    std::vector<int> keysPressed;
-    std::vector<int> keysReleased;
-    std::vector<int> keysRepeated;
+    std::pmr::vector<int> keysPressed{tracked_resource(MemorySubsystem::Input)};
+    std::pmr::vector<int> keysReleased{tracked_resource(MemorySubsystem::Input)};
+    std::pmr::vector<int> keysRepeated{tracked_resource(MemorySubsystem::Input)};
     Framebuffer defaultFramebuffer;
 
-    static void set_window_hints() {
+    static void set_window_hints(bool visible) {
+        glfwWindowHint(GLFW_VISIBLE, visible ? GLFW_TRUE : GLFW_FALSE);
         glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
         glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 5);
         glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GLFW_TRUE);
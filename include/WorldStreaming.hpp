@@ -0,0 +1,157 @@
+#pragma once
+#include "AssetArchive.hpp"
+#include "MeshLoading.hpp"
+#include "Rendering.hpp"
+#include "Scene.hpp"
+#include "ThreadPool.hpp"
+
+#include <cstdint>
+#include <expected>
+#include <functional>
+#include <future>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace tel {
+struct WorldStreamingOptions {
+    // Cells are squares on the XZ plane
+    float cellSize = 64.0f;
+    float loadRadius = 192.0f;
+    // Larger than loadRadius so a camera moving back and forth across the edge does not keep reloading the same cells
+    float unloadRadius = 256.0f;
+    // Bytes of mesh data allowed to be resident at once
+    std::size_t memoryBudget = std::size_t{512} << 20;
+    std::size_t uploadBudgetPerFrame = std::size_t{32} << 20;
+    unsigned int maxConcurrentLoads = 8;
+    // A cell straight behind the camera counts as this many times further away than one straight ahead
+    float behindPenalty = 3.0f;
+    // Streamed meshes get BVHs too, so raycast_scene can hit them, and their worst-case size counts against the budget
+    bool raycastable = false;
+};
+
+// A scene object whose mesh is only loaded while the cell it falls in is near the camera
+struct WorldObject {
+    Transform transform;
+    // Passed to the mesh loader; objects naming the same mesh share one copy of it
+    std::string mesh;
+    MustInit<ShaderHandle> shader;
+    std::optional<TextureHandle> texture{};
+};
+
+using CellCoordinate = glm::ivec2;
+
+enum class CellState { Unloaded, Loading, Resident };
+
+// Splits world content into cells and keeps only those around the camera loaded. Meshes are read and parsed on the
+// thread pool and uploaded a few per frame, nearest cells and cells in front of the camera first; cells are dropped
+// once the camera is far enough away, or earlier when more important cells need the memory.
+class WorldStreaming {
+  public:
+    // Called on worker threads
+    using LoadMesh = std::function<std::expected<Mesh, MeshLoadError>(std::string_view path)>;
+
+    WorldStreaming(Rendering* rendering, ThreadPool* threadPool, LoadMesh loadMesh,
+                   const WorldStreamingOptions& options = {});
+
+    WorldStreaming(const WorldStreaming&) = delete;
+
+    WorldStreaming& operator=(const WorldStreaming&) = delete;
+
+    ~WorldStreaming();
+
+    // Loads meshes from an archive, which must outlive the streaming
+    static LoadMesh archive_loader(const AssetArchive& archive, ThreadPool* threadPool = nullptr);
+
+    // Goes in the cell containing the object's origin
+    void add_object(WorldObject object);
+
+    // Starts and finishes loads for the scene's camera position and refills scene.streamedObjects when cells come or
+    // go. Call once per frame, before rendering.
+    void update(Scene& scene);
+
+    [[nodiscard]] CellCoordinate cell_at(const glm::vec3& position) const;
+
+    [[nodiscard]] CellState cell_state(CellCoordinate cell) const;
+
+    [[nodiscard]] std::size_t resident_bytes() const { return residentBytes; }
+
+    [[nodiscard]] std::size_t resident_cell_count() const;
+
+    [[nodiscard]] std::size_t loading_cell_count() const;
+
+  private:
+    struct Cell {
+        CellCoordinate coordinate;
+        std::vector<WorldObject> objects;
+        CellState state = CellState::Unloaded;
+        // What the cell's meshes took the last time it was resident, to guess whether loading it fits the budget
+        std::size_t lastBytes = 0;
+        // Distance to the camera, weighted against cells behind it; lower loads first and unloads last
+        float cost = 0.0f;
+    };
+
+    struct StreamedMesh {
+        std::future<std::expected<Mesh, MeshLoadError>> pending;
+        std::optional<MeshHandle> handle;
+        std::size_t bytes = 0;
+        unsigned int users = 0;
+        bool failed = false;
+
+        [[nodiscard]] bool done() const { return handle.has_value() || failed; }
+    };
+
+    Rendering* rendering;
+    ThreadPool* threadPool;
+    LoadMesh loadMesh;
+    WorldStreamingOptions options;
+    std::unordered_map<std::uint64_t, Cell> cells;
+    // Cells that are loading or resident
+    std::vector<std::uint64_t> activeCells;
+    std::map<std::string, StreamedMesh, std::less<>> meshes;
+    std::size_t residentBytes = 0;
+    // Meshes behind residentBytes, for the average size a mesh not yet loaded is guessed at
+    std::size_t loadedMeshCount = 0;
+    bool objectsChanged = false;
+    // Kept between frames so updates do not allocate
+    std::vector<Cell*> loadCandidates;
+    std::vector<const StreamedMesh*> cellMeshes;
+
+    static std::uint64_t key(CellCoordinate cell);
+
+    [[nodiscard]] float distance_to(const Cell& cell, glm::vec2 viewer) const;
+
+    void acquire_mesh(const std::string& path);
+
+    void begin_loading(Cell& cell);
+
+    void unload(Cell& cell);
+
+    void release_mesh(const std::string& path);
+
+    void upload_finished_meshes();
+
+    // Fills cellMeshes with the cell's meshes, each once
+    void collect_meshes(const Cell& cell);
+
+    [[nodiscard]] std::size_t loaded_bytes(const Cell& cell);
+
+    // What loading the cell would add; its last size if it has been resident before
+    [[nodiscard]] std::size_t estimated_bytes(const Cell& cell, std::size_t averageMeshBytes) const;
+
+    [[nodiscard]] const Cell* nearest_active_cell() const;
+
+    // Cells whose meshes have all arrived, or failed, become resident
+    void finish_loaded_cells();
+
+    // Unloads cells costlier than cost until bytes more fit in the budget
+    bool make_room(std::size_t bytes, float cost);
+
+    void refill(Scene& scene) const;
+};
+} // namespace tel
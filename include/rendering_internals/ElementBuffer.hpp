@@ -1,5 +1,9 @@
 #pragma once
+#include "GpuMemory.hpp"
+#include "Moving.hpp"
+
 #include <GL/glew.h>
+#include <cstddef>
 
 namespace tel {
 class ElementBuffer {
@@ -26,11 +30,17 @@ class ElementBuffer {
 
     [[nodiscard]] GLuint underlying() const { return ebo; }
 
+    // Records the storage given to the buffer, which is released along with it
+    void account(std::size_t bytes) { allocation = GpuAllocation(GpuMemoryCategory::MeshBuffers, bytes); }
+
+    [[nodiscard]] std::size_t size_in_bytes() const { return allocation.size(); }
+
   private:
     friend class Rendering;
 
     explicit ElementBuffer(GLuint ebo) : ebo(ebo) {}
 
     Moving<GLuint, 0, EngagedMoveAssignBehavior::Assert> ebo;
+    GpuAllocation allocation;
 };
 } // namespace tel
\ No newline at end of file
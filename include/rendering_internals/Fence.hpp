@@ -0,0 +1,44 @@
+#pragma once
+#include "Moving.hpp"
+
+#include <GL/glew.h>
+
+namespace tel {
+// Signalled once the GPU has finished every command issued before it
+class Fence {
+  public:
+    Fence() = default;
+
+    static Fence insert() { return Fence(glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0)); }
+
+    Fence(const Fence&) = delete;
+
+    Fence& operator=(const Fence&) = delete;
+
+    Fence(Fence&& other) noexcept = default;
+
+    Fence& operator=(Fence&& other) noexcept = default;
+
+    ~Fence() { glDeleteSync(fence); }
+
+    // Never blocks
+    [[nodiscard]] bool signalled() const {
+        const GLenum status = glClientWaitSync(fence, 0, 0);
+        return status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED;
+    }
+
+    // Flushes first, so the fence is sure to be reached
+    void wait() const {
+        constexpr GLuint64 timeout = 1'000'000'000;
+        GLenum status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, timeout);
+        while (status == GL_TIMEOUT_EXPIRED) {
+            status = glClientWaitSync(fence, 0, timeout);
+        }
+    }
+
+  private:
+    Moving<GLsync, nullptr, EngagedMoveAssignBehavior::Assert> fence;
+
+    explicit Fence(GLsync fence) : fence(fence) {}
+};
+} // namespace tel
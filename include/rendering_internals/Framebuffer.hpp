@@ -1,10 +1,12 @@
 #pragma once
 #include "Initializations.hpp"
 #include "Moving.hpp"
+#include "Texture.hpp"
 
 #include <GL/glew.h>
 #include <algorithm>
 #include <cassert>
+#include <span>
 
 namespace tel {
 struct FramebufferOptions {
@@ -16,7 +18,7 @@ class Framebuffer {
   public:
     static Framebuffer create(const FramebufferOptions& options) {
         GLuint fbo{};
-        glGenFramebuffers(1, &fbo);
+        glCreateFramebuffers(1, &fbo);
         return Framebuffer{fbo, options};
     }
 
@@ -39,6 +41,22 @@ class Framebuffer {
 
     [[nodiscard]] int height() const { return options.height; }
 
+    [[nodiscard]] bool is_default() const { return fbo.value() == 0; }
+
+    void attach(GLenum attachmentPoint, const Texture& texture) {
+        assert(!is_default());
+        glNamedFramebufferTexture(fbo, attachmentPoint, texture.underlying(), 0);
+    }
+
+    void set_draw_buffers(std::span<const GLenum> buffers) {
+        assert(!is_default());
+        glNamedFramebufferDrawBuffers(fbo, static_cast<GLsizei>(buffers.size()), buffers.data());
+    }
+
+    [[nodiscard]] bool is_complete() const {
+        return glCheckNamedFramebufferStatus(fbo, GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    }
+
   private:
     Moving<GLuint, 0, EngagedMoveAssignBehavior::Assert> fbo = 0;
     FramebufferOptions options;
@@ -1,15 +1,66 @@
 #pragma once
 
+#include "Animation.hpp"
 #include "ElementBuffer.hpp"
+#include "Mesh.hpp"
+#include "MeshResidency.hpp"
+#include "Meshlets.hpp"
+#include "RayCasting.hpp"
 #include "VertexArray.hpp"
 #include "VertexBuffer.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <memory>
 #include <tuple>
+#include <utility>
+#include <vector>
 
 namespace tel {
+// Where a mesh's buffers are uploaded again from once evicted; meshes with neither a copy nor a loader stay resident
+struct MeshSource {
+    std::shared_ptr<const Mesh> copy;
+    MeshLoader load;
+    // Skin weights are always kept in memory
+    std::shared_ptr<const SkinWeights> skin;
+
+    [[nodiscard]] bool can_reload() const { return copy || load; }
+};
+
 struct GPUMesh {
     ElementBuffer elementBuffer;
     ElementBuffer::Index numIndices = 0;
+    BoundingBox bounds{};
     VertexArray vertexArray;
-    std::tuple<VertexBuffer<glm::vec3>, VertexBuffer<glm::vec3>> attachments;
+    std::tuple<VertexBuffer<glm::vec3>, VertexBuffer<glm::vec3>, VertexBuffer<glm::vec2>> attachments;
+    // Built on the thread pool after the mesh is loaded, for ray queries; invalid unless it was loaded raycastable
+    std::shared_future<std::shared_ptr<const MeshBvh>> bvh;
+    // Only created for skinned meshes
+    VertexBuffer<JointIndices> skinJoints;
+    VertexBuffer<JointWeights> skinWeights;
+    MeshSource source;
+    // Whether the buffers above hold the mesh. Evicted meshes keep their bounds and BVH, so culling and ray queries
+    // carry on as before.
+    bool resident = true;
+    std::uint64_t lastDrawnFrame = 0;
+    // Empty for meshes drawn whole. Kept while evicted, so culling carries on like it does for the bounds.
+    std::vector<Meshlet> meshlets;
+    // A reload by source.load still running
+    std::future<std::expected<Mesh, MeshLoadError>> reloading;
+
+    [[nodiscard]] std::size_t size_in_bytes() const {
+        const auto& [positions, normals, texCoords] = attachments;
+        return elementBuffer.size_in_bytes() + positions.size_in_bytes() + normals.size_in_bytes() +
+               texCoords.size_in_bytes() + skinJoints.size_in_bytes() + skinWeights.size_in_bytes();
+    }
+
+    // Deletes every GL object, leaving the rest to upload from again
+    void release_buffers() {
+        std::exchange(elementBuffer, ElementBuffer{});
+        std::exchange(vertexArray, VertexArray{});
+        std::exchange(attachments, {});
+        std::exchange(skinJoints, VertexBuffer<JointIndices>{});
+        std::exchange(skinWeights, VertexBuffer<JointWeights>{});
+    }
 };
-} // namespace tel
\ No newline at end of file
+} // namespace tel
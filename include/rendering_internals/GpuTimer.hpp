@@ -0,0 +1,85 @@
+#pragma once
+#include <GL/glew.h>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+namespace tel {
+// Measures how long the GPU spends on a span of commands with a pair of timestamp queries. Each frame uses its own pair
+// from a small ring and results are read back frames later, once they are ready, so timing never stalls the CPU on the
+// GPU; only when the ring wraps onto a query that is still unfinished does begin() have to wait for it. Unlike
+// GL_TIME_ELAPSED queries, timestamps may overlap, so timers can run inside one another.
+class GpuTimer {
+  public:
+    static constexpr std::size_t latency = 4;
+
+    GpuTimer() { glCreateQueries(GL_TIMESTAMP, static_cast<GLsizei>(queries.size()), queries.data()); }
+
+    GpuTimer(const GpuTimer&) = delete;
+
+    GpuTimer& operator=(const GpuTimer&) = delete;
+
+    ~GpuTimer() { glDeleteQueries(static_cast<GLsizei>(queries.size()), queries.data()); }
+
+    // Func is called as func(frame, milliseconds) for any result that has to be read to free the query
+    template <typename Func>
+    void begin(std::size_t frame, Func&& func) {
+        assert(!running);
+        const std::size_t slot = frame % latency;
+        if (slots[slot].pending) {
+            read(slots[slot], &queries[2 * slot], true, func);
+        }
+        slots[slot] = {.frame = frame, .pending = true};
+        glQueryCounter(queries[2 * slot], GL_TIMESTAMP);
+        runningSlot = slot;
+        running = true;
+    }
+
+    void end() {
+        assert(running);
+        glQueryCounter(queries[2 * runningSlot + 1], GL_TIMESTAMP);
+        running = false;
+    }
+
+    // Calls func(frame, milliseconds) for every measurement that has finished, or for all of them if wait is set
+    template <typename Func>
+    void collect(Func&& func, bool wait = false) {
+        for (std::size_t slot = 0; slot < latency; ++slot) {
+            if (slots[slot].pending) {
+                read(slots[slot], &queries[2 * slot], wait, func);
+            }
+        }
+    }
+
+  private:
+    struct Slot {
+        std::size_t frame = 0;
+        bool pending = false;
+    };
+
+    // Start and end timestamps of each slot
+    std::array<GLuint, 2 * latency> queries{};
+    std::array<Slot, latency> slots{};
+    std::size_t runningSlot = 0;
+    bool running = false;
+
+    // Commands complete in order, so once the end timestamp is available the start one is too
+    template <typename Func>
+    static void read(Slot& slot, const GLuint* pair, bool wait, Func& func) {
+        if (!wait) {
+            GLint available = GL_FALSE;
+            glGetQueryObjectiv(pair[1], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (available == GL_FALSE) {
+                return;
+            }
+        }
+        GLuint64 start = 0;
+        GLuint64 end = 0;
+        glGetQueryObjectui64v(pair[0], GL_QUERY_RESULT, &start);
+        glGetQueryObjectui64v(pair[1], GL_QUERY_RESULT, &end);
+        slot.pending = false;
+        func(slot.frame, static_cast<double>(end - start) / 1e6);
+    }
+};
+} // namespace tel
@@ -0,0 +1,54 @@
+#pragma once
+#include "GpuMemory.hpp"
+#include "Moving.hpp"
+
+#include <GL/glew.h>
+#include <cstddef>
+#include <span>
+
+namespace tel {
+// Per-instance vertex data rewritten every frame. Mapping orphans the previous contents, so draws still reading them
+// are never waited on, and the new storage is written in place rather than copied in from a staging array.
+class InstanceBuffer {
+  public:
+    InstanceBuffer() = default;
+
+    static InstanceBuffer create() {
+        GLuint buffer{};
+        glCreateBuffers(1, &buffer);
+        return InstanceBuffer(buffer);
+    }
+
+    InstanceBuffer(const InstanceBuffer&) = delete;
+
+    InstanceBuffer& operator=(const InstanceBuffer&) = delete;
+
+    InstanceBuffer(InstanceBuffer&& other) noexcept = default;
+
+    InstanceBuffer& operator=(InstanceBuffer&& other) noexcept = default;
+
+    ~InstanceBuffer() { glDeleteBuffers(1, &buffer.value()); }
+
+    [[nodiscard]] GLuint underlying() const { return buffer; }
+
+    // Valid until unmap(), which has to come before any draw reads the buffer
+    template <typename T>
+    [[nodiscard]] std::span<T> map(std::size_t count) {
+        const auto bytes = static_cast<GLsizeiptr>(count * sizeof(T));
+        glNamedBufferData(buffer, bytes, nullptr, GL_STREAM_DRAW);
+        if (allocation.size() != static_cast<std::size_t>(bytes)) {
+            allocation = GpuAllocation(GpuMemoryCategory::StreamingBuffers, static_cast<std::size_t>(bytes));
+        }
+        void* mapped = glMapNamedBufferRange(buffer, 0, bytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+        return std::span(static_cast<T*>(mapped), count);
+    }
+
+    void unmap() { glUnmapNamedBuffer(buffer); }
+
+  private:
+    explicit InstanceBuffer(GLuint buffer) : buffer(buffer) {}
+
+    Moving<GLuint, 0, EngagedMoveAssignBehavior::Assert> buffer;
+    GpuAllocation allocation;
+};
+} // namespace tel
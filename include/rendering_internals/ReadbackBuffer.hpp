@@ -0,0 +1,55 @@
+#pragma once
+#include "GpuMemory.hpp"
+#include "Moving.hpp"
+
+#include <GL/glew.h>
+#include <cstddef>
+#include <span>
+
+namespace tel {
+// A persistently mapped pixel pack buffer for the GPU to copy into and the CPU to read from. Client storage keeps it
+// in system memory, where the CPU reads it fastest.
+class ReadbackBuffer {
+  public:
+    ReadbackBuffer() = default;
+
+    static ReadbackBuffer create(std::size_t capacity) {
+        constexpr GLbitfield flags = GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        GLuint buffer{};
+        glCreateBuffers(1, &buffer);
+        glNamedBufferStorage(buffer, static_cast<GLsizeiptr>(capacity), nullptr, flags | GL_CLIENT_STORAGE_BIT);
+        auto* mapped =
+            static_cast<std::byte*>(glMapNamedBufferRange(buffer, 0, static_cast<GLsizeiptr>(capacity), flags));
+        return ReadbackBuffer(buffer, std::span(mapped, capacity));
+    }
+
+    ReadbackBuffer(const ReadbackBuffer&) = delete;
+
+    ReadbackBuffer& operator=(const ReadbackBuffer&) = delete;
+
+    ReadbackBuffer(ReadbackBuffer&& other) noexcept = default;
+
+    ReadbackBuffer& operator=(ReadbackBuffer&& other) noexcept = default;
+
+    ~ReadbackBuffer() {
+        if (buffer.value() != 0) {
+            glUnmapNamedBuffer(buffer);
+        }
+        glDeleteBuffers(1, &buffer.value());
+    }
+
+    [[nodiscard]] GLuint underlying() const { return buffer; }
+
+    [[nodiscard]] std::span<const std::byte> mapped() const { return memory; }
+
+    [[nodiscard]] std::size_t capacity() const { return memory.size(); }
+
+  private:
+    Moving<GLuint, 0, EngagedMoveAssignBehavior::Assert> buffer;
+    std::span<std::byte> memory;
+    GpuAllocation allocation;
+
+    ReadbackBuffer(GLuint buffer, std::span<std::byte> memory)
+        : buffer(buffer), memory(memory), allocation(GpuMemoryCategory::StreamingBuffers, memory.size()) {}
+};
+} // namespace tel
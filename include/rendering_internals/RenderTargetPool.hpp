@@ -0,0 +1,138 @@
+#pragma once
+#include "Framebuffer.hpp"
+#include "Texture.hpp"
+
+#include <GL/glew.h>
+#include <algorithm>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <ranges>
+#include <span>
+#include <vector>
+
+namespace tel {
+struct RenderTargetOptions {
+    int width = 0;
+    int height = 0;
+    GLenum internalFormat = GL_RGBA8;
+
+    bool operator==(const RenderTargetOptions&) const = default;
+};
+
+[[nodiscard]] constexpr bool is_depth_format(GLenum internalFormat) {
+    switch (internalFormat) {
+    case GL_DEPTH_COMPONENT16:
+    case GL_DEPTH_COMPONENT24:
+    case GL_DEPTH_COMPONENT32:
+    case GL_DEPTH_COMPONENT32F:
+    case GL_DEPTH24_STENCIL8:
+    case GL_DEPTH32F_STENCIL8:
+        return true;
+    default:
+        return false;
+    }
+}
+
+[[nodiscard]] constexpr bool has_stencil(GLenum internalFormat) {
+    return internalFormat == GL_DEPTH24_STENCIL8 || internalFormat == GL_DEPTH32F_STENCIL8;
+}
+
+// Owns the textures behind transient render targets. A released texture goes back to the pool and is handed to the
+// next acquire with the same options, so targets whose lifetimes do not overlap share storage. Textures that go
+// unused for a while are destroyed along with the framebuffers built on them.
+class RenderTargetPool {
+  public:
+    explicit RenderTargetPool(std::uint64_t maxIdleFrames = 3) : maxIdleFrames(maxIdleFrames) {}
+
+    const Texture* acquire(const RenderTargetOptions& options) {
+        auto iter = std::ranges::find_if(
+            targets, [&](const Target& target) { return !target.inUse && target.options == options; });
+        if (iter == targets.end()) {
+            Texture texture = Texture::create(TextureOptions{.width = options.width,
+                                                             .height = options.height,
+                                                             .internalFormat = options.internalFormat,
+                                                             .memoryCategory = GpuMemoryCategory::RenderTargets});
+            glTextureParameteri(texture.underlying(), GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTextureParameteri(texture.underlying(), GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+            targets.emplace_back(options, std::move(texture));
+            iter = std::prev(targets.end());
+        }
+        iter->inUse = true;
+        iter->lastUsedFrame = frame;
+        return &iter->texture;
+    }
+
+    void release(const Texture* texture) {
+        auto iter = std::ranges::find(targets, texture, [](const Target& target) { return &target.texture; });
+        assert(iter != targets.end());
+        iter->inUse = false;
+    }
+
+    // Color attachments are bound in the order given; depth formats go to the depth attachment point
+    const Framebuffer& framebuffer(std::span<const Texture* const> attachments) {
+        assert(!attachments.empty());
+        key.clear();
+        key.append_range(attachments | std::views::transform(&Texture::underlying));
+        if (auto iter = framebuffers.find(key); iter != framebuffers.end()) {
+            return iter->second;
+        }
+        Framebuffer framebuffer = Framebuffer::create(
+            FramebufferOptions{.width = attachments.front()->width(), .height = attachments.front()->height()});
+        std::vector<GLenum> drawBuffers;
+        for (const Texture* attachment : attachments) {
+            const GLenum format = attachment->internal_format();
+            if (is_depth_format(format)) {
+                framebuffer.attach(has_stencil(format) ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT,
+                                   *attachment);
+                continue;
+            }
+            const GLenum attachmentPoint = GL_COLOR_ATTACHMENT0 + static_cast<GLenum>(drawBuffers.size());
+            framebuffer.attach(attachmentPoint, *attachment);
+            drawBuffers.emplace_back(attachmentPoint);
+        }
+        framebuffer.set_draw_buffers(drawBuffers);
+        assert(framebuffer.is_complete());
+        return framebuffers.emplace(key, std::move(framebuffer)).first->second;
+    }
+
+    void end_frame() {
+        ++frame;
+        for (auto iter = targets.begin(); iter != targets.end();) {
+            if (iter->inUse || iter->lastUsedFrame + maxIdleFrames >= frame) {
+                ++iter;
+                continue;
+            }
+            std::erase_if(framebuffers, [&](const auto& entry) {
+                return std::ranges::contains(entry.first, iter->texture.underlying());
+            });
+            iter = targets.erase(iter);
+        }
+    }
+
+    [[nodiscard]] std::size_t size_in_bytes() const {
+        std::size_t total = 0;
+        for (const Target& target : targets) {
+            total += target.texture.size_in_bytes();
+        }
+        return total;
+    }
+
+    [[nodiscard]] std::size_t target_count() const { return targets.size(); }
+
+  private:
+    struct Target {
+        RenderTargetOptions options;
+        Texture texture;
+        bool inUse = false;
+        std::uint64_t lastUsedFrame = 0;
+    };
+
+    std::uint64_t maxIdleFrames;
+    std::uint64_t frame = 0;
+    // A list keeps texture addresses stable for the passes holding them
+    std::list<Target> targets;
+    std::map<std::vector<GLuint>, Framebuffer> framebuffers;
+    std::vector<GLuint> key;
+};
+} // namespace tel
@@ -0,0 +1,15 @@
+#pragma once
+#include "AssetArchive.hpp"
+#include "EmbeddedAssets.hpp"
+#include "Shader.hpp"
+
+#include <expected>
+#include <string>
+#include <string_view>
+
+namespace tel {
+// Replaces each #include "name" line with shaders/name from the archive, recursively, since GLSL has no includes of
+// its own. A #line directive after each included file keeps compile errors pointing at the right line.
+std::expected<std::string, ShaderCompilationError>
+resolve_shader_includes(std::string_view code, const AssetArchive& assets = embedded_assets());
+} // namespace tel
@@ -0,0 +1,49 @@
+#pragma once
+#include "GpuMemory.hpp"
+#include "Moving.hpp"
+
+#include <GL/glew.h>
+#include <cstddef>
+#include <span>
+
+namespace tel {
+// A buffer rewritten from the CPU every frame for shaders to read. Each upload orphans the previous contents, so the
+// driver hands out fresh memory rather than waiting for draws that still read last frame's data.
+class ShaderStorageBuffer {
+  public:
+    ShaderStorageBuffer() = default;
+
+    static ShaderStorageBuffer create() {
+        GLuint buffer{};
+        glCreateBuffers(1, &buffer);
+        return ShaderStorageBuffer(buffer);
+    }
+
+    ShaderStorageBuffer(const ShaderStorageBuffer&) = delete;
+
+    ShaderStorageBuffer& operator=(const ShaderStorageBuffer&) = delete;
+
+    ShaderStorageBuffer(ShaderStorageBuffer&& other) noexcept = default;
+
+    ShaderStorageBuffer& operator=(ShaderStorageBuffer&& other) noexcept = default;
+
+    ~ShaderStorageBuffer() { glDeleteBuffers(1, &buffer.value()); }
+
+    [[nodiscard]] GLuint underlying() const { return buffer; }
+
+    void upload(std::span<const std::byte> data) {
+        glNamedBufferData(buffer, static_cast<GLsizeiptr>(data.size()), data.data(), GL_STREAM_DRAW);
+        if (allocation.size() != data.size()) {
+            allocation = GpuAllocation(GpuMemoryCategory::StreamingBuffers, data.size());
+        }
+    }
+
+    void bind(GLuint binding) const { glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, buffer); }
+
+  private:
+    explicit ShaderStorageBuffer(GLuint buffer) : buffer(buffer) {}
+
+    Moving<GLuint, 0, EngagedMoveAssignBehavior::Assert> buffer;
+    GpuAllocation allocation;
+};
+} // namespace tel
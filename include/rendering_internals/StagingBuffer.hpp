@@ -0,0 +1,128 @@
+#pragma once
+#include "GpuMemory.hpp"
+#include "Moving.hpp"
+
+#include <GL/glew.h>
+#include <cstddef>
+#include <deque>
+#include <optional>
+#include <span>
+
+namespace tel {
+// A persistently mapped buffer used as a ring of upload space. Regions handed out by allocate() stay reserved until
+// the GPU has passed the fence inserted after the commands that read them, so the CPU never writes into memory a
+// pending transfer is still sourcing from and never has to wait on the driver to do so.
+class StagingBuffer {
+  public:
+    struct Region {
+        std::size_t offset;
+        std::span<std::byte> memory;
+    };
+
+    StagingBuffer() = default;
+
+    static StagingBuffer create(std::size_t capacity) {
+        constexpr GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        GLuint buffer{};
+        glCreateBuffers(1, &buffer);
+        glNamedBufferStorage(buffer, static_cast<GLsizeiptr>(capacity), nullptr, flags);
+        auto* mapped =
+            static_cast<std::byte*>(glMapNamedBufferRange(buffer, 0, static_cast<GLsizeiptr>(capacity), flags));
+        return StagingBuffer(buffer, std::span(mapped, capacity));
+    }
+
+    StagingBuffer(const StagingBuffer&) = delete;
+
+    StagingBuffer& operator=(const StagingBuffer&) = delete;
+
+    StagingBuffer(StagingBuffer&& other) noexcept = default;
+
+    StagingBuffer& operator=(StagingBuffer&& other) noexcept = default;
+
+    ~StagingBuffer() {
+        for (const auto& segment : inFlight) {
+            glDeleteSync(segment.fence);
+        }
+        if (buffer.value() != 0) {
+            glUnmapNamedBuffer(buffer);
+        }
+        glDeleteBuffers(1, &buffer.value());
+    }
+
+    [[nodiscard]] GLuint underlying() const { return buffer; }
+
+    [[nodiscard]] std::size_t capacity() const { return mapped.size(); }
+
+    // Returns nullopt when the ring has no room left until earlier transfers complete
+    [[nodiscard]] std::optional<Region> allocate(std::size_t size, std::size_t alignment = 4) {
+        if (size == 0 || size >= capacity()) {
+            return std::nullopt;
+        }
+        const auto oldest = oldest_reserved();
+        std::size_t offset = oldest ? align(head, alignment) : 0;
+        if (oldest && head >= *oldest) {
+            if (offset + size > capacity()) {
+                offset = 0;
+                if (size >= *oldest) {
+                    return std::nullopt;
+                }
+            }
+        } else if (oldest && offset + size >= *oldest) {
+            return std::nullopt;
+        }
+        if (!openSegmentBegin) {
+            openSegmentBegin = offset;
+        }
+        head = offset + size;
+        return Region{.offset = offset, .memory = mapped.subspan(offset, size)};
+    }
+
+    // Marks everything allocated since the last fence as in use by the GL commands issued so far
+    void fence() {
+        if (!openSegmentBegin) {
+            return;
+        }
+        inFlight.emplace_back(*openSegmentBegin, glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+        openSegmentBegin.reset();
+    }
+
+    // Releases the regions whose transfers the GPU has finished; never blocks
+    void retire() {
+        while (!inFlight.empty()) {
+            const GLenum status = glClientWaitSync(inFlight.front().fence, 0, 0);
+            if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+                return;
+            }
+            glDeleteSync(inFlight.front().fence);
+            inFlight.pop_front();
+        }
+    }
+
+  private:
+    struct Segment {
+        std::size_t begin;
+        GLsync fence;
+    };
+
+    Moving<GLuint, 0, EngagedMoveAssignBehavior::Assert> buffer;
+    std::span<std::byte> mapped;
+    GpuAllocation allocation;
+    std::size_t head = 0;
+    std::optional<std::size_t> openSegmentBegin;
+    std::deque<Segment> inFlight;
+
+    StagingBuffer(GLuint buffer, std::span<std::byte> mapped)
+        : buffer(buffer), mapped(mapped), allocation(GpuMemoryCategory::StreamingBuffers, mapped.size()) {}
+
+    [[nodiscard]] std::optional<std::size_t> oldest_reserved() const {
+        if (!inFlight.empty()) {
+            return inFlight.front().begin;
+        }
+        return openSegmentBegin;
+    }
+
+    static constexpr std::size_t align(std::size_t offset, std::size_t alignment) {
+        return (offset + alignment - 1) / alignment * alignment;
+    }
+};
+} // namespace tel
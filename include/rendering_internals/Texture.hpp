@@ -0,0 +1,129 @@
+#pragma once
+#include "GpuMemory.hpp"
+#include "Image.hpp"
+#include "Initializations.hpp"
+#include "Moving.hpp"
+
+#include <GL/glew.h>
+#include <cstddef>
+#include <utility>
+
+namespace tel {
+enum class TextureType { Texture2D, Texture2DArray };
+
+struct TextureOptions {
+    MustInit<int> width;
+    MustInit<int> height;
+    int levels = 1;
+    int layers = 1;
+    TextureType type = TextureType::Texture2D;
+    GLenum internalFormat = GL_RGBA8;
+    GpuMemoryCategory memoryCategory = GpuMemoryCategory::Textures;
+};
+
+[[nodiscard]] constexpr std::size_t bytes_per_texel(GLenum internalFormat) {
+    switch (internalFormat) {
+    case GL_R8:
+        return 1;
+    case GL_RG8:
+    case GL_DEPTH_COMPONENT16:
+        return 2;
+    case GL_RGB8:
+        return 3;
+    case GL_RGBA16F:
+    case GL_DEPTH32F_STENCIL8:
+        return 8;
+    case GL_RGBA32F:
+        return 16;
+    default:
+        // RGBA8, and 24-bit depth, which drivers pad to 32 bits
+        return 4;
+    }
+}
+
+[[nodiscard]] constexpr std::size_t texture_size_in_bytes(int width, int height, int levels, int layers,
+                                                          GLenum internalFormat) {
+    std::size_t total = 0;
+    for (int level = 0; level < levels; ++level) {
+        total += static_cast<std::size_t>(mip_dimension(width, level)) * mip_dimension(height, level);
+    }
+    return total * layers * bytes_per_texel(internalFormat);
+}
+
+class Texture {
+  public:
+    Texture() = default;
+
+    // Allocates immutable storage for every level and layer up front
+    static Texture create(const TextureOptions& options) {
+        GLuint texture{};
+        const GLenum target = gl_target(options.type);
+        glCreateTextures(target, 1, &texture);
+        if (options.type == TextureType::Texture2DArray) {
+            glTextureStorage3D(texture, options.levels, options.internalFormat, options.width, options.height,
+                               options.layers);
+        } else {
+            glTextureStorage2D(texture, options.levels, options.internalFormat, options.width, options.height);
+        }
+        glTextureParameteri(texture, GL_TEXTURE_MIN_FILTER, options.levels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+        glTextureParameteri(texture, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTextureParameteri(texture, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTextureParameteri(texture, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        return Texture(texture, options);
+    }
+
+    Texture(const Texture&) = delete;
+
+    Texture& operator=(const Texture&) = delete;
+
+    Texture(Texture&& other) noexcept = default;
+
+    Texture& operator=(Texture&& other) noexcept = default;
+
+    ~Texture() { glDeleteTextures(1, &texture.value()); }
+
+    [[nodiscard]] GLuint underlying() const { return texture; }
+
+    [[nodiscard]] GLenum target() const { return gl_target(type); }
+
+    [[nodiscard]] int width() const { return textureWidth; }
+
+    [[nodiscard]] int height() const { return textureHeight; }
+
+    [[nodiscard]] int levels() const { return textureLevels; }
+
+    [[nodiscard]] int layers() const { return textureLayers; }
+
+    [[nodiscard]] GLenum internal_format() const { return internalFormat; }
+
+    [[nodiscard]] std::size_t size_in_bytes() const {
+        return texture_size_in_bytes(textureWidth, textureHeight, textureLevels, textureLayers, internalFormat);
+    }
+
+  private:
+    Moving<GLuint, 0, EngagedMoveAssignBehavior::Assert> texture;
+    TextureType type = TextureType::Texture2D;
+    int textureWidth = 0;
+    int textureHeight = 0;
+    int textureLevels = 0;
+    int textureLayers = 0;
+    GLenum internalFormat = GL_RGBA8;
+    GpuAllocation allocation;
+
+    Texture(GLuint texture, const TextureOptions& options)
+        : texture(texture), type(options.type), textureWidth(options.width), textureHeight(options.height),
+          textureLevels(options.levels), textureLayers(options.layers), internalFormat(options.internalFormat),
+          allocation(options.memoryCategory, size_in_bytes()) {}
+
+    static constexpr GLenum gl_target(TextureType type) {
+        switch (type) {
+        case TextureType::Texture2D:
+            return GL_TEXTURE_2D;
+        case TextureType::Texture2DArray:
+            return GL_TEXTURE_2D_ARRAY;
+        default:
+            std::unreachable();
+        }
+    }
+};
+} // namespace tel
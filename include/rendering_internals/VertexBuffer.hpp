@@ -1,7 +1,10 @@
 #pragma once
 
+#include "GpuMemory.hpp"
 #include "Moving.hpp"
 
+#include <cstddef>
+
 namespace tel {
 template <typename DataType>
 class VertexBuffer {
@@ -28,9 +31,15 @@ class VertexBuffer {
 
     [[nodiscard]] GLuint underlying() const { return vbo; }
 
+    // Records the storage given to the buffer, which is released along with it
+    void account(std::size_t bytes) { allocation = GpuAllocation(GpuMemoryCategory::MeshBuffers, bytes); }
+
+    [[nodiscard]] std::size_t size_in_bytes() const { return allocation.size(); }
+
   private:
     explicit VertexBuffer(GLuint vbo) : vbo(vbo) {}
 
     Moving<GLuint, 0, EngagedMoveAssignBehavior::Assert> vbo;
+    GpuAllocation allocation;
 };
 } // namespace tel
\ No newline at end of file
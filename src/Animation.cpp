@@ -0,0 +1,352 @@
+#include "Animation.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <ranges>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define HAZOR_ANIMATION_AVX2 1
+#include <immintrin.h>
+#else
+#define HAZOR_ANIMATION_AVX2 0
+#endif
+
+namespace {
+constexpr std::size_t lanes = 8;
+
+constexpr std::size_t translationComponent = 0;
+constexpr std::size_t rotationComponent = 3;
+constexpr std::size_t scaleComponent = 7;
+// Translation and scale, which blend linearly
+constexpr std::array<std::size_t, 6> linearComponents = {0, 1, 2, 7, 8, 9};
+
+// Instances per task; posing one skeleton is a few microseconds of work
+constexpr std::size_t instancesPerTask = 32;
+
+constexpr std::size_t padded_stride(std::size_t jointCount) { return (jointCount + lanes - 1) / lanes * lanes; }
+
+bool cpu_supports_avx2() {
+#if HAZOR_ANIMATION_AVX2
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#else
+    return false;
+#endif
+}
+
+// Padding joints get the identity, so normalizing them never divides by zero
+void write_joint(float* sample, std::size_t stride, std::size_t joint, const tel::JointTransform& transform) {
+    const float values[tel::jointComponentCount] = {
+        transform.translation.x, transform.translation.y, transform.translation.z, transform.rotation.x,
+        transform.rotation.y,    transform.rotation.z,    transform.rotation.w,    transform.scale.x,
+        transform.scale.y,       transform.scale.z};
+    for (std::size_t component = 0; component < tel::jointComponentCount; ++component) {
+        sample[component * stride + joint] = values[component];
+    }
+}
+
+void write_pose(float* sample, std::size_t stride, std::span<const tel::JointTransform> joints) {
+    for (std::size_t joint = 0; joint < stride; ++joint) {
+        write_joint(sample, stride, joint, joint < joints.size() ? joints[joint] : tel::JointTransform{});
+    }
+}
+
+template <typename T, typename Interpolate>
+T sample_keys(const std::vector<tel::Keyframe<T>>& keys, float time, const T& rest, Interpolate interpolate) {
+    if (keys.empty()) {
+        return rest;
+    }
+    const auto next = std::ranges::upper_bound(keys, time, {}, &tel::Keyframe<T>::time);
+    if (next == keys.begin()) {
+        return keys.front().value;
+    }
+    if (next == keys.end()) {
+        return keys.back().value;
+    }
+    const auto& previous = *std::prev(next);
+    const float interval = next->time - previous.time;
+    return interpolate(previous.value, next->value, interval > 0.0f ? (time - previous.time) / interval : 0.0f);
+}
+
+// pose += weight * normalize(mix(from, to, alpha)) for every joint, where rotations are mixed along the shorter arc
+// and each is flipped into the hemisphere of what has been accumulated so far, so layers never cancel each other out
+void blend_scalar(float* pose, const float* from, const float* to, float alpha, float weight, std::size_t stride) {
+    for (const std::size_t component : linearComponents) {
+        const std::size_t offset = component * stride;
+        for (std::size_t joint = 0; joint < stride; ++joint) {
+            const float value = from[offset + joint] + (to[offset + joint] - from[offset + joint]) * alpha;
+            pose[offset + joint] += weight * value;
+        }
+    }
+    for (std::size_t joint = 0; joint < stride; ++joint) {
+        float a[4];
+        float b[4];
+        float accumulated = 0.0f;
+        float cosine = 0.0f;
+        for (std::size_t i = 0; i < 4; ++i) {
+            const std::size_t index = (rotationComponent + i) * stride + joint;
+            a[i] = from[index];
+            b[i] = to[index];
+            cosine += a[i] * b[i];
+        }
+        const float toWeight = cosine < 0.0f ? -alpha : alpha;
+        float mixed[4];
+        float lengthSquared = 0.0f;
+        for (std::size_t i = 0; i < 4; ++i) {
+            mixed[i] = a[i] * (1.0f - alpha) + b[i] * toWeight;
+            lengthSquared += mixed[i] * mixed[i];
+            accumulated += mixed[i] * pose[(rotationComponent + i) * stride + joint];
+        }
+        const float scale = (accumulated < 0.0f ? -weight : weight) / std::sqrt(lengthSquared);
+        for (std::size_t i = 0; i < 4; ++i) {
+            pose[(rotationComponent + i) * stride + joint] += mixed[i] * scale;
+        }
+    }
+}
+
+#if HAZOR_ANIMATION_AVX2
+__attribute__((target("avx2,fma"))) __m256 flip_sign(__m256 value, __m256 condition) {
+    return _mm256_xor_ps(value, _mm256_and_ps(condition, _mm256_set1_ps(-0.0f)));
+}
+
+__attribute__((target("avx2,fma"))) void blend_avx2(float* pose, const float* from, const float* to, float alpha,
+                                                     float weight, std::size_t stride) {
+    const __m256 alphas = _mm256_set1_ps(alpha);
+    const __m256 inverseAlphas = _mm256_set1_ps(1.0f - alpha);
+    const __m256 weights = _mm256_set1_ps(weight);
+    const __m256 zero = _mm256_setzero_ps();
+    for (const std::size_t component : linearComponents) {
+        const std::size_t offset = component * stride;
+        for (std::size_t joint = 0; joint < stride; joint += lanes) {
+            const __m256 a = _mm256_loadu_ps(from + offset + joint);
+            const __m256 b = _mm256_loadu_ps(to + offset + joint);
+            const __m256 value = _mm256_fmadd_ps(_mm256_sub_ps(b, a), alphas, a);
+            _mm256_storeu_ps(pose + offset + joint,
+                             _mm256_fmadd_ps(weights, value, _mm256_loadu_ps(pose + offset + joint)));
+        }
+    }
+    for (std::size_t joint = 0; joint < stride; joint += lanes) {
+        __m256 a[4];
+        __m256 b[4];
+        __m256 accumulated[4];
+        __m256 cosine = zero;
+        for (std::size_t i = 0; i < 4; ++i) {
+            const std::size_t index = (rotationComponent + i) * stride + joint;
+            a[i] = _mm256_loadu_ps(from + index);
+            b[i] = _mm256_loadu_ps(to + index);
+            accumulated[i] = _mm256_loadu_ps(pose + index);
+            cosine = _mm256_fmadd_ps(a[i], b[i], cosine);
+        }
+        const __m256 toWeights = flip_sign(alphas, _mm256_cmp_ps(cosine, zero, _CMP_LT_OQ));
+        __m256 mixed[4];
+        __m256 lengthSquared = zero;
+        __m256 alignment = zero;
+        for (std::size_t i = 0; i < 4; ++i) {
+            mixed[i] = _mm256_fmadd_ps(b[i], toWeights, _mm256_mul_ps(a[i], inverseAlphas));
+            lengthSquared = _mm256_fmadd_ps(mixed[i], mixed[i], lengthSquared);
+            alignment = _mm256_fmadd_ps(mixed[i], accumulated[i], alignment);
+        }
+        const __m256 scale = _mm256_div_ps(flip_sign(weights, _mm256_cmp_ps(alignment, zero, _CMP_LT_OQ)),
+                                           _mm256_sqrt_ps(lengthSquared));
+        for (std::size_t i = 0; i < 4; ++i) {
+            _mm256_storeu_ps(pose + (rotationComponent + i) * stride + joint,
+                             _mm256_fmadd_ps(mixed[i], scale, accumulated[i]));
+        }
+    }
+}
+#endif
+
+void blend(float* pose, const float* from, const float* to, float alpha, float weight, std::size_t stride,
+           bool useAvx2) {
+#if HAZOR_ANIMATION_AVX2
+    if (useAvx2) {
+        blend_avx2(pose, from, to, alpha, weight, stride);
+        return;
+    }
+#endif
+    blend_scalar(pose, from, to, alpha, weight, stride);
+}
+
+// Divides out the total weight and brings the accumulated rotations back to unit length
+void normalize_pose(float* pose, float totalWeight, std::size_t stride) {
+    const float inverseWeight = 1.0f / totalWeight;
+    for (const std::size_t component : linearComponents) {
+        for (std::size_t joint = 0; joint < stride; ++joint) {
+            pose[component * stride + joint] *= inverseWeight;
+        }
+    }
+    float* x = pose + rotationComponent * stride;
+    float* y = x + stride;
+    float* z = y + stride;
+    float* w = z + stride;
+    for (std::size_t joint = 0; joint < stride; ++joint) {
+        const float length = std::sqrt(x[joint] * x[joint] + y[joint] * y[joint] + z[joint] * z[joint] +
+                                       w[joint] * w[joint]);
+        // Opposite rotations of equal weight cancel out completely; fall back to no rotation
+        if (length < 1e-6f) {
+            x[joint] = y[joint] = z[joint] = 0.0f;
+            w[joint] = 1.0f;
+            continue;
+        }
+        const float inverseLength = 1.0f / length;
+        x[joint] *= inverseLength;
+        y[joint] *= inverseLength;
+        z[joint] *= inverseLength;
+        w[joint] *= inverseLength;
+    }
+}
+
+glm::mat4 local_matrix(const float* pose, std::size_t stride, std::size_t joint) {
+    const auto at = [&](std::size_t component) { return pose[component * stride + joint]; };
+    const float x = at(rotationComponent);
+    const float y = at(rotationComponent + 1);
+    const float z = at(rotationComponent + 2);
+    const float w = at(rotationComponent + 3);
+    const float sx = at(scaleComponent);
+    const float sy = at(scaleComponent + 1);
+    const float sz = at(scaleComponent + 2);
+    glm::mat4 matrix;
+    matrix[0] = glm::vec4(1.0f - 2.0f * (y * y + z * z), 2.0f * (x * y + w * z), 2.0f * (x * z - w * y), 0.0f) * sx;
+    matrix[1] = glm::vec4(2.0f * (x * y - w * z), 1.0f - 2.0f * (x * x + z * z), 2.0f * (y * z + w * x), 0.0f) * sy;
+    matrix[2] = glm::vec4(2.0f * (x * z + w * y), 2.0f * (y * z - w * x), 1.0f - 2.0f * (x * x + y * y), 0.0f) * sz;
+    matrix[3] = glm::vec4(at(translationComponent), at(translationComponent + 1), at(translationComponent + 2), 1.0f);
+    return matrix;
+}
+} // namespace
+
+tel::AnimationClip tel::AnimationClip::resample(const Skeleton& skeleton, std::span<const JointTrack> tracks,
+                                                float duration, float sampleRate) {
+    assert(tracks.size() == skeleton.joint_count());
+    assert(duration >= 0.0f && sampleRate > 0.0f);
+    AnimationClip clip;
+    clip.jointCount = skeleton.joint_count();
+    clip.jointStride = padded_stride(clip.jointCount);
+    clip.clipDuration = duration;
+    clip.sampleCount = std::max<std::size_t>(static_cast<std::size_t>(std::ceil(duration * sampleRate)) + 1, 2);
+    clip.sampleRate = duration > 0.0f ? static_cast<float>(clip.sampleCount - 1) / duration : sampleRate;
+    clip.samples.resize(clip.sampleCount * jointComponentCount * clip.jointStride);
+
+    const auto mix = [](const glm::vec3& a, const glm::vec3& b, float t) { return glm::mix(a, b, t); };
+    const auto slerp = [](const glm::quat& a, const glm::quat& b, float t) { return glm::slerp(a, b, t); };
+    std::vector<JointTransform> joints(clip.jointCount);
+    for (std::size_t index = 0; index < clip.sampleCount; ++index) {
+        const float time = std::min(static_cast<float>(index) / clip.sampleRate, duration);
+        for (std::size_t joint = 0; joint < clip.jointCount; ++joint) {
+            const JointTransform& rest = skeleton.restPose[joint];
+            const JointTrack& track = tracks[joint];
+            joints[joint] = JointTransform{.translation = sample_keys(track.translations, time, rest.translation, mix),
+                                           .rotation = sample_keys(track.rotations, time, rest.rotation, slerp),
+                                           .scale = sample_keys(track.scales, time, rest.scale, mix)};
+        }
+        write_pose(clip.samples.data() + index * jointComponentCount * clip.jointStride, clip.jointStride, joints);
+    }
+    return clip;
+}
+
+tel::Animation::Animation(ThreadPool* threadPool) : threadPool(threadPool), useAvx2(cpu_supports_avx2()) {}
+
+tel::SkeletonHandle tel::Animation::add_skeleton(Skeleton skeleton) {
+    assert(skeleton.joint_count() <= maxSkeletonJoints);
+    assert(skeleton.restPose.size() == skeleton.joint_count());
+    assert(skeleton.inverseBindMatrices.size() == skeleton.joint_count());
+    const std::size_t stride = padded_stride(skeleton.joint_count());
+    std::vector<float> restPose(jointComponentCount * stride);
+    write_pose(restPose.data(), stride, skeleton.restPose);
+    return skeletons.add(
+        SkeletonData{.skeleton = std::move(skeleton), .jointStride = stride, .restPose = std::move(restPose)});
+}
+
+tel::AnimationClipHandle tel::Animation::add_clip(AnimationClip clip) { return clips.add(std::move(clip)); }
+
+tel::AnimationHandle tel::Animation::create_instance(SkeletonHandle skeleton) {
+    assert(skeletons.find(skeleton));
+    return instances.add(Instance{.skeleton = skeleton, .layers = {}, .paletteOffset = std::nullopt});
+}
+
+void tel::Animation::remove_instance(AnimationHandle instance) { instances.remove(instance); }
+
+std::vector<tel::AnimationLayer>& tel::Animation::layers(AnimationHandle instance) {
+    Instance* found = instances.find(instance);
+    assert(found);
+    return found->layers;
+}
+
+std::optional<std::uint32_t> tel::Animation::palette_offset(AnimationHandle instance) {
+    const Instance* found = instances.find(instance);
+    return found ? found->paletteOffset : std::nullopt;
+}
+
+void tel::Animation::update(float deltaSeconds) {
+    frameInstances.clear();
+    std::uint32_t paletteSize = 0;
+    for (auto& [handle, instance] : instances) {
+        const SkeletonData* skeleton = skeletons.find(instance.skeleton);
+        assert(skeleton);
+        advance(instance.layers, deltaSeconds);
+        instance.paletteOffset = paletteSize;
+        paletteSize += static_cast<std::uint32_t>(skeleton->skeleton.joint_count());
+        frameInstances.emplace_back(skeleton, &instance);
+    }
+    palette.resize(paletteSize);
+    threadPool->parallel_for(frameInstances.size(), instancesPerTask, [this](std::size_t begin, std::size_t end) {
+        for (std::size_t index = begin; index < end; ++index) {
+            pose(*frameInstances[index].first, *frameInstances[index].second);
+        }
+    });
+}
+
+void tel::Animation::advance(std::vector<AnimationLayer>& layers, float deltaSeconds) {
+    for (AnimationLayer& layer : layers) {
+        const AnimationClip* clip = clips.find(layer.clip);
+        assert(clip);
+        const float duration = clip->duration();
+        layer.time += deltaSeconds * layer.speed;
+        if (layer.loop && duration > 0.0f) {
+            layer.time = std::fmod(layer.time, duration);
+            if (layer.time < 0.0f) {
+                layer.time += duration;
+            }
+        } else {
+            layer.time = std::clamp(layer.time, 0.0f, duration);
+        }
+    }
+}
+
+void tel::Animation::pose(const SkeletonData& skeleton, const Instance& instance) {
+    thread_local std::vector<float> blended;
+    thread_local std::vector<glm::mat4> modelMatrices;
+    const std::size_t stride = skeleton.jointStride;
+    blended.assign(jointComponentCount * stride, 0.0f);
+
+    float totalWeight = 0.0f;
+    for (const AnimationLayer& layer : instance.layers) {
+        const AnimationClip* clip = clips.find(layer.clip);
+        if (clip == nullptr || layer.weight <= 0.0f) {
+            continue;
+        }
+        assert(clip->joint_stride() == stride);
+        const float position = layer.time * clip->sample_rate();
+        const std::size_t last = clip->sample_count() - 1;
+        const auto from = std::min(static_cast<std::size_t>(position), last);
+        const float alpha = std::clamp(position - static_cast<float>(from), 0.0f, 1.0f);
+        blend(blended.data(), clip->sample(from), clip->sample(std::min(from + 1, last)), alpha, layer.weight, stride,
+              useAvx2);
+        totalWeight += layer.weight;
+    }
+    if (totalWeight > 0.0f) {
+        normalize_pose(blended.data(), totalWeight, stride);
+    } else {
+        blended = skeleton.restPose;
+    }
+
+    const Skeleton& joints = skeleton.skeleton;
+    modelMatrices.resize(joints.joint_count());
+    glm::mat4* skinning = palette.data() + *instance.paletteOffset;
+    for (std::size_t joint = 0; joint < joints.joint_count(); ++joint) {
+        const glm::mat4 local = local_matrix(blended.data(), stride, joint);
+        const std::int32_t parent = joints.parents[joint];
+        modelMatrices[joint] = parent < 0 ? local : modelMatrices[static_cast<std::size_t>(parent)] * local;
+        skinning[joint] = modelMatrices[joint] * joints.inverseBindMatrices[joint];
+    }
+}
@@ -0,0 +1,250 @@
+#include "AssetArchive.hpp"
+#include "Compression.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <ranges>
+#include <tuple>
+
+namespace {
+constexpr std::array<char, 4> archiveMagic{'H', 'Z', 'P', 'K'};
+
+constexpr std::uint32_t archiveVersion = 1;
+
+// Entry data is aligned so uncompressed entries can be viewed in place as arrays of floats or vectors
+constexpr std::size_t dataAlignment = 16;
+
+struct ArchiveHeader {
+    std::array<char, 4> magic;
+    std::uint32_t version;
+    std::uint32_t entryCount;
+    std::uint32_t namesSize;
+};
+
+// Follows the header, one per entry, sorted by path hash and then path. Paths are stored together after the table
+// and referenced by offset into that block.
+struct ArchiveTableEntry {
+    std::uint64_t pathHash;
+    std::uint64_t offset;
+    std::uint64_t storedSize;
+    std::uint64_t size;
+    std::uint32_t nameOffset;
+    std::uint32_t nameLength;
+    std::uint32_t compression;
+    std::uint32_t reserved;
+};
+
+static_assert(sizeof(ArchiveHeader) == 16 && sizeof(ArchiveTableEntry) == 48, "The archive layout is fixed");
+
+template <typename T>
+T read_struct(std::span<const std::byte> data, std::size_t offset) {
+    T value;
+    std::memcpy(&value, data.data() + offset, sizeof(T));
+    return value;
+}
+
+template <typename T>
+void write_struct(std::vector<std::byte>& output, const T& value) {
+    output.append_range(std::as_bytes(std::span(&value, 1)));
+}
+} // namespace
+
+std::uint64_t tel::archive_path_hash(std::string_view path) {
+    // FNV-1a
+    std::uint64_t hash = 0xcbf29ce484222325ull;
+    for (const char character : path) {
+        hash ^= static_cast<unsigned char>(character);
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+std::expected<tel::AssetArchive, tel::ArchiveError> tel::AssetArchive::open(const std::filesystem::path& file) {
+    auto mapped = MappedFile::open(file);
+    if (!mapped) {
+        return std::unexpected(ArchiveError::CannotOpen);
+    }
+    auto entries = read_table_of_contents(mapped->bytes());
+    if (!entries) {
+        return std::unexpected(entries.error());
+    }
+    AssetArchive archive;
+    archive.file = std::move(mapped.value());
+    archive.entries = std::move(entries.value());
+    return archive;
+}
+
+std::expected<tel::AssetArchive, tel::ArchiveError> tel::AssetArchive::from_memory(std::span<const std::byte> data) {
+    auto entries = read_table_of_contents(data);
+    if (!entries) {
+        return std::unexpected(entries.error());
+    }
+    AssetArchive archive;
+    archive.entries = std::move(entries.value());
+    return archive;
+}
+
+std::expected<std::vector<tel::AssetArchive::Entry>, tel::ArchiveError>
+tel::AssetArchive::read_table_of_contents(std::span<const std::byte> data) {
+    if (data.size() < sizeof(ArchiveHeader)) {
+        return std::unexpected(ArchiveError::InvalidFormat);
+    }
+    const auto header = read_struct<ArchiveHeader>(data, 0);
+    if (header.magic != archiveMagic || header.version != archiveVersion) {
+        return std::unexpected(ArchiveError::InvalidFormat);
+    }
+    const std::size_t namesBegin = sizeof(ArchiveHeader) + std::size_t{header.entryCount} * sizeof(ArchiveTableEntry);
+    if (namesBegin + header.namesSize > data.size()) {
+        return std::unexpected(ArchiveError::InvalidFormat);
+    }
+    const std::string_view names(reinterpret_cast<const char*>(data.data() + namesBegin), header.namesSize);
+
+    std::vector<Entry> entries;
+    entries.reserve(header.entryCount);
+    for (std::size_t index = 0; index < header.entryCount; ++index) {
+        const auto entry =
+            read_struct<ArchiveTableEntry>(data, sizeof(ArchiveHeader) + index * sizeof(ArchiveTableEntry));
+        const bool inBounds = std::size_t{entry.nameOffset} + entry.nameLength <= names.size() &&
+                              entry.offset <= data.size() && entry.storedSize <= data.size() - entry.offset;
+        const bool knownCompression = entry.compression <= static_cast<std::uint32_t>(ArchiveCompression::Lz4);
+        if (!inBounds || !knownCompression) {
+            return std::unexpected(ArchiveError::InvalidFormat);
+        }
+        entries.emplace_back(Entry{.pathHash = entry.pathHash,
+                                   .path = names.substr(entry.nameOffset, entry.nameLength),
+                                   .stored = data.subspan(entry.offset, entry.storedSize),
+                                   .size = entry.size,
+                                   .compression = static_cast<ArchiveCompression>(entry.compression)});
+    }
+    // Lookups binary search the table, so an unsorted one is as broken as a truncated one
+    if (!std::ranges::is_sorted(entries, {}, [](const Entry& entry) { return std::tie(entry.pathHash, entry.path); })) {
+        return std::unexpected(ArchiveError::InvalidFormat);
+    }
+    return entries;
+}
+
+const tel::AssetArchive::Entry* tel::AssetArchive::find_entry(std::string_view path) const {
+    const std::uint64_t hash = archive_path_hash(path);
+    const auto candidates = std::ranges::equal_range(entries, hash, {}, &Entry::pathHash);
+    const auto entry = std::ranges::find(candidates, path, &Entry::path);
+    return entry == candidates.end() ? nullptr : &*entry;
+}
+
+std::optional<tel::ArchiveEntryInfo> tel::AssetArchive::find(std::string_view path) const {
+    const Entry* entry = find_entry(path);
+    if (entry == nullptr) {
+        return std::nullopt;
+    }
+    return ArchiveEntryInfo{.path = entry->path,
+                            .size = entry->size,
+                            .storedSize = entry->stored.size(),
+                            .compression = entry->compression};
+}
+
+std::expected<std::string, tel::ArchiveError> tel::AssetArchive::read(std::string_view path) const {
+    const Entry* entry = find_entry(path);
+    if (entry == nullptr) {
+        return std::unexpected(ArchiveError::NotFound);
+    }
+    // Checked before allocating, so a corrupt table of contents cannot ask for more than the entry could hold
+    const bool sizeFits = entry->compression == ArchiveCompression::None
+                              ? entry->size == entry->stored.size()
+                              : entry->size <= lz4_max_decompressed_size(entry->stored.size());
+    if (!sizeFits) {
+        return std::unexpected(ArchiveError::CorruptEntry);
+    }
+    std::string contents(entry->size, '\0');
+    const auto output = std::as_writable_bytes(std::span(contents));
+    if (entry->compression == ArchiveCompression::None) {
+        std::ranges::copy(entry->stored, output.begin());
+    } else if (!lz4_decompress(entry->stored, output)) {
+        return std::unexpected(ArchiveError::CorruptEntry);
+    }
+    return contents;
+}
+
+std::future<std::expected<std::string, tel::ArchiveError>>
+tel::AssetArchive::read_async(std::string path, ThreadPool& threadPool) const {
+    return threadPool.submit([this, path = std::move(path)] { return read(path); });
+}
+
+std::optional<std::string_view> tel::AssetArchive::view(std::string_view path) const {
+    const Entry* entry = find_entry(path);
+    if (entry == nullptr || entry->compression != ArchiveCompression::None) {
+        return std::nullopt;
+    }
+    return std::string_view(reinterpret_cast<const char*>(entry->stored.data()), entry->stored.size());
+}
+
+std::vector<std::string_view> tel::AssetArchive::paths() const {
+    return entries | std::views::transform(&Entry::path) | std::ranges::to<std::vector>();
+}
+
+void tel::AssetArchiveWriter::add(std::string path, std::span<const std::byte> contents, bool compress) {
+    PendingEntry entry{
+        .path = std::move(path), .stored = {}, .size = contents.size(), .compression = ArchiveCompression::None};
+    if (compress) {
+        auto compressed = lz4_compress(contents);
+        if (static_cast<double>(compressed.size()) <= static_cast<double>(contents.size()) * compressionThreshold) {
+            entry.stored = std::move(compressed);
+            entry.compression = ArchiveCompression::Lz4;
+        }
+    }
+    if (entry.compression == ArchiveCompression::None) {
+        entry.stored.assign(contents.begin(), contents.end());
+    }
+    pending.emplace_back(std::move(entry));
+}
+
+std::vector<std::byte> tel::AssetArchiveWriter::serialize() const {
+    auto sorted = pending | std::views::transform([](const PendingEntry& entry) { return &entry; }) |
+                  std::ranges::to<std::vector>();
+    std::ranges::sort(sorted, {}, [](const PendingEntry* entry) {
+        return std::tuple(archive_path_hash(entry->path), std::string_view(entry->path));
+    });
+
+    std::string names;
+    for (const PendingEntry* entry : sorted) {
+        names += entry->path;
+    }
+    const std::size_t namesBegin = sizeof(ArchiveHeader) + sorted.size() * sizeof(ArchiveTableEntry);
+    const auto align = [](std::size_t offset) { return (offset + dataAlignment - 1) / dataAlignment * dataAlignment; };
+
+    std::vector<std::byte> output;
+    write_struct(output, ArchiveHeader{.magic = archiveMagic,
+                                       .version = archiveVersion,
+                                       .entryCount = static_cast<std::uint32_t>(sorted.size()),
+                                       .namesSize = static_cast<std::uint32_t>(names.size())});
+    std::size_t nameOffset = 0;
+    std::size_t dataOffset = align(namesBegin + names.size());
+    for (const PendingEntry* entry : sorted) {
+        write_struct(output, ArchiveTableEntry{.pathHash = archive_path_hash(entry->path),
+                                               .offset = dataOffset,
+                                               .storedSize = entry->stored.size(),
+                                               .size = entry->size,
+                                               .nameOffset = static_cast<std::uint32_t>(nameOffset),
+                                               .nameLength = static_cast<std::uint32_t>(entry->path.size()),
+                                               .compression = static_cast<std::uint32_t>(entry->compression),
+                                               .reserved = 0});
+        nameOffset += entry->path.size();
+        dataOffset = align(dataOffset + entry->stored.size());
+    }
+    output.append_range(std::as_bytes(std::span(names)));
+    for (const PendingEntry* entry : sorted) {
+        output.resize(align(output.size()));
+        output.append_range(entry->stored);
+    }
+    return output;
+}
+
+std::expected<void, tel::ArchiveError> tel::AssetArchiveWriter::write(const std::filesystem::path& file) const {
+    const auto data = serialize();
+    std::ofstream out(file, std::ios::out | std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(data.data()), std::ssize(data));
+    if (!out) {
+        return std::unexpected(ArchiveError::CannotOpen);
+    }
+    return {};
+}
@@ -0,0 +1,93 @@
+#include "CameraPath.hpp"
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <format>
+#include <glm/ext/matrix_transform.hpp>
+#include <glm/matrix.hpp>
+#include <iterator>
+#include <ranges>
+
+namespace {
+glm::vec3 catmull_rom(const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2, const glm::vec3& p3, float u) {
+    const float u2 = u * u;
+    const float u3 = u2 * u;
+    return 0.5f * (2.0f * p1 + (p2 - p0) * u + (2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3) * u2 +
+                   (3.0f * p1 - p0 - 3.0f * p2 + p3) * u3);
+}
+
+bool is_space(char character) { return character == ' ' || character == '\t' || character == '\r'; }
+} // namespace
+
+std::expected<tel::CameraPath, tel::CameraPathError> tel::CameraPath::parse(std::string_view text) {
+    CameraPath path;
+    std::size_t lineNumber = 0;
+    for (const auto range : std::views::split(text, '\n')) {
+        ++lineNumber;
+        const std::string_view line(range.begin(), range.end());
+        const char* current = line.data();
+        const char* end = line.data() + line.size();
+        const auto skip_space = [&] {
+            current = std::find_if_not(current, end, is_space);
+        };
+        skip_space();
+        if (current == end || *current == '#') {
+            continue;
+        }
+        std::array<float, 6> values{};
+        for (float& value : values) {
+            skip_space();
+            const auto [next, error] = std::from_chars(current, end, value);
+            if (error != std::errc{}) {
+                return std::unexpected(CameraPathError{.line = lineNumber});
+            }
+            current = next;
+        }
+        skip_space();
+        if (current != end) {
+            return std::unexpected(CameraPathError{.line = lineNumber});
+        }
+        path.add({.position = {values[0], values[1], values[2]}, .target = {values[3], values[4], values[5]}});
+    }
+    return path;
+}
+
+std::string tel::CameraPath::serialize() const {
+    std::string text = "# position xyz, target xyz\n";
+    for (const auto& [position, target] : keyframes) {
+        std::format_to(std::back_inserter(text), "{} {} {} {} {} {}\n", position.x, position.y, position.z, target.x,
+                       target.y, target.z);
+    }
+    return text;
+}
+
+void tel::CameraPath::record(const Camera& camera) {
+    // The camera transform is the view matrix, so its inverse places the camera in the world
+    const glm::mat4 cameraToWorld = glm::inverse(camera.transform);
+    const glm::vec3 position(cameraToWorld[3]);
+    const glm::vec3 forward = -glm::vec3(cameraToWorld[2]);
+    add({.position = position, .target = position + forward});
+}
+
+tel::CameraKeyframe tel::CameraPath::sample(float t) const {
+    if (keyframes.size() < 2) {
+        return keyframes.empty() ? CameraKeyframe{} : keyframes.front();
+    }
+    const std::size_t last = keyframes.size() - 1;
+    const float scaled = std::clamp(t, 0.0f, 1.0f) * static_cast<float>(last);
+    const std::size_t segment = std::min(static_cast<std::size_t>(scaled), last - 1);
+    const float u = scaled - static_cast<float>(segment);
+    // The end keyframes are repeated so the curve starts and stops exactly on them
+    const CameraKeyframe& k0 = keyframes[segment == 0 ? 0 : segment - 1];
+    const CameraKeyframe& k1 = keyframes[segment];
+    const CameraKeyframe& k2 = keyframes[segment + 1];
+    const CameraKeyframe& k3 = keyframes[std::min(segment + 2, last)];
+    return {.position = catmull_rom(k0.position, k1.position, k2.position, k3.position, u),
+            .target = catmull_rom(k0.target, k1.target, k2.target, k3.target, u)};
+}
+
+glm::mat4 tel::CameraPath::view_at(float t) const {
+    const auto [position, target] = sample(t);
+    return glm::lookAt(position, target, glm::vec3(0.0f, 1.0f, 0.0f));
+}
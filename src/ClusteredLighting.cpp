@@ -0,0 +1,289 @@
+#include "ClusteredLighting.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define HAZOR_LIGHTING_AVX2 1
+#include <immintrin.h>
+#else
+#define HAZOR_LIGHTING_AVX2 0
+#endif
+
+namespace {
+constexpr std::size_t lanes = 8;
+
+// Far enough that squaring the distance to any cluster still fits in a float
+constexpr float paddingDistance = 1e18f;
+
+// Below -1, which no cosine reaches, so shaders can tell point lights from spot lights
+constexpr float pointLightCone = -2.0f;
+
+bool cpu_supports_avx2() {
+#if HAZOR_LIGHTING_AVX2
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#else
+    return false;
+#endif
+}
+
+std::size_t padded(std::size_t count) { return (count + lanes - 1) / lanes * lanes; }
+
+// How far in front of the camera slice boundary k of slices lies
+float slice_depth(const tel::Camera& camera, std::uint32_t k, std::uint32_t slices) {
+    const float nearClipping = camera.near_clipping();
+    const float farClipping = camera.far_clipping();
+    const float t = static_cast<float>(k) / static_cast<float>(slices);
+    if (camera.is_perspective()) {
+        return nearClipping * std::pow(farClipping / nearClipping, t);
+    }
+    return nearClipping + (farClipping - nearClipping) * t;
+}
+
+// Where the ray through a point on the screen reaches the given depth, in view space
+glm::vec3 at_depth(const tel::Camera& camera, const glm::vec3& onNearPlane, float depth) {
+    if (camera.is_perspective()) {
+        return onNearPlane * (depth / -onNearPlane.z);
+    }
+    return {onNearPlane.x, onNearPlane.y, -depth};
+}
+
+std::uint32_t overlapping_scalar(const float* x, const float* y, const float* z, const float* radius,
+                                 const glm::vec3& min, const glm::vec3& max) {
+    std::uint32_t mask = 0;
+    for (std::size_t i = 0; i < lanes; ++i) {
+        const float dx = std::max({min.x - x[i], x[i] - max.x, 0.0f});
+        const float dy = std::max({min.y - y[i], y[i] - max.y, 0.0f});
+        const float dz = std::max({min.z - z[i], z[i] - max.z, 0.0f});
+        if (dx * dx + dy * dy + dz * dz <= radius[i] * radius[i]) {
+            mask |= 1u << i;
+        }
+    }
+    return mask;
+}
+
+#if HAZOR_LIGHTING_AVX2
+__attribute__((target("avx2,fma"))) __m256 outside_avx2(const float* centers, float min, float max) {
+    const __m256 center = _mm256_loadu_ps(centers);
+    const __m256 below = _mm256_sub_ps(_mm256_set1_ps(min), center);
+    const __m256 above = _mm256_sub_ps(center, _mm256_set1_ps(max));
+    return _mm256_max_ps(_mm256_max_ps(below, above), _mm256_setzero_ps());
+}
+
+// The distance from each sphere's centre to the box, squared, against its radius squared
+__attribute__((target("avx2,fma"))) std::uint32_t overlapping_avx2(const float* x, const float* y, const float* z,
+                                                                    const float* radius, const glm::vec3& min,
+                                                                    const glm::vec3& max) {
+    const __m256 dx = outside_avx2(x, min.x, max.x);
+    const __m256 dy = outside_avx2(y, min.y, max.y);
+    const __m256 dz = outside_avx2(z, min.z, max.z);
+    const __m256 distance = _mm256_fmadd_ps(dz, dz, _mm256_fmadd_ps(dy, dy, _mm256_mul_ps(dx, dx)));
+    const __m256 r = _mm256_loadu_ps(radius);
+    return static_cast<std::uint32_t>(_mm256_movemask_ps(_mm256_cmp_ps(distance, _mm256_mul_ps(r, r), _CMP_LE_OQ)));
+}
+#endif
+} // namespace
+
+void tel::ClusteredLighting::Spheres::reserve(std::size_t spheres) {
+    const std::size_t size = padded(spheres);
+    if (x.size() < size) {
+        x.resize(size);
+        y.resize(size);
+        z.resize(size);
+        radius.resize(size);
+        light.resize(size);
+    }
+    count = 0;
+}
+
+void tel::ClusteredLighting::Spheres::push(const Spheres& from, std::size_t index) {
+    x[count] = from.x[index];
+    y[count] = from.y[index];
+    z[count] = from.z[index];
+    radius[count] = from.radius[index];
+    light[count] = from.light[index];
+    ++count;
+}
+
+void tel::ClusteredLighting::Spheres::pad() {
+    for (std::size_t i = count; i < padded(count); ++i) {
+        x[i] = paddingDistance;
+        y[i] = paddingDistance;
+        z[i] = paddingDistance;
+        radius[i] = 0.0f;
+        light[i] = 0;
+    }
+}
+
+tel::ClusteredLighting::ClusteredLighting(ThreadPool* threadPool, const ClusteredLightingOptions& options)
+    : threadPool(threadPool), options(options), sliceIndices(options.depthSlices), useAvx2(cpu_supports_avx2()) {
+    assert(options.tilesX > 0 && options.tilesY > 0 && options.depthSlices > 0);
+    ranges.resize(static_cast<std::size_t>(options.tilesX) * options.tilesY * options.depthSlices);
+}
+
+void tel::ClusteredLighting::update(std::span<const Light> lights, const Camera& camera, int viewportWidth,
+                                    int viewportHeight) {
+    if (camera.projection_matrix() != clusterProjection) {
+        build_clusters(camera);
+    }
+
+    const float nearClipping = camera.near_clipping();
+    const float farClipping = camera.far_clipping();
+    const auto slices = static_cast<float>(options.depthSlices);
+    const bool logarithmic = camera.is_perspective();
+    const float depthRange = logarithmic ? std::log(farClipping / nearClipping) : farClipping - nearClipping;
+    const float depthStart = logarithmic ? std::log(nearClipping) : nearClipping;
+    gridHeader = ClusterGrid{
+        .view = camera.transform,
+        .size = glm::uvec4(options.tilesX, options.tilesY, options.depthSlices, logarithmic),
+        .slicing = glm::vec4(static_cast<float>(options.tilesX) / static_cast<float>(std::max(viewportWidth, 1)),
+                             static_cast<float>(options.tilesY) / static_cast<float>(std::max(viewportHeight, 1)),
+                             slices / depthRange, -depthStart * slices / depthRange)};
+
+    gpuLights.clear();
+    gpuLights.reserve(lights.size());
+    viewSpheres.reserve(lights.size());
+    for (const Light& light : lights) {
+        const bool spot = light.type == LightType::Spot;
+        const float cosOuter = spot ? std::cos(light.outerConeAngle) : pointLightCone;
+        // Kept strictly above the outer cosine, so the falloff between the cones never divides by zero
+        const float cosInner = std::max(std::cos(light.innerConeAngle), cosOuter + 1e-4f);
+        gpuLights.push_back(GpuLight{.positionRadius = glm::vec4(light.position, light.radius),
+                                     .colorIntensity = glm::vec4(light.color, light.intensity),
+                                     .directionCosOuter = glm::vec4(glm::normalize(light.direction), cosOuter),
+                                     .cosInner = glm::vec4(cosInner, 0.0f, 0.0f, 0.0f)});
+        // Spot lights are binned by the sphere around their whole range, which holds the cone
+        const glm::vec4 center = camera.transform * glm::vec4(light.position, 1.0f);
+        const std::size_t i = viewSpheres.count++;
+        viewSpheres.x[i] = center.x;
+        viewSpheres.y[i] = center.y;
+        viewSpheres.z[i] = center.z;
+        viewSpheres.radius[i] = light.radius;
+        viewSpheres.light[i] = static_cast<std::uint32_t>(i);
+    }
+    viewSpheres.pad();
+
+    threadPool->parallel_for(options.depthSlices, 1, [this](std::size_t begin, std::size_t end) {
+        for (std::size_t slice = begin; slice < end; ++slice) {
+            bin_slice(static_cast<std::uint32_t>(slice));
+        }
+    });
+
+    // Each slice's ranges start from zero until the slices before it are known
+    const std::size_t clustersPerSlice = static_cast<std::size_t>(options.tilesX) * options.tilesY;
+    indices.clear();
+    for (std::size_t slice = 0; slice < options.depthSlices; ++slice) {
+        const auto base = static_cast<std::uint32_t>(indices.size());
+        for (std::size_t cluster = slice * clustersPerSlice; cluster < (slice + 1) * clustersPerSlice; ++cluster) {
+            ranges[cluster].offset += base;
+        }
+        indices.insert(indices.end(), sliceIndices[slice].begin(), sliceIndices[slice].end());
+    }
+}
+
+std::size_t tel::ClusteredLighting::cluster_at(glm::vec2 pixel, float viewDepth) const {
+    const float depth = gridHeader.size.w != 0 ? std::log(std::max(viewDepth, std::numeric_limits<float>::min()))
+                                               : viewDepth;
+    const auto cell = [](float position, std::uint32_t cells) {
+        const int index = static_cast<int>(std::floor(position));
+        return static_cast<std::size_t>(std::clamp(index, 0, static_cast<int>(cells) - 1));
+    };
+    const std::size_t x = cell(pixel.x * gridHeader.slicing.x, options.tilesX);
+    const std::size_t y = cell(pixel.y * gridHeader.slicing.y, options.tilesY);
+    const std::size_t z = cell(depth * gridHeader.slicing.z + gridHeader.slicing.w, options.depthSlices);
+    return x + options.tilesX * (y + options.tilesY * z);
+}
+
+void tel::ClusteredLighting::build_clusters(const Camera& camera) {
+    clusterProjection = camera.projection_matrix();
+    const glm::mat4 inverseProjection = glm::inverse(clusterProjection);
+    const auto on_near_plane = [&](std::uint32_t tileX, std::uint32_t tileY) {
+        const glm::vec4 clip(2.0f * static_cast<float>(tileX) / static_cast<float>(options.tilesX) - 1.0f,
+                             2.0f * static_cast<float>(tileY) / static_cast<float>(options.tilesY) - 1.0f, -1.0f,
+                             1.0f);
+        const glm::vec4 view = inverseProjection * clip;
+        return glm::vec3(view.x, view.y, view.z) / view.w;
+    };
+
+    clusterBounds.resize(ranges.size());
+    sliceBounds.resize(options.depthSlices);
+    rowBounds.resize(static_cast<std::size_t>(options.depthSlices) * options.tilesY);
+    const glm::vec3 empty(std::numeric_limits<float>::max());
+    for (std::uint32_t z = 0; z < options.depthSlices; ++z) {
+        const float depths[] = {slice_depth(camera, z, options.depthSlices),
+                                slice_depth(camera, z + 1, options.depthSlices)};
+        Bounds& slice = sliceBounds[z];
+        slice = Bounds{.min = empty, .max = -empty};
+        for (std::uint32_t y = 0; y < options.tilesY; ++y) {
+            Bounds& row = rowBounds[z * options.tilesY + y];
+            row = Bounds{.min = empty, .max = -empty};
+            for (std::uint32_t x = 0; x < options.tilesX; ++x) {
+                Bounds& cluster = clusterBounds[x + options.tilesX * (y + options.tilesY * z)];
+                cluster = Bounds{.min = empty, .max = -empty};
+                for (const glm::vec3& corner : {on_near_plane(x, y), on_near_plane(x + 1, y), on_near_plane(x, y + 1),
+                                                on_near_plane(x + 1, y + 1)}) {
+                    for (const float depth : depths) {
+                        const glm::vec3 point = at_depth(camera, corner, depth);
+                        cluster.min = glm::min(cluster.min, point);
+                        cluster.max = glm::max(cluster.max, point);
+                    }
+                }
+                row.min = glm::min(row.min, cluster.min);
+                row.max = glm::max(row.max, cluster.max);
+            }
+            slice.min = glm::min(slice.min, row.min);
+            slice.max = glm::max(slice.max, row.max);
+        }
+    }
+}
+
+void tel::ClusteredLighting::bin_slice(std::uint32_t slice) {
+    thread_local Spheres inSlice;
+    thread_local Spheres inRow;
+    std::vector<std::uint32_t>& out = sliceIndices[slice];
+    out.clear();
+    filter(viewSpheres, sliceBounds[slice], inSlice);
+    for (std::uint32_t y = 0; y < options.tilesY; ++y) {
+        const std::size_t row = static_cast<std::size_t>(slice) * options.tilesY + y;
+        filter(inSlice, rowBounds[row], inRow);
+        for (std::uint32_t x = 0; x < options.tilesX; ++x) {
+            const std::size_t cluster = x + options.tilesX * row;
+            ClusterRange& range = ranges[cluster];
+            range.offset = static_cast<std::uint32_t>(out.size());
+            for (std::size_t first = 0; first < inRow.count; first += lanes) {
+                for (std::uint32_t mask = overlapping(inRow, first, clusterBounds[cluster]); mask != 0;
+                     mask &= mask - 1) {
+                    out.push_back(inRow.light[first + std::countr_zero(mask)]);
+                }
+            }
+            range.count = static_cast<std::uint32_t>(out.size()) - range.offset;
+        }
+    }
+}
+
+std::uint32_t tel::ClusteredLighting::overlapping(const Spheres& spheres, std::size_t first,
+                                                  const Bounds& bounds) const {
+    const float* x = spheres.x.data() + first;
+    const float* y = spheres.y.data() + first;
+    const float* z = spheres.z.data() + first;
+    const float* radius = spheres.radius.data() + first;
+#if HAZOR_LIGHTING_AVX2
+    if (useAvx2) {
+        return overlapping_avx2(x, y, z, radius, bounds.min, bounds.max);
+    }
+#endif
+    return overlapping_scalar(x, y, z, radius, bounds.min, bounds.max);
+}
+
+void tel::ClusteredLighting::filter(const Spheres& spheres, const Bounds& bounds, Spheres& out) const {
+    out.reserve(spheres.count);
+    for (std::size_t first = 0; first < spheres.count; first += lanes) {
+        for (std::uint32_t mask = overlapping(spheres, first, bounds); mask != 0; mask &= mask - 1) {
+            out.push(spheres, first + std::countr_zero(mask));
+        }
+    }
+    out.pad();
+}
@@ -0,0 +1,164 @@
+#include "Compression.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+namespace {
+constexpr std::size_t minMatch = 4;
+
+// The format requires the last five bytes to be literals and the last match to start at least twelve bytes before
+// the end, so the decompressor can always copy in whole words
+constexpr std::size_t lastLiterals = 5;
+
+constexpr std::size_t matchSafeDistance = 12;
+
+constexpr std::size_t maxOffset = 65535;
+
+constexpr int hashBits = 16;
+
+// Every 64 bytes without a match, the search steps one byte further, so incompressible data is skipped quickly
+constexpr int skipShift = 6;
+
+std::uint32_t read32(const std::byte* data) {
+    std::uint32_t value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+std::uint32_t hash(std::uint32_t sequence) { return (sequence * 2654435761u) >> (32 - hashBits); }
+
+void write_length(std::vector<std::byte>& output, std::size_t length) {
+    for (; length >= 255; length -= 255) {
+        output.emplace_back(std::byte{255});
+    }
+    output.emplace_back(static_cast<std::byte>(length));
+}
+
+void write_sequence(std::vector<std::byte>& output, std::span<const std::byte> literals, std::size_t offset,
+                    std::size_t matchLength) {
+    const std::size_t extraMatch = matchLength - minMatch;
+    const auto token = static_cast<std::byte>((std::min<std::size_t>(literals.size(), 15) << 4) |
+                                              std::min<std::size_t>(extraMatch, 15));
+    output.emplace_back(token);
+    if (literals.size() >= 15) {
+        write_length(output, literals.size() - 15);
+    }
+    output.append_range(literals);
+    output.emplace_back(static_cast<std::byte>(offset & 0xff));
+    output.emplace_back(static_cast<std::byte>(offset >> 8));
+    if (extraMatch >= 15) {
+        write_length(output, extraMatch - 15);
+    }
+}
+
+void write_last_literals(std::vector<std::byte>& output, std::span<const std::byte> literals) {
+    output.emplace_back(static_cast<std::byte>(std::min<std::size_t>(literals.size(), 15) << 4));
+    if (literals.size() >= 15) {
+        write_length(output, literals.size() - 15);
+    }
+    output.append_range(literals);
+}
+
+// Reads the continuation bytes of a length that did not fit in its token nibble
+bool read_length(std::span<const std::byte> input, std::size_t& position, std::size_t& length) {
+    std::byte next;
+    do {
+        if (position >= input.size()) {
+            return false;
+        }
+        next = input[position++];
+        length += std::to_integer<std::size_t>(next);
+    } while (next == std::byte{255});
+    return true;
+}
+} // namespace
+
+std::vector<std::byte> tel::lz4_compress(std::span<const std::byte> input) {
+    std::vector<std::byte> output;
+    output.reserve(lz4_max_compressed_size(input.size()));
+    std::size_t anchor = 0;
+    if (input.size() > matchSafeDistance) {
+        std::vector<std::uint32_t> table(std::size_t{1} << hashBits, 0);
+        const std::byte* data = input.data();
+        const std::size_t matchStartLimit = input.size() - matchSafeDistance;
+        const std::size_t matchEndLimit = input.size() - lastLiterals;
+        std::size_t position = 1;
+        while (position < matchStartLimit) {
+            const std::uint32_t sequence = read32(data + position);
+            const std::uint32_t slot = hash(sequence);
+            const std::size_t candidate = table[slot];
+            table[slot] = static_cast<std::uint32_t>(position);
+            if (position - candidate > maxOffset || read32(data + candidate) != sequence) {
+                position += 1 + ((position - anchor) >> skipShift);
+                continue;
+            }
+            std::size_t length = minMatch;
+            while (position + length < matchEndLimit && data[candidate + length] == data[position + length]) {
+                ++length;
+            }
+            write_sequence(output, input.subspan(anchor, position - anchor), position - candidate, length);
+            position += length;
+            anchor = position;
+            // Seed the table just behind the match so runs of short repeats keep being found
+            if (position < matchStartLimit) {
+                table[hash(read32(data + position - 2))] = static_cast<std::uint32_t>(position - 2);
+            }
+        }
+    }
+    write_last_literals(output, input.subspan(anchor));
+    return output;
+}
+
+bool tel::lz4_decompress(std::span<const std::byte> input, std::span<std::byte> output) {
+    std::size_t in = 0;
+    std::size_t out = 0;
+    while (in < input.size()) {
+        const auto token = std::to_integer<std::size_t>(input[in++]);
+        std::size_t literals = token >> 4;
+        if (literals == 15 && !read_length(input, in, literals)) {
+            return false;
+        }
+        if (literals > input.size() - in || literals > output.size() - out) {
+            return false;
+        }
+        // An empty output has no storage to copy into, and memcpy must not be given a null pointer even for nothing
+        if (literals > 0) {
+            std::memcpy(output.data() + out, input.data() + in, literals);
+        }
+        in += literals;
+        out += literals;
+        // The last sequence is literals only
+        if (in == input.size()) {
+            break;
+        }
+
+        if (input.size() - in < 2) {
+            return false;
+        }
+        const std::size_t offset = std::to_integer<std::size_t>(input[in]) |
+                                   std::to_integer<std::size_t>(input[in + 1]) << 8;
+        in += 2;
+        std::size_t length = token & 0xf;
+        if (length == 15 && !read_length(input, in, length)) {
+            return false;
+        }
+        length += minMatch;
+        if (offset == 0 || offset > out || length > output.size() - out) {
+            return false;
+        }
+        std::byte* destination = output.data() + out;
+        const std::byte* source = destination - offset;
+        if (offset >= length) {
+            std::memcpy(destination, source, length);
+        } else {
+            // Overlapping copies repeat the last offset bytes, so they have to go front to back, which neither
+            // memcpy nor memmove does
+            for (std::size_t i = 0; i < length; ++i) {
+                destination[i] = source[i];
+            }
+        }
+        out += length;
+    }
+    return out == output.size();
+}
@@ -0,0 +1,51 @@
+#include "DynamicResolution.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+tel::DynamicResolution::DynamicResolution(const DynamicResolutionOptions& options)
+    : settings(options), currentScale(options.maxScale) {
+    assert(options.minScale > 0.0f && options.minScale <= options.maxScale && options.scaleStep > 0.0f);
+}
+
+void tel::DynamicResolution::record_gpu_time(double milliseconds) {
+    if (framesToSettle > 0) {
+        --framesToSettle;
+        return;
+    }
+    smoothedMilliseconds = smoothedMilliseconds < 0.0
+                               ? milliseconds
+                               : smoothedMilliseconds + (milliseconds - smoothedMilliseconds) * smoothing;
+    const double target = settings.targetFrameMilliseconds;
+    const auto ideal = static_cast<float>(currentScale * std::sqrt(target / std::max(smoothedMilliseconds, 1e-3)));
+    const float desired = quantize(ideal);
+    if (desired < currentScale) {
+        change_scale(desired);
+    } else if (desired > currentScale && smoothedMilliseconds < target * climbHeadroom) {
+        change_scale(quantize(currentScale + settings.scaleStep));
+    }
+}
+
+glm::ivec2 tel::DynamicResolution::render_size(glm::ivec2 outputSize) const {
+    const auto scaled = [this](int size) {
+        return std::max(static_cast<int>(std::lround(static_cast<float>(size) * currentScale)), 1);
+    };
+    return {scaled(outputSize.x), scaled(outputSize.y)};
+}
+
+float tel::DynamicResolution::quantize(float scale) const {
+    // Rounded down, so a frame over budget always gets at least as much relief as asked for
+    const float stepped = std::floor(scale / settings.scaleStep + 1e-3f) * settings.scaleStep;
+    return std::clamp(stepped, settings.minScale, settings.maxScale);
+}
+
+void tel::DynamicResolution::change_scale(float scale) {
+    if (scale == currentScale) {
+        return;
+    }
+    currentScale = scale;
+    smoothedMilliseconds = -1.0;
+    framesToSettle = settleFrames;
+    ++changes;
+}
@@ -0,0 +1,17 @@
+#include "EmbeddedAssets.hpp"
+
+#include <cassert>
+#include <cmrc/cmrc.hpp>
+
+CMRC_DECLARE(tel::data);
+
+const tel::AssetArchive& tel::embedded_assets() {
+    static const AssetArchive archive = [] {
+        const auto file = cmrc::tel::data::get_filesystem().open("assets.hzpk");
+        auto opened = AssetArchive::from_memory(std::as_bytes(std::span(file.begin(), file.end())));
+        // Produced by the build, so anything wrong with it is a build bug
+        assert(opened.has_value());
+        return std::move(opened.value());
+    }();
+    return archive;
+}
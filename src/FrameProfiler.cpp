@@ -0,0 +1,138 @@
+#include "FrameProfiler.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <format>
+#include <numeric>
+#include <ranges>
+
+namespace {
+double milliseconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+} // namespace
+
+std::string_view tel::to_string(FramePhase phase) {
+    switch (phase) {
+    case FramePhase::Input:
+        return "input";
+    case FramePhase::Streaming:
+        return "streaming";
+    case FramePhase::Scripts:
+        return "scripts";
+    case FramePhase::Animation:
+        return "animation";
+    case FramePhase::Particles:
+        return "particles";
+    case FramePhase::Rendering:
+        return "rendering";
+    case FramePhase::Present:
+        return "present";
+    case FramePhase::Count:
+        break;
+    }
+    return "unknown";
+}
+
+tel::TimingSummary tel::summarize(std::span<const double> milliseconds) {
+    if (milliseconds.empty()) {
+        return {};
+    }
+    std::vector<double> sorted(milliseconds.begin(), milliseconds.end());
+    std::ranges::sort(sorted);
+    const auto percentile = [&](double fraction) {
+        const auto rank = static_cast<std::size_t>(std::ceil(fraction * static_cast<double>(sorted.size())));
+        return sorted[std::clamp<std::size_t>(rank, 1, sorted.size()) - 1];
+    };
+    const auto worst = std::ranges::max_element(milliseconds);
+    return TimingSummary{.mean = std::reduce(sorted.begin(), sorted.end()) / static_cast<double>(sorted.size()),
+                         .p50 = percentile(0.50),
+                         .p95 = percentile(0.95),
+                         .p99 = percentile(0.99),
+                         .worst = *worst,
+                         .worstFrame = static_cast<std::size_t>(worst - milliseconds.begin()),
+                         .samples = sorted.size()};
+}
+
+tel::FrameProfiler::PhaseTimer::~PhaseTimer() {
+    sample->phaseMilliseconds[static_cast<std::size_t>(phase)] += milliseconds_since(start);
+}
+
+void tel::FrameProfiler::begin_frame() {
+    frames.emplace_back();
+    frameStart = std::chrono::steady_clock::now();
+}
+
+tel::FrameProfiler::PhaseTimer tel::FrameProfiler::time(FramePhase phase) {
+    assert(!frames.empty());
+    return PhaseTimer(&frames.back(), phase);
+}
+
+void tel::FrameProfiler::end_frame() { frames.back().cpuMilliseconds = milliseconds_since(frameStart); }
+
+void tel::FrameProfiler::record_gpu_time(std::size_t frame, double milliseconds) {
+    if (frame < frames.size()) {
+        frames[frame].gpuMilliseconds = milliseconds;
+    }
+}
+
+tel::TimingSummary tel::FrameProfiler::cpu_summary() const {
+    return summarize(frames | std::views::transform(&FrameSample::cpuMilliseconds) | std::ranges::to<std::vector>());
+}
+
+tel::TimingSummary tel::FrameProfiler::phase_summary(FramePhase phase) const {
+    return summarize(frames | std::views::transform([&](const FrameSample& sample) {
+                         return sample.phaseMilliseconds[static_cast<std::size_t>(phase)];
+                     }) |
+                     std::ranges::to<std::vector>());
+}
+
+tel::TimingSummary tel::FrameProfiler::gpu_summary() const {
+    const auto measured = [](const FrameSample& sample) { return sample.gpuMilliseconds.has_value(); };
+    TimingSummary summary =
+        summarize(frames | std::views::filter(measured) |
+                  std::views::transform([](const FrameSample& sample) { return *sample.gpuMilliseconds; }) |
+                  std::ranges::to<std::vector>());
+    if (summary.samples == 0) {
+        return summary;
+    }
+    // Frames without a measurement were skipped, so the worst frame's index has to be found again
+    const auto worst = std::ranges::find(frames, std::optional(summary.worst), &FrameSample::gpuMilliseconds);
+    summary.worstFrame = static_cast<std::size_t>(worst - frames.begin());
+    return summary;
+}
+
+void tel::FrameProfiler::write_csv(std::ostream& out) const {
+    out << "frame,cpu_ms";
+    for (std::size_t phase = 0; phase < framePhaseCount; ++phase) {
+        out << ',' << to_string(static_cast<FramePhase>(phase)) << "_ms";
+    }
+    out << ",gpu_ms\n";
+    for (const auto& [index, sample] : std::views::enumerate(frames)) {
+        out << std::format("{},{:.4f}", index, sample.cpuMilliseconds);
+        for (const double milliseconds : sample.phaseMilliseconds) {
+            out << std::format(",{:.4f}", milliseconds);
+        }
+        out << (sample.gpuMilliseconds ? std::format(",{:.4f}\n", *sample.gpuMilliseconds) : ",\n");
+    }
+}
+
+void tel::FrameProfiler::write_summary(std::ostream& out) const {
+    const auto write_row = [&](std::string_view name, const TimingSummary& summary) {
+        out << std::format("{:<10} {:>9.3f} {:>9.3f} {:>9.3f} {:>9.3f} {:>9.3f} {:>8}\n", name, summary.mean,
+                           summary.p50, summary.p95, summary.p99, summary.worst, summary.worstFrame);
+    };
+    out << std::format("{} frames, milliseconds\n", frames.size());
+    out << std::format("{:<10} {:>9} {:>9} {:>9} {:>9} {:>9} {:>8}\n", "", "mean", "p50", "p95", "p99", "worst",
+                       "at frame");
+    write_row("cpu", cpu_summary());
+    for (std::size_t phase = 0; phase < framePhaseCount; ++phase) {
+        write_row(to_string(static_cast<FramePhase>(phase)), phase_summary(static_cast<FramePhase>(phase)));
+    }
+    if (const TimingSummary gpu = gpu_summary(); gpu.samples > 0) {
+        write_row("gpu", gpu);
+    } else {
+        out << "gpu        no timer query results\n";
+    }
+}
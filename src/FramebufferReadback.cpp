@@ -0,0 +1,190 @@
+#include "FramebufferReadback.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <ranges>
+
+namespace {
+// Colour is always copied as RGBA bytes, the layout drivers read back fastest, and converted on a worker afterwards
+std::pair<GLenum, GLenum> gl_read_format(tel::ReadbackFormat format) {
+    if (format == tel::ReadbackFormat::Depth32F) {
+        return {GL_DEPTH_COMPONENT, GL_FLOAT};
+    }
+    return {GL_RGBA, GL_UNSIGNED_BYTE};
+}
+
+constexpr std::size_t copiedBytesPerPixel = 4;
+
+// GL rows start at the bottom, so rows are flipped while converting
+void convert(std::span<const std::byte> copied, tel::ReadbackResult& result) {
+    const auto width = static_cast<std::size_t>(result.width);
+    const auto height = static_cast<std::size_t>(result.height);
+    const std::size_t sourceStride = width * copiedBytesPerPixel;
+    const std::size_t targetStride = width * tel::bytes_per_pixel(result.format);
+    result.pixels.resize(targetStride * height);
+    for (std::size_t row = 0; row < height; ++row) {
+        const std::byte* source = copied.data() + (height - 1 - row) * sourceStride;
+        std::byte* target = result.pixels.data() + row * targetStride;
+        switch (result.format) {
+        case tel::ReadbackFormat::Rgba8:
+        case tel::ReadbackFormat::Depth32F:
+            std::memcpy(target, source, sourceStride);
+            break;
+        case tel::ReadbackFormat::Bgra8:
+            for (std::size_t pixel = 0; pixel < width; ++pixel, source += 4, target += 4) {
+                target[0] = source[2];
+                target[1] = source[1];
+                target[2] = source[0];
+                target[3] = source[3];
+            }
+            break;
+        case tel::ReadbackFormat::Rgb8:
+            for (std::size_t pixel = 0; pixel < width; ++pixel, source += 4, target += 3) {
+                std::memcpy(target, source, 3);
+            }
+            break;
+        }
+    }
+}
+} // namespace
+
+tel::Image tel::to_image(ReadbackResult result) {
+    assert(result.format == ReadbackFormat::Rgba8);
+    return Image{.width = result.width, .height = result.height, .pixels = std::move(result.pixels)};
+}
+
+tel::FramebufferReadback::FramebufferReadback(ThreadPool* threadPool, const FramebufferReadbackOptions& options,
+                                              BindFramebuffer bindFramebuffer)
+    : threadPool(threadPool), bindFramebuffer(std::move(bindFramebuffer)),
+      slots(std::max<std::size_t>(options.bufferCount, 1)) {}
+
+tel::FramebufferReadback::~FramebufferReadback() { finish(); }
+
+void tel::FramebufferReadback::read(const Framebuffer& framebuffer, const ReadbackRequest& request,
+                                    ReadbackCallback callback) {
+    const ReadbackRegion region = request.region.value_or(
+        ReadbackRegion{.x = 0, .y = 0, .width = framebuffer.width(), .height = framebuffer.height()});
+    assert(region.width > 0 && region.height > 0);
+    assert(region.x >= 0 && region.x + region.width <= framebuffer.width());
+    assert(region.y >= 0 && region.y + region.height <= framebuffer.height());
+
+    const std::size_t bytes = static_cast<std::size_t>(region.width) * region.height * copiedBytesPerPixel;
+    Slot& slot = acquire(bytes);
+    slot.result = ReadbackResult{
+        .width = region.width, .height = region.height, .format = request.format, .sequence = nextSequence++};
+    slot.callback = std::move(callback);
+
+    const auto [format, type] = gl_read_format(request.format);
+    if (request.format != ReadbackFormat::Depth32F) {
+        glNamedFramebufferReadBuffer(framebuffer.underlying(), framebuffer.is_default() ? GL_BACK : request.attachment);
+    }
+    bindFramebuffer(framebuffer);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer.underlying());
+    glReadPixels(region.x, framebuffer.height() - region.y - region.height, region.width, region.height, format, type,
+                 nullptr);
+    // Left bound, it would turn every later glReadPixels into a buffer copy
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    slot.fence = Fence::insert();
+    slot.state = State::Copying;
+}
+
+std::future<tel::ReadbackResult> tel::FramebufferReadback::read(const Framebuffer& framebuffer,
+                                                                const ReadbackRequest& request) {
+    auto promise = std::make_shared<std::promise<ReadbackResult>>();
+    auto future = promise->get_future();
+    read(framebuffer, request, [promise](ReadbackResult result) { promise->set_value(std::move(result)); });
+    return future;
+}
+
+void tel::FramebufferReadback::update() {
+    using namespace std::chrono_literals;
+    for (Slot& slot : slots) {
+        if (slot.state == State::Copying && slot.fence.signalled()) {
+            start_conversion(slot);
+        }
+        if (slot.state == State::Converting && slot.conversion.wait_for(0s) == std::future_status::ready) {
+            wait_for_conversion(slot);
+        }
+    }
+}
+
+void tel::FramebufferReadback::finish() {
+    for (Slot& slot : slots) {
+        if (slot.state == State::Copying) {
+            wait_for_copy(slot);
+        }
+    }
+    for (Slot& slot : slots) {
+        if (slot.state == State::Converting) {
+            wait_for_conversion(slot);
+        }
+    }
+}
+
+std::size_t tel::FramebufferReadback::in_flight() const {
+    return static_cast<std::size_t>(
+        std::ranges::count_if(slots, [](const Slot& slot) { return slot.state != State::Free; }));
+}
+
+tel::FramebufferReadback::Slot& tel::FramebufferReadback::acquire(std::size_t bytes) {
+    update();
+    auto free = std::ranges::find(slots, State::Free, &Slot::state);
+    if (free == slots.end()) {
+        ++stallCount;
+        // Conversions finish on their own, so waiting for one of them is cheaper than waiting on the GPU
+        auto converting = std::ranges::find(slots, State::Converting, &Slot::state);
+        if (converting == slots.end()) {
+            const auto oldest = std::ranges::min_element(slots, {}, [](const Slot& slot) {
+                return slot.result.sequence;
+            });
+            wait_for_copy(*oldest);
+            converting = oldest;
+        }
+        wait_for_conversion(*converting);
+        free = converting;
+    }
+
+    Slot& slot = *free;
+    if (slot.buffer.capacity() < bytes) {
+        // Released before the larger buffer replaces it; nothing reads it any more
+        ReadbackBuffer smaller = std::move(slot.buffer);
+        slot.buffer = ReadbackBuffer::create(bytes);
+    }
+    return slot;
+}
+
+void tel::FramebufferReadback::start_conversion(Slot& slot) {
+    // The copy is done, so the fence is deleted here
+    const Fence passed = std::move(slot.fence);
+    slot.state = State::Converting;
+    // The callback is taken out of the slot, so whichever path delivers, a reused slot never calls it again
+    auto convert_and_deliver = [&slot, callback = std::move(slot.callback)] {
+        const std::size_t pixels = static_cast<std::size_t>(slot.result.width) * slot.result.height;
+        convert(slot.buffer.mapped().first(pixels * copiedBytesPerPixel), slot.result);
+        callback(std::move(slot.result));
+    };
+    slot.callback = nullptr;
+    if (threadPool == nullptr) {
+        convert_and_deliver();
+        slot.conversion = {};
+        slot.state = State::Free;
+        return;
+    }
+    slot.conversion = threadPool->submit(std::move(convert_and_deliver));
+}
+
+void tel::FramebufferReadback::wait_for_copy(Slot& slot) {
+    slot.fence.wait();
+    start_conversion(slot);
+}
+
+void tel::FramebufferReadback::wait_for_conversion(Slot& slot) {
+    if (slot.conversion.valid()) {
+        threadPool->wait(slot.conversion);
+    }
+    slot.conversion = {};
+    slot.state = State::Free;
+}
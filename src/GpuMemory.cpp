@@ -0,0 +1,48 @@
+#include "GpuMemory.hpp"
+
+void tel::GpuMemoryTracker::record_allocation(GpuMemoryCategory category, std::size_t bytes) {
+    Counters& counter = counters[static_cast<std::size_t>(category)];
+    const std::size_t total = counter.bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    counter.allocations.fetch_add(1, std::memory_order_relaxed);
+    counter.liveAllocations.fetch_add(1, std::memory_order_relaxed);
+    std::size_t highWater = counter.highWaterBytes.load(std::memory_order_relaxed);
+    while (total > highWater &&
+           !counter.highWaterBytes.compare_exchange_weak(highWater, total, std::memory_order_relaxed)) {
+    }
+}
+
+void tel::GpuMemoryTracker::record_deallocation(GpuMemoryCategory category, std::size_t bytes) {
+    Counters& counter = counters[static_cast<std::size_t>(category)];
+    counter.bytes.fetch_sub(bytes, std::memory_order_relaxed);
+    counter.liveAllocations.fetch_sub(1, std::memory_order_relaxed);
+}
+
+tel::AllocationStats tel::GpuMemoryTracker::stats(GpuMemoryCategory category) const {
+    const Counters& counter = counters[static_cast<std::size_t>(category)];
+    return AllocationStats{.bytes = counter.bytes.load(std::memory_order_relaxed),
+                           .highWaterBytes = counter.highWaterBytes.load(std::memory_order_relaxed),
+                           .allocations = counter.allocations.load(std::memory_order_relaxed),
+                           .liveAllocations = counter.liveAllocations.load(std::memory_order_relaxed)};
+}
+
+tel::GpuMemoryReport tel::GpuMemoryTracker::report() const {
+    GpuMemoryReport report{};
+    for (std::size_t i = 0; i < gpuMemoryCategoryCount; ++i) {
+        const auto category = static_cast<GpuMemoryCategory>(i);
+        report[i] = {category, stats(category)};
+    }
+    return report;
+}
+
+std::size_t tel::GpuMemoryTracker::total_bytes() const {
+    std::size_t total = 0;
+    for (const Counters& counter : counters) {
+        total += counter.bytes.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+tel::GpuMemoryTracker& tel::gpu_memory_tracker() {
+    static GpuMemoryTracker tracker;
+    return tracker;
+}
@@ -0,0 +1,59 @@
+#include "Image.hpp"
+
+#include <cstring>
+#include <memory>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+std::expected<tel::Image, tel::ImageLoadError> tel::load_image_from_memory(std::string_view data) {
+    int width{};
+    int height{};
+    int fileChannels{};
+    std::unique_ptr<stbi_uc, decltype(&stbi_image_free)> decoded(
+        stbi_load_from_memory(reinterpret_cast<const stbi_uc*>(data.data()), static_cast<int>(data.size()), &width,
+                              &height, &fileChannels, 0),
+        stbi_image_free);
+    if (!decoded) {
+        return std::unexpected(ImageLoadError{.reason = stbi_failure_reason()});
+    }
+    // Kept with as many channels as the file has, so a greyscale texture takes a quarter of the memory
+    Image image{.width = width, .height = height, .channels = fileChannels};
+    image.pixels.resize(static_cast<std::size_t>(width) * height * fileChannels);
+    std::memcpy(image.pixels.data(), decoded.get(), image.pixels.size());
+    return image;
+}
+
+tel::Image tel::downsample(const Image& image) {
+    Image result{
+        .width = mip_dimension(image.width, 1), .height = mip_dimension(image.height, 1), .channels = image.channels};
+    result.pixels.resize(static_cast<std::size_t>(result.width) * result.height * result.channels);
+    const auto texel = [&](int x, int y, int channel) {
+        x = std::min(x, image.width - 1);
+        y = std::min(y, image.height - 1);
+        return static_cast<unsigned int>(
+            image.pixels[(static_cast<std::size_t>(y) * image.width + x) * image.channels + channel]);
+    };
+    for (int y = 0; y < result.height; ++y) {
+        for (int x = 0; x < result.width; ++x) {
+            for (int channel = 0; channel < result.channels; ++channel) {
+                const unsigned int sum = texel(2 * x, 2 * y, channel) + texel(2 * x + 1, 2 * y, channel) +
+                                         texel(2 * x, 2 * y + 1, channel) + texel(2 * x + 1, 2 * y + 1, channel);
+                result.pixels[(static_cast<std::size_t>(y) * result.width + x) * result.channels + channel] =
+                    static_cast<std::byte>((sum + 2) / 4);
+            }
+        }
+    }
+    return result;
+}
+
+std::vector<tel::Image> tel::generate_mip_chain(Image image) {
+    std::vector<Image> chain;
+    const int levels = mip_level_count(image.width, image.height);
+    chain.reserve(levels);
+    chain.emplace_back(std::move(image));
+    for (int level = 1; level < levels; ++level) {
+        chain.emplace_back(downsample(chain.back()));
+    }
+    return chain;
+}
@@ -0,0 +1,82 @@
+#include "MappedFile.hpp"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <cerrno>
+
+#ifdef _WIN32
+std::expected<tel::MappedFile, tel::FileLoadError> tel::MappedFile::open(const std::filesystem::path& file) {
+    HANDLE handle = CreateFileW(file.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (handle == INVALID_HANDLE_VALUE) {
+        return std::unexpected(static_cast<FileLoadError>(ENOENT));
+    }
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(handle, &fileSize)) {
+        CloseHandle(handle);
+        return std::unexpected(static_cast<FileLoadError>(EIO));
+    }
+    if (fileSize.QuadPart == 0) {
+        CloseHandle(handle);
+        return MappedFile();
+    }
+    HANDLE mapping = CreateFileMappingW(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(handle);
+    if (mapping == nullptr) {
+        return std::unexpected(static_cast<FileLoadError>(EIO));
+    }
+    void* address = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    // The view keeps the mapping alive
+    CloseHandle(mapping);
+    if (address == nullptr) {
+        return std::unexpected(static_cast<FileLoadError>(EIO));
+    }
+    return MappedFile(address, static_cast<std::size_t>(fileSize.QuadPart));
+}
+
+tel::MappedFile::~MappedFile() {
+    if (address.value() != nullptr) {
+        UnmapViewOfFile(address);
+    }
+}
+#else
+std::expected<tel::MappedFile, tel::FileLoadError> tel::MappedFile::open(const std::filesystem::path& file) {
+    const int descriptor = ::open(file.c_str(), O_RDONLY | O_CLOEXEC);
+    if (descriptor < 0) {
+        return std::unexpected(static_cast<FileLoadError>(errno));
+    }
+    struct stat status {};
+    if (fstat(descriptor, &status) != 0) {
+        const int error = errno;
+        close(descriptor);
+        return std::unexpected(static_cast<FileLoadError>(error));
+    }
+    const auto fileSize = static_cast<std::size_t>(status.st_size);
+    if (fileSize == 0) {
+        close(descriptor);
+        return MappedFile();
+    }
+    void* address = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, descriptor, 0);
+    const int error = errno;
+    // The mapping keeps the file alive
+    close(descriptor);
+    if (address == MAP_FAILED) {
+        return std::unexpected(static_cast<FileLoadError>(error));
+    }
+    return MappedFile(address, fileSize);
+}
+
+tel::MappedFile::~MappedFile() {
+    if (address.value() != nullptr) {
+        munmap(address, size);
+    }
+}
+#endif
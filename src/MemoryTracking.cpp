@@ -0,0 +1,64 @@
+#include "MemoryTracking.hpp"
+
+#include <iostream>
+
+void tel::MemoryTracker::record_allocation(MemorySubsystem subsystem, std::size_t bytes) {
+    Counters& counter = counters_for(subsystem);
+    const std::size_t total = counter.bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    counter.allocations.fetch_add(1, std::memory_order_relaxed);
+    counter.liveAllocations.fetch_add(1, std::memory_order_relaxed);
+    std::size_t highWater = counter.highWaterBytes.load(std::memory_order_relaxed);
+    while (total > highWater &&
+           !counter.highWaterBytes.compare_exchange_weak(highWater, total, std::memory_order_relaxed)) {
+    }
+    if (total > counter.limit.load(std::memory_order_relaxed) && !counter.warned.exchange(true)) {
+        std::cerr << "Memory for " << to_string(subsystem) << " grew to " << total << " bytes, over its limit of "
+                  << counter.limit.load() << '\n';
+    }
+}
+
+void tel::MemoryTracker::record_deallocation(MemorySubsystem subsystem, std::size_t bytes) {
+    Counters& counter = counters_for(subsystem);
+    counter.bytes.fetch_sub(bytes, std::memory_order_relaxed);
+    counter.liveAllocations.fetch_sub(1, std::memory_order_relaxed);
+}
+
+tel::AllocationStats tel::MemoryTracker::stats(MemorySubsystem subsystem) const {
+    const Counters& counter = counters[static_cast<std::size_t>(subsystem)];
+    return AllocationStats{.bytes = counter.bytes.load(std::memory_order_relaxed),
+                           .highWaterBytes = counter.highWaterBytes.load(std::memory_order_relaxed),
+                           .allocations = counter.allocations.load(std::memory_order_relaxed),
+                           .liveAllocations = counter.liveAllocations.load(std::memory_order_relaxed)};
+}
+
+tel::MemoryReport tel::MemoryTracker::report() const {
+    MemoryReport report{};
+    for (std::size_t i = 0; i < memorySubsystemCount; ++i) {
+        const auto subsystem = static_cast<MemorySubsystem>(i);
+        report[i] = {subsystem, stats(subsystem)};
+    }
+    return report;
+}
+
+void tel::MemoryTracker::set_limit(MemorySubsystem subsystem, std::size_t bytes) {
+    Counters& counter = counters_for(subsystem);
+    counter.limit.store(bytes, std::memory_order_relaxed);
+    counter.warned.store(false, std::memory_order_relaxed);
+}
+
+tel::MemoryTracker& tel::memory_tracker() {
+    static MemoryTracker tracker;
+    return tracker;
+}
+
+std::pmr::memory_resource* tel::tracked_resource(MemorySubsystem subsystem) {
+    static auto resources = [] {
+        std::array<TrackingResource*, memorySubsystemCount> created{};
+        for (std::size_t i = 0; i < memorySubsystemCount; ++i) {
+            // Never destroyed, so allocations released during static destruction still have somewhere to go
+            created[i] = new TrackingResource(static_cast<MemorySubsystem>(i));
+        }
+        return created;
+    }();
+    return resources[static_cast<std::size_t>(subsystem)];
+}
@@ -1,35 +1,215 @@
 #include "MeshLoading.hpp"
+#include "ObjLoading.hpp"
 
+#include <algorithm>
 #include <assimp/Importer.hpp>
 #include <assimp/postprocess.h>
 #include <assimp/scene.h>
+#include <functional>
+#include <glm/gtc/type_ptr.hpp>
 #include <ranges>
+#include <string>
+#include <unordered_map>
 
 inline glm::vec3 from_assimp(const aiVector3D& vector3) { return {vector3.x, vector3.y, vector3.z}; }
 
-inline tel::Mesh convert_to_mesh(const aiMesh& assimp_mesh) {
-    tel::Mesh mesh;
-    mesh.reserve(assimp_mesh.mNumVertices);
+inline glm::vec2 tex_coord_from_assimp(const aiVector3D& uvw) { return {uvw.x, uvw.y}; }
+
+inline glm::quat quaternion_from_assimp(const aiQuaternion& quaternion) {
+    return {quaternion.w, quaternion.x, quaternion.y, quaternion.z};
+}
+
+// Assimp matrices are row-major
+inline glm::mat4 matrix_from_assimp(const aiMatrix4x4& matrix) { return glm::transpose(glm::make_mat4(&matrix.a1)); }
+
+// Appends straight into the combined mesh, so multi-mesh files are not copied once per mesh and again per join
+inline void append_mesh(tel::Mesh& mesh, const aiMesh& assimp_mesh) {
+    const auto indexOffset = static_cast<tel::TriangleIndex>(mesh.positions.size());
     mesh.positions.append_range(std::span(assimp_mesh.mVertices, assimp_mesh.mNumVertices) |
                                 std::views::transform(from_assimp));
     mesh.normals.append_range(std::span(assimp_mesh.mNormals, assimp_mesh.mNumVertices) |
                               std::views::transform(from_assimp));
+    // Texture coordinates stay empty unless some mesh has them, and are then zero for the meshes that do not
+    if (assimp_mesh.HasTextureCoords(0)) {
+        mesh.texCoords.resize(indexOffset);
+        mesh.texCoords.append_range(std::span(assimp_mesh.mTextureCoords[0], assimp_mesh.mNumVertices) |
+                                    std::views::transform(tex_coord_from_assimp));
+    } else if (!mesh.texCoords.empty()) {
+        mesh.texCoords.resize(mesh.positions.size());
+    }
     for (const aiFace& face : std::span(assimp_mesh.mFaces, assimp_mesh.mNumFaces)) {
-        mesh.triangles.append_range(std::span(face.mIndices, face.mNumIndices));
+        mesh.triangles.append_range(std::span(face.mIndices, face.mNumIndices) |
+                                    std::views::transform(std::bind_front(std::plus{}, indexOffset)));
+    }
+}
+
+inline tel::Mesh combine_meshes(std::span<aiMesh* const> assimpMeshes) {
+    std::size_t numVertices = 0;
+    std::size_t numIndices = 0;
+    for (const aiMesh* assimpMesh : assimpMeshes) {
+        numVertices += assimpMesh->mNumVertices;
+        // Triangulated, so every face has three indices
+        numIndices += static_cast<std::size_t>(assimpMesh->mNumFaces) * 3;
+    }
+    tel::Mesh mesh;
+    mesh.positions.reserve(numVertices);
+    mesh.normals.reserve(numVertices);
+    if (std::ranges::any_of(assimpMeshes, [](const aiMesh* assimpMesh) { return assimpMesh->HasTextureCoords(0); })) {
+        mesh.texCoords.reserve(numVertices);
+    }
+    mesh.triangles.reserve(numIndices);
+    for (const aiMesh* assimpMesh : assimpMeshes) {
+        append_mesh(mesh, *assimpMesh);
     }
     return mesh;
 }
 
-std::expected<tel::Mesh, tel::MeshLoadError> tel::load_mesh_from_memory(std::string_view data) {
+inline std::expected<tel::Mesh, tel::MeshLoadError> load_with_assimp(std::string_view data) {
     Assimp::Importer importer;
     const auto* scene =
         importer.ReadFileFromMemory(data.data(), data.size(), aiProcess_OptimizeMeshes | aiProcess_Triangulate);
+    if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) {
+        return std::unexpected(tel::MeshLoadError{});
+    }
+    return combine_meshes(std::span(scene->mMeshes, scene->mNumMeshes));
+}
+
+std::expected<tel::Mesh, tel::MeshLoadError> tel::load_mesh_from_memory(std::string_view data, ThreadPool* threadPool) {
+    if (looks_like_obj(data)) {
+        if (auto mesh = load_obj_from_memory(data, threadPool)) {
+            return mesh;
+        }
+    }
+    return load_with_assimp(data);
+}
+
+namespace {
+struct JointLookup {
+    std::unordered_map<std::string, std::uint8_t> byName;
+    // The joint of the first node each mesh hangs from, -1 for meshes no node refers to
+    std::vector<std::int32_t> meshJoints;
+};
+
+// Depth first, so parents come before their children
+bool add_joints(const aiNode& node, std::int32_t parent, tel::Skeleton& skeleton, JointLookup& lookup) {
+    if (skeleton.joint_count() == tel::maxSkeletonJoints) {
+        return false;
+    }
+    const auto joint = static_cast<std::uint8_t>(skeleton.joint_count());
+    aiVector3D scale;
+    aiQuaternion rotation;
+    aiVector3D translation;
+    node.mTransformation.Decompose(scale, rotation, translation);
+    skeleton.names.emplace_back(node.mName.C_Str());
+    skeleton.parents.push_back(parent);
+    skeleton.restPose.push_back(tel::JointTransform{.translation = from_assimp(translation),
+                                                    .rotation = quaternion_from_assimp(rotation),
+                                                    .scale = from_assimp(scale)});
+    // Nodes that are not bones only ever skin their own meshes, which are already in their space
+    skeleton.inverseBindMatrices.emplace_back(1.0f);
+    lookup.byName.emplace(skeleton.names.back(), joint);
+    for (const unsigned int mesh : std::span(node.mMeshes, node.mNumMeshes)) {
+        if (mesh < lookup.meshJoints.size() && lookup.meshJoints[mesh] < 0) {
+            lookup.meshJoints[mesh] = joint;
+        }
+    }
+    for (const aiNode* child : std::span(node.mChildren, node.mNumChildren)) {
+        if (!add_joints(*child, joint, skeleton, lookup)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Keeps the four strongest influences, which aiProcess_LimitBoneWeights should already have ensured
+void add_influence(tel::JointIndices& joints, tel::JointWeights& weights, std::uint8_t joint, float weight) {
+    int weakest = 0;
+    for (int slot = 1; slot < 4; ++slot) {
+        if (weights[slot] < weights[weakest]) {
+            weakest = slot;
+        }
+    }
+    if (weight > weights[weakest]) {
+        joints[weakest] = joint;
+        weights[weakest] = weight;
+    }
+}
+
+void append_skin(tel::SkinWeights& skin, tel::Skeleton& skeleton, const JointLookup& lookup, const aiMesh& mesh,
+                 std::uint8_t meshJoint) {
+    const std::size_t vertexOffset = skin.joints.size();
+    skin.joints.resize(vertexOffset + mesh.mNumVertices, tel::JointIndices(0));
+    skin.weights.resize(vertexOffset + mesh.mNumVertices, tel::JointWeights(0.0f));
+    for (const aiBone* bone : std::span(mesh.mBones, mesh.mNumBones)) {
+        const auto joint = lookup.byName.find(bone->mName.C_Str());
+        if (joint == lookup.byName.end()) {
+            continue;
+        }
+        skeleton.inverseBindMatrices[joint->second] = matrix_from_assimp(bone->mOffsetMatrix);
+        for (const aiVertexWeight& influence : std::span(bone->mWeights, bone->mNumWeights)) {
+            const std::size_t vertex = vertexOffset + influence.mVertexId;
+            add_influence(skin.joints[vertex], skin.weights[vertex], joint->second, influence.mWeight);
+        }
+    }
+    for (std::size_t vertex = vertexOffset; vertex < skin.joints.size(); ++vertex) {
+        tel::JointWeights& weights = skin.weights[vertex];
+        const float total = weights.x + weights.y + weights.z + weights.w;
+        if (total > 0.0f) {
+            weights /= total;
+        } else {
+            skin.joints[vertex] = tel::JointIndices(meshJoint, 0, 0, 0);
+            weights = tel::JointWeights(1.0f, 0.0f, 0.0f, 0.0f);
+        }
+    }
+}
+
+tel::AnimationClip load_clip(const aiAnimation& animation, const tel::Skeleton& skeleton, const JointLookup& lookup,
+                             float sampleRate) {
+    const double ticksPerSecond = animation.mTicksPerSecond > 0.0 ? animation.mTicksPerSecond : 25.0;
+    const auto seconds = [&](double ticks) { return static_cast<float>(ticks / ticksPerSecond); };
+    std::vector<tel::JointTrack> tracks(skeleton.joint_count());
+    for (const aiNodeAnim* channel : std::span(animation.mChannels, animation.mNumChannels)) {
+        const auto joint = lookup.byName.find(channel->mNodeName.C_Str());
+        if (joint == lookup.byName.end()) {
+            continue;
+        }
+        tel::JointTrack& track = tracks[joint->second];
+        for (const aiVectorKey& key : std::span(channel->mPositionKeys, channel->mNumPositionKeys)) {
+            track.translations.push_back({.time = seconds(key.mTime), .value = from_assimp(key.mValue)});
+        }
+        for (const aiQuatKey& key : std::span(channel->mRotationKeys, channel->mNumRotationKeys)) {
+            track.rotations.push_back({.time = seconds(key.mTime), .value = quaternion_from_assimp(key.mValue)});
+        }
+        for (const aiVectorKey& key : std::span(channel->mScalingKeys, channel->mNumScalingKeys)) {
+            track.scales.push_back({.time = seconds(key.mTime), .value = from_assimp(key.mValue)});
+        }
+    }
+    return tel::AnimationClip::resample(skeleton, tracks, seconds(animation.mDuration), sampleRate);
+}
+} // namespace
+
+std::expected<tel::SkinnedModel, tel::MeshLoadError> tel::load_skinned_model_from_memory(std::string_view data,
+                                                                                       float sampleRate) {
+    Assimp::Importer importer;
+    const auto* scene = importer.ReadFileFromMemory(data.data(), data.size(),
+                                                    aiProcess_Triangulate | aiProcess_LimitBoneWeights);
     if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) {
         return std::unexpected(MeshLoadError{});
     }
-    return std::ranges::fold_left_first(
-               std::span(scene->mMeshes, scene->mNumMeshes) |
-                   std::views::transform([](const auto* ptr) { return convert_to_mesh(*ptr); }),
-               join)
-        .value_or(Mesh{});
-}
\ No newline at end of file
+    const auto assimpMeshes = std::span(scene->mMeshes, scene->mNumMeshes);
+    SkinnedModel model;
+    JointLookup lookup{.byName = {}, .meshJoints = std::vector<std::int32_t>(assimpMeshes.size(), -1)};
+    if (!add_joints(*scene->mRootNode, -1, model.skeleton, lookup)) {
+        return std::unexpected(MeshLoadError{});
+    }
+    model.mesh = combine_meshes(assimpMeshes);
+    for (std::size_t index = 0; index < assimpMeshes.size(); ++index) {
+        const auto meshJoint = static_cast<std::uint8_t>(std::max(lookup.meshJoints[index], 0));
+        append_skin(model.skin, model.skeleton, lookup, *assimpMeshes[index], meshJoint);
+    }
+    for (const aiAnimation* animation : std::span(scene->mAnimations, scene->mNumAnimations)) {
+        model.clips.push_back(load_clip(*animation, model.skeleton, lookup, sampleRate));
+        model.clipNames.emplace_back(animation->mName.C_Str());
+    }
+    return model;
+}
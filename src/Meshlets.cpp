@@ -0,0 +1,286 @@
+#include "Meshlets.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <glm/geometric.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/matrix.hpp>
+#include <limits>
+
+namespace {
+// Enough meshlets per task to outweigh handing it to a worker
+constexpr std::size_t meshletsPerTask = 1024;
+
+constexpr std::uint32_t none = std::numeric_limits<std::uint32_t>::max();
+
+// Normals spread wider than this are too far apart for a cone to ever cull anything useful
+constexpr float minConeSpread = 0.1f;
+
+constexpr float neverCulled = 2.0f;
+
+// Vertices to the triangles using them, as offsets into one flat list
+struct Adjacency {
+    std::vector<std::uint32_t> offsets;
+    std::vector<std::uint32_t> triangles;
+
+    [[nodiscard]] std::span<const std::uint32_t> of(tel::TriangleIndex vertex) const {
+        return std::span(triangles).subspan(offsets[vertex], offsets[vertex + 1] - offsets[vertex]);
+    }
+};
+
+Adjacency build_adjacency(const tel::Mesh& mesh) {
+    Adjacency adjacency;
+    adjacency.offsets.assign(mesh.positions.size() + 1, 0);
+    for (const tel::TriangleIndex vertex : mesh.triangles) {
+        ++adjacency.offsets[vertex + 1];
+    }
+    for (std::size_t vertex = 1; vertex < adjacency.offsets.size(); ++vertex) {
+        adjacency.offsets[vertex] += adjacency.offsets[vertex - 1];
+    }
+    adjacency.triangles.resize(mesh.triangles.size());
+    std::vector<std::uint32_t> filled(adjacency.offsets.begin(), adjacency.offsets.end() - 1);
+    for (std::size_t index = 0; index < mesh.triangles.size(); ++index) {
+        adjacency.triangles[filled[mesh.triangles[index]]++] = static_cast<std::uint32_t>(index / 3);
+    }
+    return adjacency;
+}
+
+// A plane through one of a triangle's corners, facing the way its front does
+struct FacePlane {
+    glm::vec3 corner;
+    glm::vec3 normal;
+};
+
+// A sphere around the box bounding the meshlet's vertices, and a cone around the mean of its face normals
+void compute_bounds(const tel::Mesh& mesh, tel::Meshlet& meshlet, std::span<const tel::TriangleIndex> triangles,
+                    std::vector<FacePlane>& faces) {
+    glm::vec3 min = mesh.positions[triangles.front()];
+    glm::vec3 max = min;
+    for (const tel::TriangleIndex vertex : triangles) {
+        min = glm::min(min, mesh.positions[vertex]);
+        max = glm::max(max, mesh.positions[vertex]);
+    }
+    meshlet.center = (min + max) * 0.5f;
+    float radiusSquared = 0.0f;
+    for (const tel::TriangleIndex vertex : triangles) {
+        const glm::vec3 offset = mesh.positions[vertex] - meshlet.center;
+        radiusSquared = std::max(radiusSquared, glm::dot(offset, offset));
+    }
+    meshlet.radius = std::sqrt(radiusSquared);
+
+    meshlet.coneApex = meshlet.center;
+    meshlet.coneAxis = glm::vec3(0.0f);
+    meshlet.coneCutoff = neverCulled;
+    faces.clear();
+    glm::vec3 normalSum(0.0f);
+    for (std::size_t first = 0; first < triangles.size(); first += 3) {
+        const glm::vec3& a = mesh.positions[triangles[first]];
+        const glm::vec3 normal =
+            glm::cross(mesh.positions[triangles[first + 1]] - a, mesh.positions[triangles[first + 2]] - a);
+        const float length = glm::length(normal);
+        // Degenerate triangles are never drawn, so they do not constrain the cone
+        if (length > 0.0f) {
+            faces.push_back({.corner = a, .normal = normal / length});
+            normalSum += faces.back().normal;
+        }
+    }
+    const float sumLength = glm::length(normalSum);
+    if (sumLength <= 0.0f) {
+        return;
+    }
+    const glm::vec3 axis = normalSum / sumLength;
+    float minDot = 1.0f;
+    for (const FacePlane& face : faces) {
+        minDot = std::min(minDot, glm::dot(axis, face.normal));
+    }
+    if (minDot <= minConeSpread) {
+        return;
+    }
+    // The apex is pulled back along the axis until it is behind every triangle's plane, so that anything further back
+    // in the cone is too
+    float apexDistance = 0.0f;
+    for (const FacePlane& face : faces) {
+        apexDistance = std::max(apexDistance, glm::dot(meshlet.center - face.corner, face.normal) /
+                                                  glm::dot(axis, face.normal));
+    }
+    meshlet.coneApex = meshlet.center - axis * apexDistance;
+    meshlet.coneAxis = axis;
+    // Normals up to acos(minDot) from the axis all face away from cameras within asin(cutoff) of it
+    meshlet.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+}
+
+// Rows of the combined matrix added to and subtracted from the last row give the clip planes, facing inwards
+void extract_planes(const glm::mat4& matrix, glm::vec4 (&planes)[6]) {
+    const auto row = [&](int i) { return glm::vec4(matrix[0][i], matrix[1][i], matrix[2][i], matrix[3][i]); };
+    for (int axis = 0; axis < 3; ++axis) {
+        planes[2 * axis] = row(3) + row(axis);
+        planes[2 * axis + 1] = row(3) - row(axis);
+    }
+    for (glm::vec4& plane : planes) {
+        plane /= glm::length(glm::vec3(plane));
+    }
+}
+} // namespace
+
+tel::MeshletMesh tel::build_meshlets(const Mesh& mesh, const MeshletOptions& options) {
+    const std::size_t triangleCount = mesh.triangles.size() / 3;
+    const std::size_t maxTriangles = std::max<std::size_t>(options.maxTriangles, 1);
+    const std::size_t maxVertices = std::max<std::size_t>(options.maxVertices, 3);
+    const Adjacency adjacency = build_adjacency(mesh);
+    MeshletMesh result;
+    result.triangles.reserve(mesh.triangles.size());
+    result.meshlets.reserve(triangleCount / maxTriangles + 1);
+
+    std::vector<std::uint8_t> used(triangleCount);
+    // Stamped with the meshlet a vertex was last added to, or a triangle last offered to
+    std::vector<std::uint32_t> vertexMeshlet(mesh.positions.size(), none);
+    std::vector<std::uint32_t> candidateMeshlet(triangleCount, none);
+    std::vector<std::uint32_t> candidates;
+    std::vector<FacePlane> faces;
+    std::size_t nextSeed = 0;
+    while (true) {
+        while (nextSeed < triangleCount && used[nextSeed]) {
+            ++nextSeed;
+        }
+        if (nextSeed == triangleCount) {
+            break;
+        }
+        const auto id = static_cast<std::uint32_t>(result.meshlets.size());
+        const std::size_t firstIndex = result.triangles.size();
+        std::size_t vertices = 0;
+        std::size_t triangles = 0;
+        candidates.clear();
+        const auto new_vertices = [&](std::uint32_t triangle) {
+            std::size_t count = 0;
+            for (std::size_t corner = 0; corner < 3; ++corner) {
+                count += vertexMeshlet[mesh.triangles[3 * triangle + corner]] != id;
+            }
+            return count;
+        };
+        const auto add = [&](std::uint32_t triangle) {
+            used[triangle] = 1;
+            ++triangles;
+            for (std::size_t corner = 0; corner < 3; ++corner) {
+                const TriangleIndex vertex = mesh.triangles[3 * triangle + corner];
+                result.triangles.push_back(vertex);
+                if (vertexMeshlet[vertex] == id) {
+                    continue;
+                }
+                vertexMeshlet[vertex] = id;
+                ++vertices;
+                for (const std::uint32_t neighbour : adjacency.of(vertex)) {
+                    if (!used[neighbour] && candidateMeshlet[neighbour] != id) {
+                        candidateMeshlet[neighbour] = id;
+                        candidates.push_back(neighbour);
+                    }
+                }
+            }
+        };
+
+        add(static_cast<std::uint32_t>(nextSeed));
+        while (triangles < maxTriangles) {
+            std::erase_if(candidates, [&](std::uint32_t triangle) { return used[triangle] != 0; });
+            std::uint32_t best = none;
+            std::size_t bestNew = 4;
+            for (const std::uint32_t candidate : candidates) {
+                const std::size_t added = new_vertices(candidate);
+                if (added < bestNew && vertices + added <= maxVertices) {
+                    best = candidate;
+                    bestNew = added;
+                    if (added == 0) {
+                        break;
+                    }
+                }
+            }
+            if (best == none) {
+                break;
+            }
+            add(best);
+        }
+
+        Meshlet meshlet{.firstIndex = static_cast<std::uint32_t>(firstIndex),
+                        .indexCount = static_cast<std::uint32_t>(result.triangles.size() - firstIndex)};
+        compute_bounds(mesh, meshlet, std::span(result.triangles).subspan(firstIndex), faces);
+        result.meshlets.push_back(meshlet);
+    }
+    return result;
+}
+
+tel::MeshletCulling::MeshletCulling(ThreadPool* threadPool, const MeshletOptions& options)
+    : threadPool(threadPool), meshletOptions(options) {}
+
+void tel::MeshletCulling::cull(std::span<const MeshletInstance> instances, const Camera& camera) {
+    perspective = camera.is_perspective();
+    const glm::mat4 inverseView = glm::inverse(camera.transform);
+    // Cameras look down their negative z axis
+    const glm::vec4 eye = perspective ? inverseView[3] : -inverseView[2];
+    const glm::mat4 viewProjection = camera.matrix();
+    views.resize(instances.size());
+    firstMeshlet.resize(instances.size() + 1);
+    firstMeshlet[0] = 0;
+    for (std::size_t instance = 0; instance < instances.size(); ++instance) {
+        const Transform& transform = instances[instance].transform;
+        InstanceView& view = views[instance];
+        extract_planes(viewProjection * transform, view.planes);
+        view.eye = glm::vec3(glm::inverse(transform) * eye);
+        if (!perspective) {
+            view.eye = glm::normalize(view.eye);
+        }
+        // Mirroring turns the triangles around, and what faced away in the mesh now faces the camera
+        const float determinant =
+            glm::dot(glm::cross(glm::vec3(transform[0]), glm::vec3(transform[1])), glm::vec3(transform[2]));
+        view.coneCulling = meshletOptions.coneCulling && determinant > 0.0f;
+        firstMeshlet[instance + 1] = firstMeshlet[instance] + instances[instance].meshlets.size();
+    }
+
+    const std::size_t total = firstMeshlet.back();
+    visible.resize(total);
+    threadPool->parallel_for(total, meshletsPerTask, [&](std::size_t begin, std::size_t end) {
+        std::size_t instance = std::ranges::upper_bound(firstMeshlet, begin) - firstMeshlet.begin() - 1;
+        for (std::size_t index = begin; index < end; ++index) {
+            while (index >= firstMeshlet[instance + 1]) {
+                ++instance;
+            }
+            const Meshlet& meshlet = instances[instance].meshlets[index - firstMeshlet[instance]];
+            visible[index] = is_visible(meshlet, views[instance]);
+        }
+    });
+
+    drawRanges.clear();
+    firstRange.resize(instances.size() + 1);
+    for (std::size_t instance = 0; instance < instances.size(); ++instance) {
+        firstRange[instance] = drawRanges.size();
+        const std::span<const Meshlet> meshlets = instances[instance].meshlets;
+        for (std::size_t i = 0; i < meshlets.size(); ++i) {
+            const Meshlet& meshlet = meshlets[i];
+            if (!visible[firstMeshlet[instance] + i]) {
+                ++meshletsCulled;
+                trianglesCulled += meshlet.indexCount / 3;
+                continue;
+            }
+            const bool extends = drawRanges.size() > firstRange[instance] &&
+                                 drawRanges.back().firstIndex + drawRanges.back().indexCount == meshlet.firstIndex;
+            if (extends) {
+                drawRanges.back().indexCount += meshlet.indexCount;
+            } else {
+                drawRanges.push_back({.firstIndex = meshlet.firstIndex, .indexCount = meshlet.indexCount});
+            }
+        }
+    }
+    firstRange[instances.size()] = drawRanges.size();
+    meshletsTested += total;
+}
+
+bool tel::MeshletCulling::is_visible(const Meshlet& meshlet, const InstanceView& view) const {
+    for (const glm::vec4& plane : view.planes) {
+        if (glm::dot(glm::vec3(plane), meshlet.center) + plane.w < -meshlet.radius) {
+            return false;
+        }
+    }
+    if (!view.coneCulling) {
+        return true;
+    }
+    const glm::vec3 direction = perspective ? glm::normalize(meshlet.coneApex - view.eye) : view.eye;
+    // Written so that a camera right on the apex, with no direction to it, keeps the meshlet
+    return !(glm::dot(direction, meshlet.coneAxis) >= meshlet.coneCutoff);
+}
@@ -0,0 +1,471 @@
+#include "ObjLoading.hpp"
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <glm/geometric.hpp>
+#include <limits>
+#include <optional>
+#include <ranges>
+#include <vector>
+
+namespace {
+constexpr std::uint32_t missingIndex = std::numeric_limits<std::uint32_t>::max();
+
+// Chunks smaller than this are not worth a task of their own
+constexpr std::size_t minChunkBytes = 256 * 1024;
+
+constexpr std::size_t chunksPerThread = 4;
+
+// How much of the file looks_like_obj reads
+constexpr std::size_t sniffBytes = 4096;
+
+// One corner of a face as 0-based indices into the file's positions, texture coordinates and normals
+struct Corner {
+    std::uint32_t position;
+    std::uint32_t texCoord = missingIndex;
+    std::uint32_t normal = missingIndex;
+
+    bool operator==(const Corner&) const = default;
+};
+
+// A negative index counts back from the attributes parsed so far, and the chunk does not yet know how many earlier
+// chunks parsed. It is stored relative to the chunk and fixed up once every chunk's starting offsets are known.
+struct RelativeIndex {
+    std::size_t corner;
+    std::uint32_t Corner::* attribute;
+};
+
+constexpr std::array<std::uint32_t Corner::*, 3> cornerAttributes{&Corner::position, &Corner::texCoord,
+                                                                  &Corner::normal};
+
+struct ObjChunk {
+    std::vector<tel::Position> positions;
+    std::vector<tel::TexCoord> texCoords;
+    std::vector<tel::Normal> normals;
+    // Faces already fanned into triangles, three corners each
+    std::vector<Corner> corners;
+    std::vector<RelativeIndex> relativeIndices;
+    // Each distinct corner of this chunk once, and per corner which of them it is
+    std::vector<Corner> uniqueCorners;
+    std::vector<std::uint32_t> cornerIds;
+    // Global vertex per unique corner, filled in by the serial merge
+    std::vector<std::uint32_t> vertexIds;
+    bool failed = false;
+};
+
+// Open-addressing map from corners to ids. Sized up front for the most corners it can receive, so it never rehashes;
+// a node-based map would allocate once per vertex, which is most of the cost on large files.
+class CornerTable {
+  public:
+    explicit CornerTable(std::size_t maxEntries) : slots(std::bit_ceil(std::max<std::size_t>(maxEntries * 2, 16))) {}
+
+    // Returns the id corner already has, or gives it nextId
+    std::uint32_t insert(const Corner& corner, std::uint32_t nextId) {
+        const std::size_t mask = slots.size() - 1;
+        for (std::size_t slot = hash(corner) & mask;; slot = (slot + 1) & mask) {
+            if (slots[slot].id == missingIndex) {
+                slots[slot] = {.corner = corner, .id = nextId};
+                return nextId;
+            }
+            if (slots[slot].corner == corner) {
+                return slots[slot].id;
+            }
+        }
+    }
+
+  private:
+    struct Slot {
+        Corner corner{};
+        std::uint32_t id = missingIndex;
+    };
+
+    std::vector<Slot> slots;
+
+    static std::size_t hash(const Corner& corner) {
+        std::uint64_t value = corner.position * 0x9E3779B97F4A7C15ull;
+        value ^= corner.texCoord * 0xC2B2AE3D27D4EB4Full;
+        value ^= corner.normal * 0x165667B19E3779F9ull;
+        return static_cast<std::size_t>(value ^ (value >> 29));
+    }
+};
+
+bool is_space(char character) { return character == ' ' || character == '\t' || character == '\r'; }
+
+class LineReader {
+  public:
+    explicit LineReader(std::string_view line) : current(line.data()), end(line.data() + line.size()) {}
+
+    std::string_view token() {
+        skip_space();
+        const char* begin = current;
+        while (current != end && !is_space(*current)) {
+            ++current;
+        }
+        return {begin, current};
+    }
+
+    std::optional<float> number() {
+        skip_space();
+        // from_chars does not accept an explicit plus sign
+        if (current != end && *current == '+') {
+            ++current;
+        }
+        float value;
+        const auto [next, error] = std::from_chars(current, end, value);
+        if (error != std::errc{} || (next != end && !is_space(*next))) {
+            return std::nullopt;
+        }
+        current = next;
+        return value;
+    }
+
+    template <std::size_t N>
+    std::optional<std::array<float, N>> numbers() {
+        std::array<float, N> values;
+        for (float& value : values) {
+            const auto parsed = number();
+            if (!parsed) {
+                return std::nullopt;
+            }
+            value = *parsed;
+        }
+        return values;
+    }
+
+    bool at_end() {
+        skip_space();
+        return current == end;
+    }
+
+  private:
+    const char* current;
+    const char* end;
+
+    void skip_space() {
+        while (current != end && is_space(*current)) {
+            ++current;
+        }
+    }
+};
+
+// Splits at newlines into roughly equal pieces. memchr is vectorized by every mainstream C library, so the scanning
+// here and in parse_chunk runs 16 to 32 bytes at a time without the parser carrying its own SIMD paths.
+std::vector<std::string_view> split_into_chunks(std::string_view data, std::size_t chunkCount) {
+    std::vector<std::string_view> chunks;
+    const std::size_t target = std::max<std::size_t>(data.size() / chunkCount, 1);
+    std::size_t begin = 0;
+    while (begin < data.size()) {
+        std::size_t end = std::min(begin + target, data.size());
+        if (end < data.size()) {
+            const void* newline = std::memchr(data.data() + end, '\n', data.size() - end);
+            end = newline ? static_cast<std::size_t>(static_cast<const char*>(newline) - data.data()) + 1 : data.size();
+        }
+        chunks.emplace_back(data.substr(begin, end - begin));
+        begin = end;
+    }
+    return chunks;
+}
+
+// Reads one v, v/vt, v//vn or v/vt/vn group. Bit n of relativeMask is set when attribute n was a negative index.
+bool parse_corner(std::string_view token, const ObjChunk& chunk, Corner& corner, unsigned int& relativeMask) {
+    const std::array<std::size_t, 3> counts{chunk.positions.size(), chunk.texCoords.size(), chunk.normals.size()};
+    const char* current = token.data();
+    const char* end = token.data() + token.size();
+    for (std::size_t attribute = 0; attribute < cornerAttributes.size() && current != end; ++attribute) {
+        if (attribute > 0) {
+            if (*current != '/') {
+                return false;
+            }
+            ++current;
+            // v//vn leaves the texture coordinate out
+            if (current != end && *current == '/') {
+                continue;
+            }
+        }
+        std::int64_t index;
+        const auto [next, error] = std::from_chars(current, end, index);
+        if (error != std::errc{} || index == 0) {
+            return false;
+        }
+        current = next;
+        if (index > 0) {
+            corner.*cornerAttributes[attribute] = static_cast<std::uint32_t>(index - 1);
+        } else {
+            // Wraps below zero when it points into an earlier chunk; adding the chunk's offset later wraps it back
+            const std::int64_t relative = static_cast<std::int64_t>(counts[attribute]) + index;
+            corner.*cornerAttributes[attribute] = static_cast<std::uint32_t>(relative);
+            relativeMask |= 1u << attribute;
+        }
+    }
+    return current == end;
+}
+
+bool parse_face(LineReader& reader, ObjChunk& chunk) {
+    thread_local std::vector<std::pair<Corner, unsigned int>> face;
+    face.clear();
+    for (std::string_view token = reader.token(); !token.empty(); token = reader.token()) {
+        Corner corner{};
+        unsigned int relativeMask = 0;
+        if (!parse_corner(token, chunk, corner, relativeMask)) {
+            return false;
+        }
+        face.emplace_back(corner, relativeMask);
+    }
+    if (face.size() < 3) {
+        return false;
+    }
+    for (std::size_t last = 2; last < face.size(); ++last) {
+        for (const auto& [corner, relativeMask] : {face[0], face[last - 1], face[last]}) {
+            // Every copy of a corner the fan makes needs its own fix-up
+            for (std::size_t attribute = 0; attribute < cornerAttributes.size(); ++attribute) {
+                if (relativeMask & (1u << attribute)) {
+                    chunk.relativeIndices.emplace_back(chunk.corners.size(), cornerAttributes[attribute]);
+                }
+            }
+            chunk.corners.emplace_back(corner);
+        }
+    }
+    return true;
+}
+
+bool parse_line(std::string_view line, ObjChunk& chunk) {
+    if (!line.empty() && line.back() == '\r') {
+        line.remove_suffix(1);
+    }
+    // Line continuations are rare enough to leave to the fallback
+    if (!line.empty() && line.back() == '\\') {
+        return false;
+    }
+    LineReader reader(line);
+    const std::string_view keyword = reader.token();
+    if (keyword.empty() || keyword.front() == '#') {
+        return true;
+    }
+    if (keyword == "v") {
+        // Anything after xyz (w, or the vertex colours some exporters append) is ignored
+        const auto values = reader.numbers<3>();
+        if (values) {
+            chunk.positions.emplace_back((*values)[0], (*values)[1], (*values)[2]);
+        }
+        return values.has_value();
+    }
+    if (keyword == "vt") {
+        const auto u = reader.number();
+        // v is optional and defaults to 0; w is ignored
+        const auto v = reader.at_end() ? std::optional(0.0f) : reader.number();
+        if (u && v) {
+            chunk.texCoords.emplace_back(*u, *v);
+        }
+        return u && v;
+    }
+    if (keyword == "vn") {
+        const auto values = reader.numbers<3>();
+        if (values) {
+            chunk.normals.emplace_back((*values)[0], (*values)[1], (*values)[2]);
+        }
+        return values && reader.at_end();
+    }
+    if (keyword == "f") {
+        return parse_face(reader, chunk);
+    }
+    // Grouping, smoothing and materials do not change the geometry
+    return keyword == "o" || keyword == "g" || keyword == "s" || keyword == "usemtl" || keyword == "mtllib";
+}
+
+void parse_chunk(std::string_view data, ObjChunk& chunk) {
+    // A guess from typical line lengths, to save most of the regrowth
+    chunk.corners.reserve(data.size() / 32);
+    while (!data.empty()) {
+        const void* newline = std::memchr(data.data(), '\n', data.size());
+        const std::size_t length =
+            newline ? static_cast<std::size_t>(static_cast<const char*>(newline) - data.data()) : data.size();
+        if (!parse_line(data.substr(0, length), chunk)) {
+            chunk.failed = true;
+            return;
+        }
+        data.remove_prefix(std::min(length + 1, data.size()));
+    }
+}
+
+void find_unique_corners(ObjChunk& chunk) {
+    CornerTable table(chunk.corners.size());
+    chunk.cornerIds.reserve(chunk.corners.size());
+    for (const Corner& corner : chunk.corners) {
+        const auto nextId = static_cast<std::uint32_t>(chunk.uniqueCorners.size());
+        const std::uint32_t id = table.insert(corner, nextId);
+        if (id == nextId) {
+            chunk.uniqueCorners.emplace_back(corner);
+        }
+        chunk.cornerIds.emplace_back(id);
+    }
+}
+
+// Corners that came without a normal get the area-weighted average of the faces around them
+void generate_missing_normals(tel::Mesh& mesh, const std::vector<Corner>& vertices) {
+    std::vector<tel::Normal> accumulated(vertices.size(), tel::Normal{0.0f});
+    for (std::size_t triangle = 0; triangle + 2 < mesh.triangles.size(); triangle += 3) {
+        const auto indices = std::span(mesh.triangles).subspan(triangle, 3);
+        const tel::Normal faceNormal = glm::cross(mesh.positions[indices[1]] - mesh.positions[indices[0]],
+                                                  mesh.positions[indices[2]] - mesh.positions[indices[0]]);
+        for (const tel::TriangleIndex index : indices) {
+            accumulated[index] += faceNormal;
+        }
+    }
+    for (std::size_t vertex = 0; vertex < vertices.size(); ++vertex) {
+        if (vertices[vertex].normal == missingIndex && glm::dot(accumulated[vertex], accumulated[vertex]) > 0.0f) {
+            mesh.normals[vertex] = glm::normalize(accumulated[vertex]);
+        }
+    }
+}
+
+template <typename Func>
+void for_each_chunk(tel::ThreadPool* threadPool, std::size_t chunkCount, Func&& func) {
+    if (threadPool == nullptr) {
+        for (std::size_t chunk = 0; chunk < chunkCount; ++chunk) {
+            func(chunk);
+        }
+        return;
+    }
+    threadPool->parallel_for(chunkCount, 1, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t chunk = begin; chunk < end; ++chunk) {
+            func(chunk);
+        }
+    });
+}
+} // namespace
+
+bool tel::looks_like_obj(std::string_view data) {
+    std::string_view sample = data.substr(0, sniffBytes);
+    if (sample.find('\0') != std::string_view::npos) {
+        return false;
+    }
+    // A line cut off by the end of the sample could be a prefix of anything, so only whole lines are checked
+    if (sample.size() < data.size()) {
+        sample = sample.substr(0, sample.rfind('\n') + 1);
+    }
+    std::size_t recognised = 0;
+    for (const auto line : std::views::split(sample, '\n')) {
+        LineReader reader(std::string_view(line.begin(), line.end()));
+        const std::string_view keyword = reader.token();
+        if (!keyword.empty() && keyword.front() != '#') {
+            constexpr std::array<std::string_view, 12> keywords{"v", "vt", "vn", "vp", "f", "l",
+                                                                "p", "o",  "g",  "s",  "usemtl", "mtllib"};
+            if (!std::ranges::contains(keywords, keyword)) {
+                return false;
+            }
+            ++recognised;
+        }
+    }
+    return recognised > 0;
+}
+
+std::expected<tel::Mesh, tel::MeshLoadError> tel::load_obj_from_memory(std::string_view data, ThreadPool* threadPool) {
+    const std::size_t maxChunks = threadPool ? (threadPool->thread_count() + 1) * chunksPerThread : 1;
+    const auto pieces = split_into_chunks(data, std::clamp<std::size_t>(data.size() / minChunkBytes, 1, maxChunks));
+    std::vector<ObjChunk> chunks(pieces.size());
+    for_each_chunk(threadPool, chunks.size(), [&](std::size_t chunk) { parse_chunk(pieces[chunk], chunks[chunk]); });
+    if (std::ranges::any_of(chunks, &ObjChunk::failed)) {
+        return std::unexpected(MeshLoadError{});
+    }
+
+    // Where each chunk's attributes start in the whole file
+    struct Offsets {
+        std::size_t positions = 0;
+        std::size_t texCoords = 0;
+        std::size_t normals = 0;
+        std::size_t corners = 0;
+    };
+    std::vector<Offsets> offsets(chunks.size() + 1);
+    for (std::size_t chunk = 0; chunk < chunks.size(); ++chunk) {
+        offsets[chunk + 1] = {.positions = offsets[chunk].positions + chunks[chunk].positions.size(),
+                              .texCoords = offsets[chunk].texCoords + chunks[chunk].texCoords.size(),
+                              .normals = offsets[chunk].normals + chunks[chunk].normals.size(),
+                              .corners = offsets[chunk].corners + chunks[chunk].corners.size()};
+    }
+    const Offsets& totals = offsets.back();
+    if (std::max({totals.positions, totals.texCoords, totals.normals, totals.corners}) >= missingIndex) {
+        return std::unexpected(MeshLoadError{});
+    }
+
+    std::vector<Position> positions(totals.positions);
+    std::vector<TexCoord> texCoords(totals.texCoords);
+    std::vector<Normal> normals(totals.normals);
+    for_each_chunk(threadPool, chunks.size(), [&](std::size_t index) {
+        ObjChunk& chunk = chunks[index];
+        const Offsets& offset = offsets[index];
+        std::ranges::copy(chunk.positions, positions.begin() + static_cast<std::ptrdiff_t>(offset.positions));
+        std::ranges::copy(chunk.texCoords, texCoords.begin() + static_cast<std::ptrdiff_t>(offset.texCoords));
+        std::ranges::copy(chunk.normals, normals.begin() + static_cast<std::ptrdiff_t>(offset.normals));
+        for (const auto& [corner, attribute] : chunk.relativeIndices) {
+            const std::size_t base = attribute == &Corner::position   ? offset.positions
+                                     : attribute == &Corner::texCoord ? offset.texCoords
+                                                                      : offset.normals;
+            chunk.corners[corner].*attribute += static_cast<std::uint32_t>(base);
+        }
+        chunk.failed = !std::ranges::all_of(chunk.corners, [&](const Corner& corner) {
+            return corner.position < totals.positions &&
+                   (corner.texCoord == missingIndex || corner.texCoord < totals.texCoords) &&
+                   (corner.normal == missingIndex || corner.normal < totals.normals);
+        });
+        if (!chunk.failed) {
+            find_unique_corners(chunk);
+        }
+    });
+    if (std::ranges::any_of(chunks, &ObjChunk::failed)) {
+        return std::unexpected(MeshLoadError{});
+    }
+
+    // Corners shared across chunk boundaries are only merged here, over the far smaller per-chunk unique sets
+    std::size_t maxVertices = 0;
+    for (const ObjChunk& chunk : chunks) {
+        maxVertices += chunk.uniqueCorners.size();
+    }
+    CornerTable table(maxVertices);
+    std::vector<Corner> vertices;
+    vertices.reserve(maxVertices);
+    for (ObjChunk& chunk : chunks) {
+        chunk.vertexIds.reserve(chunk.uniqueCorners.size());
+        for (const Corner& corner : chunk.uniqueCorners) {
+            const auto nextId = static_cast<std::uint32_t>(vertices.size());
+            const std::uint32_t id = table.insert(corner, nextId);
+            if (id == nextId) {
+                vertices.emplace_back(corner);
+            }
+            chunk.vertexIds.emplace_back(id);
+        }
+    }
+
+    Mesh mesh;
+    mesh.positions.resize(vertices.size());
+    mesh.normals.resize(vertices.size());
+    mesh.texCoords.resize(vertices.size());
+    mesh.triangles.resize(totals.corners);
+    for_each_chunk(threadPool, chunks.size(), [&](std::size_t index) {
+        const ObjChunk& chunk = chunks[index];
+        auto output = mesh.triangles.begin() + static_cast<std::ptrdiff_t>(offsets[index].corners);
+        std::ranges::transform(chunk.cornerIds, output, [&](std::uint32_t id) { return chunk.vertexIds[id]; });
+    });
+    const std::size_t verticesPerChunk = std::max<std::size_t>(vertices.size() / maxChunks, 1);
+    const auto fill_vertices = [&](std::size_t begin, std::size_t end) {
+        for (std::size_t vertex = begin; vertex < end; ++vertex) {
+            const Corner& corner = vertices[vertex];
+            mesh.positions[vertex] = positions[corner.position];
+            mesh.texCoords[vertex] = corner.texCoord == missingIndex ? TexCoord{0.0f} : texCoords[corner.texCoord];
+            mesh.normals[vertex] = corner.normal == missingIndex ? Normal{0.0f} : normals[corner.normal];
+        }
+    };
+    if (threadPool) {
+        threadPool->parallel_for(vertices.size(), verticesPerChunk, fill_vertices);
+    } else {
+        fill_vertices(0, vertices.size());
+    }
+    if (std::ranges::any_of(vertices, [](const Corner& corner) { return corner.normal == missingIndex; })) {
+        generate_missing_normals(mesh, vertices);
+    }
+    return mesh;
+}
@@ -0,0 +1,332 @@
+#include "OcclusionCulling.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cmath>
+#include <glm/vec4.hpp>
+#include <limits>
+#include <ranges>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define HAZOR_OCCLUSION_AVX2 1
+#include <immintrin.h>
+#else
+#define HAZOR_OCCLUSION_AVX2 0
+#endif
+
+namespace {
+constexpr int rowsPerBand = 16;
+
+constexpr float nearPlaneEpsilon = 1e-5f;
+
+void rasterize_scalar(const tel::OccluderTriangle& triangle, float* buffer, int stride, int beginRow, int endRow) {
+    for (int y = std::max(triangle.minY, beginRow); y < std::min(triangle.maxY + 1, endRow); ++y) {
+        const float py = static_cast<float>(y) + 0.5f;
+        float* row = buffer + static_cast<std::ptrdiff_t>(y) * stride;
+        for (int x = triangle.minX; x <= triangle.maxX; ++x) {
+            const float px = static_cast<float>(x) + 0.5f;
+            float weights[3];
+            bool inside = true;
+            for (int i = 0; i < 3; ++i) {
+                weights[i] = triangle.edgeA[i] * px + triangle.edgeB[i] * py + triangle.edgeC[i];
+                inside &= weights[i] >= 0.0f;
+            }
+            if (!inside) {
+                continue;
+            }
+            const float depth = (weights[0] * triangle.depth[0] + weights[1] * triangle.depth[1] +
+                                 weights[2] * triangle.depth[2]) *
+                                triangle.inverseArea;
+            row[x] = std::min(row[x], depth);
+        }
+    }
+}
+
+#if HAZOR_OCCLUSION_AVX2
+__attribute__((target("avx2,fma"))) void rasterize_avx2(const tel::OccluderTriangle& triangle, float* buffer,
+                                                         int stride, int beginRow, int endRow) {
+    const __m256 laneOffsets = _mm256_setr_ps(0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 inverseArea = _mm256_set1_ps(triangle.inverseArea);
+    __m256 edgeA[3];
+    __m256 depth[3];
+    for (int i = 0; i < 3; ++i) {
+        edgeA[i] = _mm256_set1_ps(triangle.edgeA[i]);
+        depth[i] = _mm256_set1_ps(triangle.depth[i]);
+    }
+    // Starting on a multiple of 8 keeps every 8-wide span inside the padded row
+    const int firstColumn = triangle.minX & ~7;
+    for (int y = std::max(triangle.minY, beginRow); y < std::min(triangle.maxY + 1, endRow); ++y) {
+        const float py = static_cast<float>(y) + 0.5f;
+        float* row = buffer + static_cast<std::ptrdiff_t>(y) * stride;
+        __m256 rowConstant[3];
+        for (int i = 0; i < 3; ++i) {
+            rowConstant[i] = _mm256_set1_ps(triangle.edgeB[i] * py + triangle.edgeC[i]);
+        }
+        for (int x = firstColumn; x <= triangle.maxX; x += 8) {
+            const __m256 px = _mm256_add_ps(_mm256_set1_ps(static_cast<float>(x)), laneOffsets);
+            const __m256 weight0 = _mm256_fmadd_ps(edgeA[0], px, rowConstant[0]);
+            const __m256 weight1 = _mm256_fmadd_ps(edgeA[1], px, rowConstant[1]);
+            const __m256 weight2 = _mm256_fmadd_ps(edgeA[2], px, rowConstant[2]);
+            const __m256 inside = _mm256_and_ps(_mm256_and_ps(_mm256_cmp_ps(weight0, zero, _CMP_GE_OQ),
+                                                              _mm256_cmp_ps(weight1, zero, _CMP_GE_OQ)),
+                                                _mm256_cmp_ps(weight2, zero, _CMP_GE_OQ));
+            if (_mm256_movemask_ps(inside) == 0) {
+                continue;
+            }
+            const __m256 weighted = _mm256_fmadd_ps(
+                weight0, depth[0], _mm256_fmadd_ps(weight1, depth[1], _mm256_mul_ps(weight2, depth[2])));
+            const __m256 interpolated = _mm256_mul_ps(weighted, inverseArea);
+            const __m256 previous = _mm256_loadu_ps(row + x);
+            _mm256_storeu_ps(row + x, _mm256_blendv_ps(previous, _mm256_min_ps(previous, interpolated), inside));
+        }
+    }
+}
+#endif
+
+bool cpu_supports_avx2() {
+#if HAZOR_OCCLUSION_AVX2
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#else
+    return false;
+#endif
+}
+
+float edge(const glm::vec3& a, const glm::vec3& b, const glm::vec3& p) {
+    return (b.x - a.x) * (p.y - a.y) - (b.y - a.y) * (p.x - a.x);
+}
+} // namespace
+
+tel::OcclusionCulling::OcclusionCulling(ThreadPool* threadPool, const OcclusionCullingOptions& options)
+    : threadPool(threadPool), cullingOptions(options), stride((options.width + 7) & ~7),
+      depthBuffer(static_cast<std::size_t>(stride) * options.height, 1.0f), useAvx2(cpu_supports_avx2()) {
+    build_pyramid();
+}
+
+tel::OccluderHandle tel::OcclusionCulling::add_occluder_mesh(const Mesh& mesh) {
+    return occluderMeshes.add(OccluderMesh{.positions = mesh.positions, .triangles = mesh.triangles});
+}
+
+void tel::OcclusionCulling::cull(std::span<const Occluder> occluders, const glm::mat4& viewProjection,
+                                 std::span<const OcclusionQuery> queries, std::span<std::uint8_t> visible) {
+    assert(visible.size() == queries.size());
+    if (!cullingOptions.enabled) {
+        std::ranges::fill(visible, 1);
+        return;
+    }
+    render_occluders(occluders, viewProjection);
+    threadPool->parallel_for(queries.size(), 256, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            visible[i] = is_visible(queries[i]);
+        }
+    });
+}
+
+void tel::OcclusionCulling::render_occluders(std::span<const Occluder> occluders, const glm::mat4& viewProjection) {
+    currentViewProjection = viewProjection;
+    setup_triangles(occluders, viewProjection);
+    // Each band of rows is owned by one task, so no two tasks ever write the same pixel
+    const auto height = static_cast<std::size_t>(cullingOptions.height);
+    threadPool->parallel_for(height, rowsPerBand, [&](std::size_t begin, std::size_t end) {
+        std::fill(depthBuffer.begin() + static_cast<std::ptrdiff_t>(begin * stride),
+                  depthBuffer.begin() + static_cast<std::ptrdiff_t>(end * stride), 1.0f);
+        rasterize_rows(static_cast<int>(begin), static_cast<int>(end));
+    });
+    build_pyramid();
+}
+
+void tel::OcclusionCulling::setup_triangles(std::span<const Occluder> occluders, const glm::mat4& viewProjection) {
+    frameMeshes.clear();
+    for (const Occluder& occluder : occluders) {
+        frameMeshes.emplace_back(occluderMeshes.find(occluder.mesh));
+    }
+    if (perOccluderTriangles.size() < occluders.size()) {
+        perOccluderTriangles.resize(occluders.size());
+    }
+    const auto width = static_cast<float>(cullingOptions.width);
+    const auto height = static_cast<float>(cullingOptions.height);
+    threadPool->parallel_for(occluders.size(), 1, [&](std::size_t begin, std::size_t end) {
+        thread_local std::vector<glm::vec4> clip;
+        for (std::size_t index = begin; index < end; ++index) {
+            auto& output = perOccluderTriangles[index];
+            output.clear();
+            const OccluderMesh* mesh = frameMeshes[index];
+            if (mesh == nullptr) {
+                continue;
+            }
+            const glm::mat4 transform = viewProjection * occluders[index].transform;
+            clip.clear();
+            for (const Position& position : mesh->positions) {
+                clip.emplace_back(transform * glm::vec4(position, 1.0f));
+            }
+            for (std::size_t first = 0; first + 2 < mesh->triangles.size(); first += 3) {
+                glm::vec3 screen[3];
+                bool crossesNearPlane = false;
+                for (int corner = 0; corner < 3; ++corner) {
+                    const glm::vec4& vertex = clip[mesh->triangles[first + corner]];
+                    // In front of the near plane the GPU draws nothing, but the depth would come out negative and
+                    // hide everything; dropping the triangle instead only makes the culling more conservative
+                    crossesNearPlane |= vertex.w <= nearPlaneEpsilon || vertex.z < -vertex.w;
+                    screen[corner] = glm::vec3((vertex.x / vertex.w * 0.5f + 0.5f) * width,
+                                               (vertex.y / vertex.w * 0.5f + 0.5f) * height,
+                                               vertex.z / vertex.w * 0.5f + 0.5f);
+                }
+                if (crossesNearPlane) {
+                    continue;
+                }
+                float area = edge(screen[0], screen[1], screen[2]);
+                if (area == 0.0f) {
+                    continue;
+                }
+                // Occluders are rasterized two-sided, so flip clockwise triangles instead of culling them
+                if (area < 0.0f) {
+                    std::swap(screen[1], screen[2]);
+                    area = -area;
+                }
+                OccluderTriangle triangle{};
+                for (int i = 0; i < 3; ++i) {
+                    const glm::vec3& from = screen[(i + 1) % 3];
+                    const glm::vec3& to = screen[(i + 2) % 3];
+                    triangle.edgeA[i] = from.y - to.y;
+                    triangle.edgeB[i] = to.x - from.x;
+                    triangle.edgeC[i] = -(triangle.edgeA[i] * from.x + triangle.edgeB[i] * from.y);
+                    triangle.depth[i] = screen[i].z;
+                }
+                triangle.inverseArea = 1.0f / area;
+                const auto [minX, maxX] = std::minmax({screen[0].x, screen[1].x, screen[2].x});
+                const auto [minY, maxY] = std::minmax({screen[0].y, screen[1].y, screen[2].y});
+                triangle.minX = std::max(static_cast<int>(std::floor(minX)), 0);
+                triangle.maxX = std::min(static_cast<int>(std::ceil(maxX)), cullingOptions.width - 1);
+                triangle.minY = std::max(static_cast<int>(std::floor(minY)), 0);
+                triangle.maxY = std::min(static_cast<int>(std::ceil(maxY)), cullingOptions.height - 1);
+                const float nearestDepth = std::min({screen[0].z, screen[1].z, screen[2].z});
+                if (triangle.minX > triangle.maxX || triangle.minY > triangle.maxY || nearestDepth > 1.0f) {
+                    continue;
+                }
+                output.emplace_back(triangle);
+            }
+        }
+    });
+    triangles.clear();
+    for (const auto& output : perOccluderTriangles | std::views::take(occluders.size())) {
+        triangles.append_range(output);
+    }
+}
+
+void tel::OcclusionCulling::rasterize_rows(int beginRow, int endRow) {
+    for (const OccluderTriangle& triangle : triangles) {
+        if (triangle.maxY < beginRow || triangle.minY >= endRow) {
+            continue;
+        }
+#if HAZOR_OCCLUSION_AVX2
+        if (useAvx2) {
+            rasterize_avx2(triangle, depthBuffer.data(), stride, beginRow, endRow);
+            continue;
+        }
+#endif
+        rasterize_scalar(triangle, depthBuffer.data(), stride, beginRow, endRow);
+    }
+}
+
+void tel::OcclusionCulling::build_pyramid() {
+    // Levels are kept between frames and only resized, so a pyramid of the same size allocates nothing
+    if (pyramid.empty()) {
+        pyramid.emplace_back();
+    }
+    DepthLevel& base = pyramid.front();
+    base.width = cullingOptions.width;
+    base.height = cullingOptions.height;
+    base.depth.resize(static_cast<std::size_t>(base.width) * base.height);
+    for (int y = 0; y < base.height; ++y) {
+        std::copy_n(depthBuffer.begin() + static_cast<std::ptrdiff_t>(y) * stride, base.width,
+                    base.depth.begin() + static_cast<std::ptrdiff_t>(y) * base.width);
+    }
+    base.nearest = base.depth;
+    // Each texel keeps the farthest occluder depth below it, so "nearer than this texel" is a conservative test, and
+    // the nearest, so "nearer than that" means nothing below it can hide the object
+    std::size_t level = 0;
+    for (; pyramid[level].width > 1 || pyramid[level].height > 1; ++level) {
+        if (level + 1 == pyramid.size()) {
+            pyramid.emplace_back();
+        }
+        const DepthLevel& previous = pyramid[level];
+        DepthLevel& next = pyramid[level + 1];
+        next.width = (previous.width + 1) / 2;
+        next.height = (previous.height + 1) / 2;
+        next.depth.resize(static_cast<std::size_t>(next.width) * next.height);
+        next.nearest.resize(next.depth.size());
+        const auto sample = [&](const std::vector<float>& depth, int x, int y) {
+            return depth[static_cast<std::size_t>(std::min(y, previous.height - 1)) * previous.width +
+                         std::min(x, previous.width - 1)];
+        };
+        for (int y = 0; y < next.height; ++y) {
+            for (int x = 0; x < next.width; ++x) {
+                const std::size_t texel = static_cast<std::size_t>(y) * next.width + x;
+                next.depth[texel] = std::max({sample(previous.depth, 2 * x, 2 * y),
+                                              sample(previous.depth, 2 * x + 1, 2 * y),
+                                              sample(previous.depth, 2 * x, 2 * y + 1),
+                                              sample(previous.depth, 2 * x + 1, 2 * y + 1)});
+                next.nearest[texel] = std::min({sample(previous.nearest, 2 * x, 2 * y),
+                                                sample(previous.nearest, 2 * x + 1, 2 * y),
+                                                sample(previous.nearest, 2 * x, 2 * y + 1),
+                                                sample(previous.nearest, 2 * x + 1, 2 * y + 1)});
+            }
+        }
+    }
+    pyramid.resize(level + 1);
+}
+
+bool tel::OcclusionCulling::is_visible(const OcclusionQuery& query) const {
+    const glm::mat4 transform = currentViewProjection * query.transform;
+    glm::vec3 minimum(std::numeric_limits<float>::max());
+    glm::vec3 maximum(std::numeric_limits<float>::lowest());
+    for (int corner = 0; corner < 8; ++corner) {
+        const glm::vec3 local((corner & 1) ? query.bounds.max.x : query.bounds.min.x,
+                              (corner & 2) ? query.bounds.max.y : query.bounds.min.y,
+                              (corner & 4) ? query.bounds.max.z : query.bounds.min.z);
+        const glm::vec4 clip = transform * glm::vec4(local, 1.0f);
+        if (clip.w <= nearPlaneEpsilon) {
+            return true;
+        }
+        const glm::vec3 ndc = glm::vec3(clip) / clip.w;
+        minimum = glm::min(minimum, ndc);
+        maximum = glm::max(maximum, ndc);
+    }
+    if (maximum.x < -1.0f || minimum.x > 1.0f || maximum.y < -1.0f || minimum.y > 1.0f || minimum.z > 1.0f) {
+        return false;
+    }
+    const DepthLevel& base = pyramid.front();
+    const auto to_pixel = [](float ndc, int size) {
+        return std::clamp(static_cast<int>((ndc * 0.5f + 0.5f) * static_cast<float>(size)), 0, size - 1);
+    };
+    const int minX = to_pixel(minimum.x, base.width);
+    const int maxX = to_pixel(maximum.x, base.width);
+    const int minY = to_pixel(minimum.y, base.height);
+    const int maxY = to_pixel(maximum.y, base.height);
+    const float nearestDepth = minimum.z * 0.5f + 0.5f;
+
+    // Pick the level at which the rectangle spans at most a few texels
+    const auto extent = static_cast<unsigned int>(std::max(maxX - minX, maxY - minY));
+    const int top = static_cast<int>(pyramid.size()) - 1;
+    const int level = std::clamp(static_cast<int>(std::bit_width(extent)) - 1, 0, top);
+    // A level up, the rectangle covers a texel or two, and being nearer than everything in one of them settles it
+    const int coarse = std::min(level + 1, top);
+    const DepthLevel& coarseLevel = pyramid[coarse];
+    for (int y = minY >> coarse; y <= std::min(maxY >> coarse, coarseLevel.height - 1); ++y) {
+        for (int x = minX >> coarse; x <= std::min(maxX >> coarse, coarseLevel.width - 1); ++x) {
+            if (nearestDepth <= coarseLevel.nearest[static_cast<std::size_t>(y) * coarseLevel.width + x]) {
+                return true;
+            }
+        }
+    }
+    const DepthLevel& depthLevel = pyramid[level];
+    for (int y = minY >> level; y <= std::min(maxY >> level, depthLevel.height - 1); ++y) {
+        for (int x = minX >> level; x <= std::min(maxX >> level, depthLevel.width - 1); ++x) {
+            if (nearestDepth <= depthLevel.depth[static_cast<std::size_t>(y) * depthLevel.width + x]) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
@@ -0,0 +1,256 @@
+#include "Particles.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <ranges>
+#include <tuple>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define HAZOR_PARTICLES_AVX2 1
+#include <immintrin.h>
+#else
+#define HAZOR_PARTICLES_AVX2 0
+#endif
+
+namespace {
+constexpr std::size_t lanes = 8;
+
+// In blocks of 8 particles; integrating a block is a handful of instructions, so tasks need plenty of them
+constexpr std::size_t blocksPerTask = 2048;
+
+constexpr std::size_t particlesPerTask = 16384;
+
+bool cpu_supports_avx2() {
+#if HAZOR_PARTICLES_AVX2
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#else
+    return false;
+#endif
+}
+
+// xorshift32, uniform in [-1, 1)
+float next_signed(std::uint32_t& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return static_cast<float>(state >> 8) * 0x1p-23f - 1.0f;
+}
+
+glm::vec3 next_signed_vector(std::uint32_t& state) {
+    const float x = next_signed(state);
+    const float y = next_signed(state);
+    const float z = next_signed(state);
+    return {x, y, z};
+}
+
+// Colours are clamped and scaled once per emitter, so any mix of the two ends is already in byte range
+glm::vec4 to_byte_range(const glm::vec4& color) {
+    return glm::clamp(color, 0.0f, 1.0f) * 255.0f + 0.5f;
+}
+
+std::uint32_t pack_color(const glm::vec4& color) {
+    return static_cast<std::uint32_t>(color.x) | static_cast<std::uint32_t>(color.y) << 8 |
+           static_cast<std::uint32_t>(color.z) << 16 | static_cast<std::uint32_t>(color.w) << 24;
+}
+
+// Positions, velocities, ages and lifetimes
+using StreamPointers = std::array<float*, 8>;
+
+struct Integration {
+    float deltaSeconds;
+    // Velocity is scaled by this after acceleration is added
+    float dragFactor;
+    glm::vec3 acceleration;
+};
+
+void integrate_scalar(StreamPointers streams, std::size_t begin, std::size_t end, const Integration& step) {
+    auto [positionX, positionY, positionZ, velocityX, velocityY, velocityZ, age, lifetime] = streams;
+    for (std::size_t i = begin; i < end; ++i) {
+        velocityX[i] = (velocityX[i] + step.acceleration.x * step.deltaSeconds) * step.dragFactor;
+        velocityY[i] = (velocityY[i] + step.acceleration.y * step.deltaSeconds) * step.dragFactor;
+        velocityZ[i] = (velocityZ[i] + step.acceleration.z * step.deltaSeconds) * step.dragFactor;
+        positionX[i] += velocityX[i] * step.deltaSeconds;
+        positionY[i] += velocityY[i] * step.deltaSeconds;
+        positionZ[i] += velocityZ[i] * step.deltaSeconds;
+        age[i] += step.deltaSeconds;
+    }
+}
+
+bool any_dead_scalar(const float* age, const float* lifetime, std::size_t begin) {
+    bool dead = false;
+    for (std::size_t i = begin; i < begin + lanes; ++i) {
+        dead |= age[i] >= lifetime[i];
+    }
+    return dead;
+}
+
+#if HAZOR_PARTICLES_AVX2
+__attribute__((target("avx2,fma"))) void integrate_avx2(StreamPointers streams, std::size_t begin,
+                                                         std::size_t end, const Integration& step) {
+    const __m256 delta = _mm256_set1_ps(step.deltaSeconds);
+    const __m256 drag = _mm256_set1_ps(step.dragFactor);
+    const __m256 acceleration[3] = {_mm256_set1_ps(step.acceleration.x * step.deltaSeconds),
+                                    _mm256_set1_ps(step.acceleration.y * step.deltaSeconds),
+                                    _mm256_set1_ps(step.acceleration.z * step.deltaSeconds)};
+    float* age = streams[6];
+    for (std::size_t i = begin; i < end; i += lanes) {
+        for (std::size_t axis = 0; axis < 3; ++axis) {
+            float* position = streams[axis];
+            float* velocity = streams[3 + axis];
+            const __m256 v = _mm256_mul_ps(_mm256_add_ps(_mm256_loadu_ps(velocity + i), acceleration[axis]), drag);
+            _mm256_storeu_ps(velocity + i, v);
+            _mm256_storeu_ps(position + i, _mm256_fmadd_ps(v, delta, _mm256_loadu_ps(position + i)));
+        }
+        _mm256_storeu_ps(age + i, _mm256_add_ps(_mm256_loadu_ps(age + i), delta));
+    }
+}
+
+__attribute__((target("avx2,fma"))) bool any_dead_avx2(const float* age, const float* lifetime, std::size_t begin) {
+    const __m256 dead = _mm256_cmp_ps(_mm256_loadu_ps(age + begin), _mm256_loadu_ps(lifetime + begin), _CMP_GE_OQ);
+    return _mm256_movemask_ps(dead) != 0;
+}
+#endif
+} // namespace
+
+tel::ParticleSystem::ParticleSystem(ThreadPool* threadPool) : threadPool(threadPool), useAvx2(cpu_supports_avx2()) {}
+
+tel::ParticleEmitterHandle tel::ParticleSystem::create_emitter(const ParticleEmitterSettings& settings) {
+    // Padded so whole blocks of 8 can always be loaded and stored
+    const std::size_t capacity = (settings.maxParticles + lanes - 1) / lanes * lanes;
+    Emitter emitter{.settings = settings, .capacity = capacity, .streams = {}, .random = std::max(settings.seed, 1u)};
+    for (auto& stream : emitter.streams) {
+        stream.resize(capacity);
+    }
+    return emitters.add(std::move(emitter));
+}
+
+void tel::ParticleSystem::remove_emitter(ParticleEmitterHandle emitter) { emitters.remove(emitter); }
+
+tel::ParticleEmitterSettings& tel::ParticleSystem::settings(ParticleEmitterHandle emitter) {
+    Emitter* found = emitters.find(emitter);
+    assert(found);
+    return found->settings;
+}
+
+void tel::ParticleSystem::update(float deltaSeconds) {
+    frameBatches.clear();
+    frameEmitters.clear();
+    liveParticles = 0;
+    for (auto& [handle, emitter] : emitters) {
+        integrate(emitter, deltaSeconds);
+        kill(emitter);
+        spawn(emitter, deltaSeconds);
+        if (emitter.count == 0) {
+            continue;
+        }
+        frameBatches.push_back(ParticleBatch{.shader = emitter.settings.shader,
+                                             .additive = emitter.settings.additive,
+                                             .first = liveParticles,
+                                             .count = emitter.count});
+        frameEmitters.push_back(&emitter);
+        liveParticles += emitter.count;
+    }
+}
+
+void tel::ParticleSystem::write_instances(std::span<ParticleInstance> instances) {
+    assert(instances.size() >= liveParticles);
+    for (const auto& [batch, emitter] : std::views::zip(frameBatches, frameEmitters)) {
+        const ParticleEmitterSettings& settings = emitter->settings;
+        const auto& streams = emitter->streams;
+        const float sizeChange = settings.endSize - settings.startSize;
+        const glm::vec4 startColor = to_byte_range(settings.startColor);
+        const glm::vec4 colorChange = to_byte_range(settings.endColor) - startColor;
+        ParticleInstance* out = instances.data() + batch.first;
+        threadPool->parallel_for(batch.count, particlesPerTask, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i) {
+                const float progress = std::min(streams[Age][i] / streams[Lifetime][i], 1.0f);
+                out[i] = ParticleInstance{
+                    .position = glm::vec3(streams[PositionX][i], streams[PositionY][i], streams[PositionZ][i]),
+                    .size = settings.startSize + sizeChange * progress,
+                    .color = pack_color(startColor + colorChange * progress)};
+            }
+        });
+    }
+}
+
+void tel::ParticleSystem::integrate(Emitter& emitter, float deltaSeconds) {
+    const Integration step{.deltaSeconds = deltaSeconds,
+                           .dragFactor = std::max(1.0f - emitter.settings.drag * deltaSeconds, 0.0f),
+                           .acceleration = emitter.settings.acceleration};
+    static_assert(StreamCount == std::tuple_size_v<StreamPointers>);
+    StreamPointers streams{};
+    std::ranges::transform(emitter.streams, streams.begin(), [](std::vector<float>& stream) { return stream.data(); });
+    // Whole blocks, so the last one runs over the padding rather than needing a tail loop
+    const std::size_t blocks = (emitter.count + lanes - 1) / lanes;
+    threadPool->parallel_for(blocks, blocksPerTask, [&](std::size_t beginBlock, std::size_t endBlock) {
+#if HAZOR_PARTICLES_AVX2
+        if (useAvx2) {
+            integrate_avx2(streams, beginBlock * lanes, endBlock * lanes, step);
+            return;
+        }
+#endif
+        integrate_scalar(streams, beginBlock * lanes, endBlock * lanes, step);
+    });
+}
+
+void tel::ParticleSystem::kill(Emitter& emitter) {
+    const float* age = emitter.streams[Age].data();
+    const float* lifetime = emitter.streams[Lifetime].data();
+    const auto any_dead = [&](std::size_t begin) {
+#if HAZOR_PARTICLES_AVX2
+        if (useAvx2) {
+            return any_dead_avx2(age, lifetime, begin);
+        }
+#endif
+        return any_dead_scalar(age, lifetime, begin);
+    };
+    std::size_t count = emitter.count;
+    std::size_t i = 0;
+    while (i < count) {
+        // Most blocks have no dead particles, and those are skipped 8 at a time
+        if (i + lanes <= count && !any_dead(i)) {
+            i += lanes;
+            continue;
+        }
+        if (age[i] < lifetime[i]) {
+            ++i;
+            continue;
+        }
+        // The particle moved in has not been checked yet, so i stays
+        --count;
+        for (auto& stream : emitter.streams) {
+            stream[i] = stream[count];
+        }
+    }
+    emitter.count = count;
+}
+
+void tel::ParticleSystem::spawn(Emitter& emitter, float deltaSeconds) {
+    const ParticleEmitterSettings& settings = emitter.settings;
+    emitter.pendingSpawns += settings.rate * deltaSeconds;
+    const float whole = std::floor(emitter.pendingSpawns);
+    emitter.pendingSpawns -= whole;
+    const std::size_t limit = std::min(settings.maxParticles, emitter.capacity);
+    const std::size_t room = limit > emitter.count ? limit - emitter.count : 0;
+    const std::size_t spawned = std::min(static_cast<std::size_t>(whole), room);
+    auto& streams = emitter.streams;
+    std::uint32_t& random = emitter.random;
+    for (std::size_t n = 0; n < spawned; ++n) {
+        const std::size_t i = emitter.count + n;
+        const glm::vec3 velocity = settings.velocity + settings.velocitySpread * next_signed_vector(random);
+        // Spread over the update, so emission stays smooth at low frame rates rather than coming in bursts
+        const float age = deltaSeconds * (static_cast<float>(n) + 0.5f) / static_cast<float>(spawned);
+        const glm::vec3 position =
+            settings.position + settings.positionSpread * next_signed_vector(random) + velocity * age;
+        streams[PositionX][i] = position.x;
+        streams[PositionY][i] = position.y;
+        streams[PositionZ][i] = position.z;
+        streams[VelocityX][i] = velocity.x;
+        streams[VelocityY][i] = velocity.y;
+        streams[VelocityZ][i] = velocity.z;
+        streams[Age][i] = age;
+        streams[Lifetime][i] = std::max(settings.lifetime + settings.lifetimeSpread * next_signed(random), 1e-3f);
+    }
+    emitter.count += spawned;
+}
@@ -0,0 +1,548 @@
+#include "RayCasting.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <glm/geometric.hpp>
+#include <glm/mat3x3.hpp>
+#include <glm/matrix.hpp>
+#include <glm/vec4.hpp>
+#include <numeric>
+#include <ranges>
+#include <span>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define HAZOR_RAYCAST_AVX2 1
+#include <immintrin.h>
+#else
+#define HAZOR_RAYCAST_AVX2 0
+#endif
+
+namespace {
+constexpr std::size_t binCount = 16;
+
+constexpr std::uint32_t maxLeafSize = 8;
+
+// Deeper subtrees become leaves, which bounds the traversal stack
+constexpr int maxDepth = 48;
+
+constexpr std::size_t laneCount = 8;
+
+constexpr float noHit = std::numeric_limits<float>::infinity();
+
+tel::BoundingBox empty_bounds() {
+    return {.min = glm::vec3(std::numeric_limits<float>::max()),
+            .max = glm::vec3(std::numeric_limits<float>::lowest())};
+}
+
+void grow(tel::BoundingBox& bounds, const tel::BoundingBox& other) {
+    bounds.min = glm::min(bounds.min, other.min);
+    bounds.max = glm::max(bounds.max, other.max);
+}
+
+// Half the surface area, which is all the heuristic needs since only ratios matter
+float half_area(const tel::BoundingBox& bounds) {
+    const glm::vec3 extent = glm::max(bounds.max - bounds.min, glm::vec3(0.0f));
+    return extent.x * extent.y + extent.y * extent.z + extent.z * extent.x;
+}
+
+// Distance at which the ray enters the box, or noHit if it misses it before maxDistance
+float enter_box(const glm::vec3& min, const glm::vec3& max, const glm::vec3& origin, const glm::vec3& inverseDirection,
+                float maxDistance) {
+    const glm::vec3 toMin = (min - origin) * inverseDirection;
+    const glm::vec3 toMax = (max - origin) * inverseDirection;
+    const glm::vec3 near = glm::min(toMin, toMax);
+    const glm::vec3 far = glm::max(toMin, toMax);
+    const float enter = std::max({near.x, near.y, near.z, 0.0f});
+    const float exit = std::min({far.x, far.y, far.z, maxDistance});
+    return enter <= exit ? enter : noHit;
+}
+
+struct Split {
+    int axis;
+    std::size_t bin;
+    float cost;
+};
+
+struct BuildInput {
+    std::vector<tel::BoundingBox> bounds;
+    std::vector<glm::vec3> centroids;
+};
+
+std::size_t bin_of(const glm::vec3& centroid, const tel::BoundingBox& centroidBounds, int axis) {
+    const float extent = centroidBounds.max[axis] - centroidBounds.min[axis];
+    const auto bin = static_cast<std::size_t>(binCount * (centroid[axis] - centroidBounds.min[axis]) / extent);
+    return std::min(bin, binCount - 1);
+}
+
+// Costs relative to visiting one node. A leaf tests 8 triangles at a time, so each triangle costs far less than a
+// node; leaves of a few triangles are cheaper than splitting them further.
+constexpr float traversalCost = 1.0f;
+
+constexpr float triangleCost = 0.3f;
+
+// The cheapest split between bins over all three axes, as the triangle tests it would take weighted by area
+std::optional<Split> find_split(const BuildInput& input, std::span<const std::uint32_t> triangles,
+                                const tel::BoundingBox& centroidBounds) {
+    const glm::vec3 extent = centroidBounds.max - centroidBounds.min;
+    std::array<std::array<tel::BoundingBox, binCount>, 3> binBounds;
+    std::array<std::array<std::size_t, binCount>, 3> binTriangles{};
+    for (auto& axisBounds : binBounds) {
+        axisBounds.fill(empty_bounds());
+    }
+    // One pass bins every axis, which touches the triangles a third as often as binning each axis separately
+    for (const std::uint32_t triangle : triangles) {
+        for (int axis = 0; axis < 3; ++axis) {
+            if (extent[axis] > 0.0f) {
+                const std::size_t bin = bin_of(input.centroids[triangle], centroidBounds, axis);
+                grow(binBounds[axis][bin], input.bounds[triangle]);
+                ++binTriangles[axis][bin];
+            }
+        }
+    }
+
+    std::optional<Split> best;
+    for (int axis = 0; axis < 3; ++axis) {
+        if (extent[axis] <= 0.0f) {
+            continue;
+        }
+        // Sweep from the right first so the left-to-right sweep can price every split
+        std::array<float, binCount> rightCosts{};
+        tel::BoundingBox right = empty_bounds();
+        std::size_t rightCount = 0;
+        for (std::size_t bin = binCount - 1; bin > 0; --bin) {
+            grow(right, binBounds[axis][bin]);
+            rightCount += binTriangles[axis][bin];
+            rightCosts[bin] = rightCount > 0 ? half_area(right) * static_cast<float>(rightCount) : 0.0f;
+        }
+        tel::BoundingBox left = empty_bounds();
+        std::size_t leftCount = 0;
+        for (std::size_t bin = 1; bin < binCount; ++bin) {
+            grow(left, binBounds[axis][bin - 1]);
+            leftCount += binTriangles[axis][bin - 1];
+            if (leftCount == 0 || leftCount == triangles.size()) {
+                continue;
+            }
+            const float cost = half_area(left) * static_cast<float>(leftCount) + rightCosts[bin];
+            if (!best || cost < best->cost) {
+                best = Split{.axis = axis, .bin = bin, .cost = cost};
+            }
+        }
+    }
+    return best;
+}
+
+#if HAZOR_RAYCAST_AVX2
+__attribute__((target("avx2,fma"))) __m256 cross_component(__m256 a1, __m256 b2, __m256 a2, __m256 b1) {
+    return _mm256_fmsub_ps(a1, b2, _mm256_mul_ps(a2, b1));
+}
+
+__attribute__((target("avx2,fma"))) __m256 load_lanes(const std::vector<float>& stream, std::size_t begin) {
+    return _mm256_loadu_ps(stream.data() + begin);
+}
+#endif
+
+bool cpu_supports_avx2() {
+#if HAZOR_RAYCAST_AVX2
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#else
+    return false;
+#endif
+}
+
+struct LeafHit {
+    float distance = noHit;
+    std::size_t index = 0;
+    glm::vec2 barycentric{};
+};
+
+// Möller-Trumbore against triangles [first, first + count), keeping the closest hit nearer than hit.distance.
+// Triangles are two-sided.
+template <bool anyHit, typename Streams>
+bool intersect_leaf_scalar(const Streams& streams, std::size_t first, std::size_t count, const tel::Ray& ray,
+                           LeafHit& hit) {
+    bool found = false;
+    for (std::size_t i = first; i < first + count; ++i) {
+        const glm::vec3 corner(streams.corner[0][i], streams.corner[1][i], streams.corner[2][i]);
+        const glm::vec3 edge1(streams.edge1[0][i], streams.edge1[1][i], streams.edge1[2][i]);
+        const glm::vec3 edge2(streams.edge2[0][i], streams.edge2[1][i], streams.edge2[2][i]);
+        const glm::vec3 p = glm::cross(ray.direction, edge2);
+        const float determinant = glm::dot(edge1, p);
+        if (determinant == 0.0f) {
+            continue;
+        }
+        const float inverse = 1.0f / determinant;
+        const glm::vec3 toOrigin = ray.origin - corner;
+        const float u = glm::dot(toOrigin, p) * inverse;
+        if (u < 0.0f || u > 1.0f) {
+            continue;
+        }
+        const glm::vec3 q = glm::cross(toOrigin, edge1);
+        const float v = glm::dot(ray.direction, q) * inverse;
+        if (v < 0.0f || u + v > 1.0f) {
+            continue;
+        }
+        const float distance = glm::dot(edge2, q) * inverse;
+        if (distance < 0.0f || distance >= hit.distance) {
+            continue;
+        }
+        hit = LeafHit{.distance = distance, .index = i, .barycentric = {u, v}};
+        found = true;
+        if constexpr (anyHit) {
+            return true;
+        }
+    }
+    return found;
+}
+
+#if HAZOR_RAYCAST_AVX2
+// The same test 8 triangles at a time; lanes past count are masked off
+template <bool anyHit, typename Streams>
+__attribute__((target("avx2,fma"))) bool intersect_leaf_avx2(const Streams& streams, std::size_t first,
+                                                             std::size_t count, const tel::Ray& ray, LeafHit& hit) {
+    const __m256 directionX = _mm256_set1_ps(ray.direction.x);
+    const __m256 directionY = _mm256_set1_ps(ray.direction.y);
+    const __m256 directionZ = _mm256_set1_ps(ray.direction.z);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    bool found = false;
+    for (std::size_t begin = first; begin < first + count; begin += laneCount) {
+        const __m256 edge1X = load_lanes(streams.edge1[0], begin);
+        const __m256 edge1Y = load_lanes(streams.edge1[1], begin);
+        const __m256 edge1Z = load_lanes(streams.edge1[2], begin);
+        const __m256 edge2X = load_lanes(streams.edge2[0], begin);
+        const __m256 edge2Y = load_lanes(streams.edge2[1], begin);
+        const __m256 edge2Z = load_lanes(streams.edge2[2], begin);
+        const __m256 toOriginX = _mm256_sub_ps(_mm256_set1_ps(ray.origin.x), load_lanes(streams.corner[0], begin));
+        const __m256 toOriginY = _mm256_sub_ps(_mm256_set1_ps(ray.origin.y), load_lanes(streams.corner[1], begin));
+        const __m256 toOriginZ = _mm256_sub_ps(_mm256_set1_ps(ray.origin.z), load_lanes(streams.corner[2], begin));
+
+        const __m256 pX = cross_component(directionY, edge2Z, directionZ, edge2Y);
+        const __m256 pY = cross_component(directionZ, edge2X, directionX, edge2Z);
+        const __m256 pZ = cross_component(directionX, edge2Y, directionY, edge2X);
+        const __m256 determinant =
+            _mm256_fmadd_ps(edge1X, pX, _mm256_fmadd_ps(edge1Y, pY, _mm256_mul_ps(edge1Z, pZ)));
+        const __m256 inverse = _mm256_div_ps(one, determinant);
+        const __m256 u = _mm256_mul_ps(
+            _mm256_fmadd_ps(toOriginX, pX, _mm256_fmadd_ps(toOriginY, pY, _mm256_mul_ps(toOriginZ, pZ))), inverse);
+        const __m256 qX = cross_component(toOriginY, edge1Z, toOriginZ, edge1Y);
+        const __m256 qY = cross_component(toOriginZ, edge1X, toOriginX, edge1Z);
+        const __m256 qZ = cross_component(toOriginX, edge1Y, toOriginY, edge1X);
+        const __m256 v = _mm256_mul_ps(
+            _mm256_fmadd_ps(directionX, qX, _mm256_fmadd_ps(directionY, qY, _mm256_mul_ps(directionZ, qZ))), inverse);
+        const __m256 distance =
+            _mm256_mul_ps(_mm256_fmadd_ps(edge2X, qX, _mm256_fmadd_ps(edge2Y, qY, _mm256_mul_ps(edge2Z, qZ))), inverse);
+
+        const auto remaining = static_cast<int>(first + count - begin);
+        __m256 mask = _mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_set1_epi32(remaining), lanes));
+        mask = _mm256_and_ps(mask, _mm256_cmp_ps(determinant, zero, _CMP_NEQ_OQ));
+        mask = _mm256_and_ps(mask, _mm256_cmp_ps(u, zero, _CMP_GE_OQ));
+        mask = _mm256_and_ps(mask, _mm256_cmp_ps(v, zero, _CMP_GE_OQ));
+        mask = _mm256_and_ps(mask, _mm256_cmp_ps(_mm256_add_ps(u, v), one, _CMP_LE_OQ));
+        mask = _mm256_and_ps(mask, _mm256_cmp_ps(distance, zero, _CMP_GE_OQ));
+        mask = _mm256_and_ps(mask, _mm256_cmp_ps(distance, _mm256_set1_ps(hit.distance), _CMP_LT_OQ));
+        int hits = _mm256_movemask_ps(mask);
+        if (hits == 0) {
+            continue;
+        }
+        alignas(32) std::array<float, laneCount> distances;
+        alignas(32) std::array<float, laneCount> us;
+        alignas(32) std::array<float, laneCount> vs;
+        _mm256_store_ps(distances.data(), distance);
+        _mm256_store_ps(us.data(), u);
+        _mm256_store_ps(vs.data(), v);
+        for (; hits != 0; hits &= hits - 1) {
+            const int lane = std::countr_zero(static_cast<unsigned int>(hits));
+            if (distances[lane] < hit.distance) {
+                hit = LeafHit{.distance = distances[lane], .index = begin + lane, .barycentric = {us[lane], vs[lane]}};
+            }
+        }
+        found = true;
+        if constexpr (anyHit) {
+            return true;
+        }
+    }
+    return found;
+}
+#endif
+
+std::array<glm::vec3, 8> corners(const tel::BoundingBox& bounds) {
+    std::array<glm::vec3, 8> result;
+    for (int i = 0; i < 8; ++i) {
+        result[i] = {(i & 1) ? bounds.max.x : bounds.min.x, (i & 2) ? bounds.max.y : bounds.min.y,
+                     (i & 4) ? bounds.max.z : bounds.min.z};
+    }
+    return result;
+}
+
+tel::Ray to_object_space(const tel::Ray& ray, const glm::mat4& worldToObject) {
+    return tel::Ray{.origin = glm::vec3(worldToObject * glm::vec4(ray.origin, 1.0f)),
+                    .direction = glm::mat3(worldToObject) * ray.direction,
+                    .maxDistance = ray.maxDistance};
+}
+} // namespace
+
+tel::Ray tel::pick_ray(const Camera& camera, glm::vec2 pixel, glm::vec2 viewportSize) {
+    const glm::vec2 ndc(2.0f * pixel.x / viewportSize.x - 1.0f, 1.0f - 2.0f * pixel.y / viewportSize.y);
+    const glm::mat4 clipToWorld = glm::inverse(camera.matrix());
+    const glm::vec4 near = clipToWorld * glm::vec4(ndc, -1.0f, 1.0f);
+    const glm::vec4 far = clipToWorld * glm::vec4(ndc, 1.0f, 1.0f);
+    const glm::vec3 origin = glm::vec3(near) / near.w;
+    return Ray{.origin = origin, .direction = glm::normalize(glm::vec3(far) / far.w - origin)};
+}
+
+tel::MeshBvh tel::MeshBvh::build(const Mesh& mesh) {
+    MeshBvh bvh;
+    bvh.useAvx2 = cpu_supports_avx2();
+    bvh.meshBounds = compute_bounds(mesh);
+    const std::size_t triangleCount = mesh.triangles.size() / 3;
+    if (triangleCount == 0) {
+        return bvh;
+    }
+
+    BuildInput input;
+    input.bounds.reserve(triangleCount);
+    input.centroids.reserve(triangleCount);
+    for (std::size_t triangle = 0; triangle < triangleCount; ++triangle) {
+        BoundingBox bounds = empty_bounds();
+        for (std::size_t corner = 0; corner < 3; ++corner) {
+            const Position& position = mesh.positions[mesh.triangles[3 * triangle + corner]];
+            grow(bounds, {.min = position, .max = position});
+        }
+        input.bounds.emplace_back(bounds);
+        input.centroids.emplace_back(0.5f * (bounds.min + bounds.max));
+    }
+    std::vector<std::uint32_t> order(triangleCount);
+    std::iota(order.begin(), order.end(), 0u);
+
+    const auto make_node = [&](std::uint32_t first, std::uint32_t count) {
+        BoundingBox bounds = empty_bounds();
+        BoundingBox centroidBounds = empty_bounds();
+        for (const std::uint32_t triangle : std::span(order).subspan(first, count)) {
+            grow(bounds, input.bounds[triangle]);
+            grow(centroidBounds, {.min = input.centroids[triangle], .max = input.centroids[triangle]});
+        }
+        bvh.nodes.emplace_back(Node{.min = bounds.min, .leftOrFirst = first, .max = bounds.max, .count = count});
+        return std::pair(bounds, centroidBounds);
+    };
+
+    struct PendingNode {
+        std::uint32_t index;
+        int depth;
+        BoundingBox bounds;
+        BoundingBox centroidBounds;
+    };
+    bvh.nodes.reserve(2 * triangleCount);
+    const auto [rootBounds, rootCentroidBounds] = make_node(0, static_cast<std::uint32_t>(triangleCount));
+    std::vector<PendingNode> pending{{0, 0, rootBounds, rootCentroidBounds}};
+    while (!pending.empty()) {
+        const PendingNode current = pending.back();
+        pending.pop_back();
+        const Node node = bvh.nodes[current.index];
+        if (node.count <= 2 || current.depth >= maxDepth) {
+            continue;
+        }
+        const auto triangles = std::span(order).subspan(node.leftOrFirst, node.count);
+        const auto split = find_split(input, triangles, current.centroidBounds);
+        const float leafCost = triangleCost * static_cast<float>(node.count);
+        const bool splitPays =
+            split && traversalCost + triangleCost * split->cost / half_area(current.bounds) < leafCost;
+        if (!splitPays && node.count <= maxLeafSize) {
+            continue;
+        }
+
+        std::uint32_t leftCount = 0;
+        if (split) {
+            const auto middle = std::partition(triangles.begin(), triangles.end(), [&](std::uint32_t triangle) {
+                return bin_of(input.centroids[triangle], current.centroidBounds, split->axis) < split->bin;
+            });
+            leftCount = static_cast<std::uint32_t>(middle - triangles.begin());
+        } else {
+            // Every centroid is in the same place, so any halving is as good as another
+            leftCount = node.count / 2;
+        }
+
+        const auto leftIndex = static_cast<std::uint32_t>(bvh.nodes.size());
+        const auto [leftBounds, leftCentroids] = make_node(node.leftOrFirst, leftCount);
+        const auto [rightBounds, rightCentroids] = make_node(node.leftOrFirst + leftCount, node.count - leftCount);
+        bvh.nodes[current.index].leftOrFirst = leftIndex;
+        bvh.nodes[current.index].count = 0;
+        pending.emplace_back(leftIndex, current.depth + 1, leftBounds, leftCentroids);
+        pending.emplace_back(leftIndex + 1, current.depth + 1, rightBounds, rightCentroids);
+    }
+    bvh.nodes.shrink_to_fit();
+
+    for (auto* stream : {&bvh.triangles.corner, &bvh.triangles.edge1, &bvh.triangles.edge2}) {
+        for (auto& coordinate : *stream) {
+            coordinate.reserve(triangleCount + laneCount - 1);
+        }
+    }
+    for (const std::uint32_t triangle : order) {
+        const Position& corner = mesh.positions[mesh.triangles[3 * triangle]];
+        const glm::vec3 edge1 = mesh.positions[mesh.triangles[3 * triangle + 1]] - corner;
+        const glm::vec3 edge2 = mesh.positions[mesh.triangles[3 * triangle + 2]] - corner;
+        for (int axis = 0; axis < 3; ++axis) {
+            bvh.triangles.corner[axis].emplace_back(corner[axis]);
+            bvh.triangles.edge1[axis].emplace_back(edge1[axis]);
+            bvh.triangles.edge2[axis].emplace_back(edge2[axis]);
+        }
+    }
+    // Zeroed padding is a degenerate triangle, which no ray hits
+    for (auto* stream : {&bvh.triangles.corner, &bvh.triangles.edge1, &bvh.triangles.edge2}) {
+        for (auto& coordinate : *stream) {
+            coordinate.resize(triangleCount + laneCount - 1, 0.0f);
+        }
+    }
+    bvh.triangleIds = std::move(order);
+    return bvh;
+}
+
+std::optional<tel::MeshHit> tel::MeshBvh::closest_hit(const Ray& ray) const {
+    MeshHit hit{};
+    if (!traverse<false>(ray, hit)) {
+        return std::nullopt;
+    }
+    return hit;
+}
+
+bool tel::MeshBvh::any_hit(const Ray& ray) const {
+    MeshHit hit{};
+    return traverse<true>(ray, hit);
+}
+
+std::size_t tel::MeshBvh::size_in_bytes() const {
+    return nodes.size() * sizeof(Node) + 9 * triangles.corner[0].size() * sizeof(float) +
+           triangleIds.size() * sizeof(std::uint32_t);
+}
+
+std::size_t tel::MeshBvh::max_size_in_bytes(std::size_t triangleCount) {
+    if (triangleCount == 0) {
+        return 0;
+    }
+    return 2 * triangleCount * sizeof(Node) + 9 * (triangleCount + laneCount - 1) * sizeof(float) +
+           triangleCount * sizeof(std::uint32_t);
+}
+
+template <bool anyHit>
+bool tel::MeshBvh::traverse(const Ray& ray, MeshHit& hit) const {
+    if (nodes.empty()) {
+        return false;
+    }
+    const glm::vec3 inverseDirection = 1.0f / ray.direction;
+    LeafHit closest{.distance = ray.maxDistance};
+    bool found = false;
+
+    struct Entry {
+        std::uint32_t node;
+        float distance;
+    };
+    std::array<Entry, maxDepth + 1> stack;
+    std::size_t stackSize = 0;
+    float rootDistance = enter_box(nodes[0].min, nodes[0].max, ray.origin, inverseDirection, closest.distance);
+    if (rootDistance == noHit) {
+        return false;
+    }
+    stack[stackSize++] = {0, rootDistance};
+
+    while (stackSize > 0) {
+        const Entry entry = stack[--stackSize];
+        // A hit found since the node was pushed may already be closer than the node
+        if (entry.distance > closest.distance) {
+            continue;
+        }
+        const Node* node = &nodes[entry.node];
+        while (node->count == 0) {
+            const Node* left = &nodes[node->leftOrFirst];
+            const Node* right = left + 1;
+            float leftDistance = enter_box(left->min, left->max, ray.origin, inverseDirection, closest.distance);
+            float rightDistance = enter_box(right->min, right->max, ray.origin, inverseDirection, closest.distance);
+            if (rightDistance < leftDistance) {
+                std::swap(left, right);
+                std::swap(leftDistance, rightDistance);
+            }
+            if (leftDistance == noHit) {
+                node = nullptr;
+                break;
+            }
+            if (rightDistance != noHit) {
+                assert(stackSize < stack.size());
+                stack[stackSize++] = {static_cast<std::uint32_t>(right - nodes.data()), rightDistance};
+            }
+            node = left;
+        }
+        if (node == nullptr) {
+            continue;
+        }
+        const std::size_t first = node->leftOrFirst;
+#if HAZOR_RAYCAST_AVX2
+        const bool leafHit = useAvx2 ? intersect_leaf_avx2<anyHit>(triangles, first, node->count, ray, closest)
+                                     : intersect_leaf_scalar<anyHit>(triangles, first, node->count, ray, closest);
+#else
+        const bool leafHit = intersect_leaf_scalar<anyHit>(triangles, first, node->count, ray, closest);
+#endif
+        if (leafHit) {
+            found = true;
+            if constexpr (anyHit) {
+                break;
+            }
+        }
+    }
+    if (found) {
+        hit = MeshHit{.distance = closest.distance,
+                      .triangle = triangleIds[closest.index],
+                      .barycentric = closest.barycentric};
+    }
+    return found;
+}
+
+void tel::RaycastScene::add(const SceneObject& object, std::shared_ptr<const MeshBvh> bvh, std::size_t index,
+                            bool streamed) {
+    BoundingBox worldBounds = empty_bounds();
+    for (const glm::vec3& corner : corners(bvh->bounds())) {
+        const glm::vec3 world(object.transform * glm::vec4(corner, 1.0f));
+        grow(worldBounds, {.min = world, .max = world});
+    }
+    instances.emplace_back(Instance{.worldToObject = glm::inverse(object.transform),
+                                    .worldBounds = worldBounds,
+                                    .bvh = std::move(bvh),
+                                    .mesh = object.renderable.mesh,
+                                    .object = index,
+                                    .streamed = streamed});
+}
+
+std::optional<tel::SceneHit> tel::RaycastScene::closest_hit(const Ray& ray) const {
+    const glm::vec3 inverseDirection = 1.0f / ray.direction;
+    std::optional<SceneHit> closest;
+    float closestDistance = ray.maxDistance;
+    for (const Instance& instance : instances) {
+        if (enter_box(instance.worldBounds.min, instance.worldBounds.max, ray.origin, inverseDirection,
+                      closestDistance) == noHit) {
+            continue;
+        }
+        Ray objectRay = to_object_space(ray, instance.worldToObject);
+        objectRay.maxDistance = closestDistance;
+        const auto hit = instance.bvh->closest_hit(objectRay);
+        if (!hit) {
+            continue;
+        }
+        closestDistance = hit->distance;
+        closest = SceneHit{.distance = hit->distance,
+                           .position = ray.origin + hit->distance * ray.direction,
+                           .object = instance.object,
+                           .streamed = instance.streamed,
+                           .mesh = instance.mesh,
+                           .triangle = hit->triangle,
+                           .barycentric = hit->barycentric};
+    }
+    return closest;
+}
+
+bool tel::RaycastScene::any_hit(const Ray& ray) const {
+    const glm::vec3 inverseDirection = 1.0f / ray.direction;
+    return std::ranges::any_of(instances, [&](const Instance& instance) {
+        return enter_box(instance.worldBounds.min, instance.worldBounds.max, ray.origin, inverseDirection,
+                         ray.maxDistance) != noHit &&
+               instance.bvh->any_hit(to_object_space(ray, instance.worldToObject));
+    });
+}
@@ -0,0 +1,220 @@
+#include "RenderGraph.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <queue>
+#include <ranges>
+
+void tel::RenderGraph::PassBuilder::read(RenderTargetHandle target) {
+    graph->passes[pass].reads.emplace_back(target);
+    graph->targets[target].readers.emplace_back(pass);
+}
+
+void tel::RenderGraph::PassBuilder::write(RenderTargetHandle target) {
+    graph->passes[pass].writes.emplace_back(target);
+    graph->targets[target].writers.emplace_back(pass);
+}
+
+void tel::RenderGraph::PassBuilder::has_side_effects() { graph->passes[pass].sideEffects = true; }
+
+tel::RenderTargetHandle tel::RenderGraph::create_target(std::string name, const RenderTargetOptions& options) {
+    targets.emplace_back(Target{.name = std::move(name), .options = options});
+    compiled = false;
+    return static_cast<RenderTargetHandle>(targets.size() - 1);
+}
+
+void tel::RenderGraph::resize_target(RenderTargetHandle target, int width, int height) {
+    assert(!targets[target].imported);
+    targets[target].options.width = width;
+    targets[target].options.height = height;
+}
+
+tel::RenderTargetHandle tel::RenderGraph::import_framebuffer(std::string name, const Framebuffer& framebuffer) {
+    targets.emplace_back(Target{.name = std::move(name),
+                                .options = {.width = framebuffer.width(), .height = framebuffer.height()},
+                                .imported = &framebuffer});
+    compiled = false;
+    return static_cast<RenderTargetHandle>(targets.size() - 1);
+}
+
+void tel::RenderGraph::add_pass(std::string name, const Setup& setup, Execute execute) {
+    passes.emplace_back(Pass{.name = std::move(name), .execute = std::move(execute)});
+    PassBuilder builder(this, passes.size() - 1);
+    setup(builder);
+    compiled = false;
+}
+
+std::expected<void, tel::RenderGraphError> tel::RenderGraph::compile() {
+    cull();
+    if (auto sorted = sort(); !sorted) {
+        return sorted;
+    }
+    compute_lifetimes();
+    compiled = true;
+    return {};
+}
+
+void tel::RenderGraph::cull() {
+    std::vector<std::size_t> passReferences(passes.size());
+    std::vector<std::size_t> targetReferences(targets.size());
+    for (RenderTargetHandle target = 0; target < targets.size(); ++target) {
+        targetReferences[target] = targets[target].readers.size() + (targets[target].imported ? 1 : 0);
+    }
+    for (std::size_t pass = 0; pass < passes.size(); ++pass) {
+        passes[pass].culled = false;
+        passReferences[pass] = passes[pass].writes.size() + (passes[pass].sideEffects ? 1 : 0);
+        // Nothing ever needs a pass without writes or side effects, so its reads need not be produced either
+        if (passReferences[pass] == 0) {
+            passes[pass].culled = true;
+            for (const RenderTargetHandle read : passes[pass].reads) {
+                --targetReferences[read];
+            }
+        }
+    }
+    std::vector<RenderTargetHandle> unreferenced;
+    for (RenderTargetHandle target = 0; target < targets.size(); ++target) {
+        if (targetReferences[target] == 0) {
+            unreferenced.emplace_back(target);
+        }
+    }
+    // Walk back from every target nobody reads, dropping the passes that only produce such targets
+    while (!unreferenced.empty()) {
+        const RenderTargetHandle target = unreferenced.back();
+        unreferenced.pop_back();
+        for (const std::size_t writer : targets[target].writers) {
+            if (passReferences[writer] == 0 || --passReferences[writer] > 0) {
+                continue;
+            }
+            passes[writer].culled = true;
+            for (const RenderTargetHandle read : passes[writer].reads) {
+                if (--targetReferences[read] == 0) {
+                    unreferenced.emplace_back(read);
+                }
+            }
+        }
+    }
+}
+
+std::expected<void, tel::RenderGraphError> tel::RenderGraph::sort() {
+    std::vector<std::vector<std::size_t>> dependents(passes.size());
+    std::vector<std::size_t> dependencyCount(passes.size());
+    const auto depend = [&](std::size_t pass, std::size_t on) {
+        if (pass != on && !passes[pass].culled && !passes[on].culled) {
+            dependents[on].emplace_back(pass);
+            ++dependencyCount[pass];
+        }
+    };
+    for (const Target& target : targets) {
+        // Writes to the same target happen in the order they were declared
+        for (std::size_t i = 1; i < target.writers.size(); ++i) {
+            depend(target.writers[i], target.writers[i - 1]);
+        }
+        for (const std::size_t reader : target.readers) {
+            // A reader sees the last write declared before it, or every write if it was declared ahead of them
+            auto earlierWriters =
+                target.writers | std::views::filter([&](std::size_t writer) { return writer < reader; });
+            if (!std::ranges::empty(earlierWriters)) {
+                depend(reader, std::ranges::max(earlierWriters));
+            } else {
+                for (const std::size_t writer : target.writers) {
+                    depend(reader, writer);
+                }
+            }
+            // ...and later writes must wait until it is done reading
+            for (const std::size_t writer : target.writers) {
+                if (writer > reader) {
+                    depend(writer, reader);
+                }
+            }
+        }
+    }
+
+    order.clear();
+    std::priority_queue<std::size_t, std::vector<std::size_t>, std::greater<>> ready;
+    std::size_t alive = 0;
+    for (std::size_t pass = 0; pass < passes.size(); ++pass) {
+        if (passes[pass].culled) {
+            continue;
+        }
+        ++alive;
+        if (dependencyCount[pass] == 0) {
+            ready.push(pass);
+        }
+    }
+    while (!ready.empty()) {
+        const std::size_t pass = ready.top();
+        ready.pop();
+        order.emplace_back(pass);
+        for (const std::size_t dependent : dependents[pass]) {
+            if (--dependencyCount[dependent] == 0) {
+                ready.push(dependent);
+            }
+        }
+    }
+    if (order.size() != alive) {
+        const auto stuck = std::ranges::find_if(std::views::iota(std::size_t{0}, passes.size()),
+                                                [&](std::size_t pass) {
+                                                    return !passes[pass].culled && dependencyCount[pass] > 0;
+                                                });
+        return std::unexpected(RenderGraphError{.pass = passes[*stuck].name});
+    }
+    return {};
+}
+
+void tel::RenderGraph::compute_lifetimes() {
+    for (Target& target : targets) {
+        target.firstUse = order.size();
+        target.lastUse = 0;
+    }
+    for (std::size_t position = 0; position < order.size(); ++position) {
+        const Pass& pass = passes[order[position]];
+        for (const auto& uses : {std::cref(pass.reads), std::cref(pass.writes)}) {
+            for (const RenderTargetHandle handle : uses.get()) {
+                targets[handle].firstUse = std::min(targets[handle].firstUse, position);
+                targets[handle].lastUse = std::max(targets[handle].lastUse, position);
+            }
+        }
+    }
+}
+
+void tel::RenderGraph::execute(RenderTargetPool& pool, const BindFramebuffer& bindFramebuffer) {
+    if (!compiled) {
+        [[maybe_unused]] const auto result = compile();
+        assert(result.has_value());
+    }
+    physical.assign(targets.size(), nullptr);
+    for (std::size_t position = 0; position < order.size(); ++position) {
+        Pass& pass = passes[order[position]];
+        for (RenderTargetHandle handle = 0; handle < targets.size(); ++handle) {
+            if (!targets[handle].imported && targets[handle].firstUse == position) {
+                physical[handle] = pool.acquire(targets[handle].options);
+            }
+        }
+
+        const Framebuffer* framebuffer = nullptr;
+        attachments.clear();
+        for (const RenderTargetHandle handle : pass.writes) {
+            if (targets[handle].imported) {
+                framebuffer = targets[handle].imported;
+            } else {
+                attachments.emplace_back(physical[handle]);
+            }
+        }
+        // A pass renders either into an imported framebuffer or into its own targets, not both
+        assert(framebuffer == nullptr || attachments.empty());
+        if (!attachments.empty()) {
+            framebuffer = &pool.framebuffer(attachments);
+        }
+        if (framebuffer != nullptr) {
+            bindFramebuffer(*framebuffer);
+        }
+        pass.execute(RenderPassContext{.framebuffer = framebuffer, .targets = physical});
+
+        for (RenderTargetHandle handle = 0; handle < targets.size(); ++handle) {
+            if (!targets[handle].imported && targets[handle].lastUse == position && physical[handle] != nullptr) {
+                pool.release(physical[handle]);
+            }
+        }
+    }
+}
@@ -0,0 +1,278 @@
+#include "Scripting.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <format>
+#include <functional>
+#include <iostream>
+#include <memory_resource>
+#include <new>
+#include <numeric>
+#include <stdexcept>
+
+namespace {
+constexpr std::size_t luaAlignment = alignof(std::max_align_t);
+
+// Lua's allocator interface on top of the tracked heap. When the block is null, its old size is a type tag instead.
+void* allocate(void* userData, void* block, std::size_t oldSize, std::size_t newSize) {
+    auto* resource = static_cast<std::pmr::memory_resource*>(userData);
+    if (newSize == 0) {
+        if (block != nullptr) {
+            resource->deallocate(block, oldSize, luaAlignment);
+        }
+        return nullptr;
+    }
+    void* resized = nullptr;
+    try {
+        resized = resource->allocate(newSize, luaAlignment);
+    } catch (const std::bad_alloc&) {
+        // Lua raises its own out of memory error, and keeps the old block
+        return nullptr;
+    }
+    if (block != nullptr) {
+        std::memcpy(resized, block, std::min(oldSize, newSize));
+        resource->deallocate(block, oldSize, luaAlignment);
+    }
+    return resized;
+}
+
+void check_same_size(const tel::FloatArray& first, const tel::FloatArray& second) {
+    if (first.size() != second.size()) {
+        throw std::invalid_argument(std::format("arrays of {} and {} floats", first.size(), second.size()));
+    }
+}
+
+double milliseconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Error messages then start with the script's name rather than [string "..."]
+std::string chunk_name(std::string_view name) { return std::format("@{}", name); }
+} // namespace
+
+void tel::FloatArray::fill(float value) { std::ranges::fill(values, value); }
+
+void tel::FloatArray::add(const FloatArray& other) {
+    check_same_size(*this, other);
+    std::ranges::transform(values, other.values, values.begin(), std::plus{});
+}
+
+void tel::FloatArray::multiply(const FloatArray& other) {
+    check_same_size(*this, other);
+    std::ranges::transform(values, other.values, values.begin(), std::multiplies{});
+}
+
+void tel::FloatArray::scale(float factor) {
+    for (float& value : values) {
+        value *= factor;
+    }
+}
+
+void tel::FloatArray::add_scaled(const FloatArray& other, float factor) {
+    check_same_size(*this, other);
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        values[i] += other.values[i] * factor;
+    }
+}
+
+void tel::FloatArray::clamp(float min, float max) {
+    for (float& value : values) {
+        value = std::clamp(value, min, max);
+    }
+}
+
+float tel::FloatArray::sum() const { return std::reduce(values.begin(), values.end(), 0.0f); }
+
+void tel::ObjectArray::read_positions(FloatArray& out) const {
+    out.resize(3 * objects->size());
+    float* position = out.data().data();
+    for (const SceneObject& object : *objects) {
+        position = std::copy_n(&object.transform[3][0], 3, position);
+    }
+}
+
+void tel::ObjectArray::write_positions(const FloatArray& positions) {
+    check_size(positions, 3);
+    const float* position = positions.data().data();
+    for (SceneObject& object : *objects) {
+        std::copy_n(position, 3, &object.transform[3][0]);
+        position += 3;
+    }
+}
+
+void tel::ObjectArray::translate(const FloatArray& offsets, float factor) {
+    check_size(offsets, 3);
+    const float* offset = offsets.data().data();
+    for (SceneObject& object : *objects) {
+        object.transform[3][0] += offset[0] * factor;
+        object.transform[3][1] += offset[1] * factor;
+        object.transform[3][2] += offset[2] * factor;
+        offset += 3;
+    }
+}
+
+void tel::ObjectArray::translate_all(float x, float y, float z) {
+    for (SceneObject& object : *objects) {
+        object.transform[3][0] += x;
+        object.transform[3][1] += y;
+        object.transform[3][2] += z;
+    }
+}
+
+void tel::ObjectArray::read_transforms(FloatArray& out) const {
+    out.resize(16 * objects->size());
+    float* transform = out.data().data();
+    for (const SceneObject& object : *objects) {
+        transform = std::copy_n(&object.transform[0][0], 16, transform);
+    }
+}
+
+void tel::ObjectArray::write_transforms(const FloatArray& transforms) {
+    check_size(transforms, 16);
+    const float* transform = transforms.data().data();
+    for (SceneObject& object : *objects) {
+        std::copy_n(transform, 16, &object.transform[0][0]);
+        transform += 16;
+    }
+}
+
+std::tuple<float, float, float> tel::ObjectArray::position(std::size_t index) const {
+    const Transform& transform = objects->at(index - 1).transform;
+    return {transform[3][0], transform[3][1], transform[3][2]};
+}
+
+void tel::ObjectArray::set_position(std::size_t index, float x, float y, float z) {
+    Transform& transform = objects->at(index - 1).transform;
+    transform[3][0] = x;
+    transform[3][1] = y;
+    transform[3][2] = z;
+}
+
+void tel::ObjectArray::check_size(const FloatArray& values, std::size_t perObject) const {
+    if (values.size() != perObject * objects->size()) {
+        throw std::invalid_argument(std::format("expected {} floats for {} objects, got {}",
+                                                perObject * objects->size(), objects->size(), values.size()));
+    }
+}
+
+void tel::ScriptScene::point_at(Scene& scene) {
+    objects = ObjectArray(&scene.sceneObjects);
+    streamed = ObjectArray(&scene.streamedObjects);
+    camera = &scene.camera;
+}
+
+void tel::ScriptScene::read_camera(FloatArray& out) const {
+    out.resize(16);
+    std::copy_n(&camera->transform[0][0], 16, out.data().data());
+}
+
+void tel::ScriptScene::write_camera(const FloatArray& view) {
+    if (view.size() != 16) {
+        throw std::invalid_argument(std::format("expected 16 floats for the camera, got {}", view.size()));
+    }
+    std::copy_n(view.data().data(), 16, &camera->transform[0][0]);
+}
+
+tel::Scripting::Scripting()
+    : state(sol::default_at_panic, allocate, tracked_resource(MemorySubsystem::Scripting)) {
+    state.open_libraries(sol::lib::base, sol::lib::math, sol::lib::string, sol::lib::table);
+    register_types();
+}
+
+std::expected<tel::ScriptHandle, tel::ScriptError> tel::Scripting::load_script(std::string name,
+                                                                               std::string_view source) {
+    const auto fail = [&](std::string message) {
+        return std::unexpected(ScriptError{.script = name, .message = std::move(message)});
+    };
+    sol::load_result loaded = state.load(source, chunk_name(name));
+    if (!loaded.valid()) {
+        const sol::error error = loaded;
+        return fail(error.what());
+    }
+    sol::protected_function chunk = loaded;
+    sol::protected_function_result result = chunk();
+    if (!result.valid()) {
+        const sol::error error = result;
+        return fail(error.what());
+    }
+    if (result.get_type() != sol::type::table) {
+        return fail("the script must return a table");
+    }
+    sol::table module = result;
+    const sol::object update = module["update"];
+    if (update.get_type() != sol::type::function) {
+        return fail("the script's table has no update function");
+    }
+    const ScriptHandle handle =
+        scripts.add(Script{.name = std::move(name), .update = update.as<sol::protected_function>(), .stats = {}});
+    updateOrder.push_back(handle);
+    return handle;
+}
+
+void tel::Scripting::unload_script(ScriptHandle script) {
+    scripts.remove(script);
+    std::erase(updateOrder, script);
+}
+
+std::expected<std::string, tel::ScriptError> tel::Scripting::compile(std::string_view name,
+                                                                     std::string_view source) {
+    sol::load_result loaded = state.load(source, chunk_name(name), sol::load_mode::text);
+    if (!loaded.valid()) {
+        const sol::error error = loaded;
+        return std::unexpected(ScriptError{.script = std::string(name), .message = error.what()});
+    }
+    const sol::protected_function chunk = loaded;
+    const sol::bytecode bytecode = chunk.dump();
+    return std::string(bytecode.as_string_view());
+}
+
+void tel::Scripting::update(Scene& scene, float deltaSeconds) {
+    const auto updateStart = std::chrono::steady_clock::now();
+    scriptScene.point_at(scene);
+    for (const ScriptHandle handle : updateOrder) {
+        Script* script = scripts.find(handle);
+        if (script->stats.failed) {
+            continue;
+        }
+        const auto start = std::chrono::steady_clock::now();
+        const sol::protected_function_result result = script->update(&scriptScene, deltaSeconds);
+        ScriptStats& stats = script->stats;
+        stats.lastMilliseconds = milliseconds_since(start);
+        stats.totalMilliseconds += stats.lastMilliseconds;
+        ++stats.updates;
+        if (!result.valid()) {
+            const sol::error error = result;
+            std::cout << "Script " << script->name << " stopped: " << error.what() << '\n';
+            stats.failed = true;
+        }
+    }
+    lastUpdateMilliseconds = milliseconds_since(updateStart);
+}
+
+const tel::ScriptStats* tel::Scripting::stats(ScriptHandle script) const {
+    const Script* found = scripts.find(script);
+    return found ? &found->stats : nullptr;
+}
+
+void tel::Scripting::register_types() {
+    state.new_usertype<FloatArray>(
+        "FloatArray", sol::constructors<FloatArray(), FloatArray(std::size_t), FloatArray(std::size_t, float)>(),
+        sol::meta_function::length, &FloatArray::size, "size", &FloatArray::size, "resize", &FloatArray::resize,
+        "get", &FloatArray::get, "set", &FloatArray::set, "fill", &FloatArray::fill, "add", &FloatArray::add,
+        "multiply", &FloatArray::multiply, "scale", &FloatArray::scale, "add_scaled", &FloatArray::add_scaled,
+        "clamp", &FloatArray::clamp, "sum", &FloatArray::sum);
+    state.new_usertype<ObjectArray>(
+        "ObjectArray", sol::no_constructor, sol::meta_function::length, &ObjectArray::size, "size",
+        &ObjectArray::size, "read_positions", &ObjectArray::read_positions, "write_positions",
+        &ObjectArray::write_positions, "translate", &ObjectArray::translate, "translate_all",
+        &ObjectArray::translate_all, "read_transforms", &ObjectArray::read_transforms, "write_transforms",
+        &ObjectArray::write_transforms, "position", &ObjectArray::position, "set_position",
+        &ObjectArray::set_position);
+    // The arrays are handed out by pointer, so scripts index the scene's own storage
+    state.new_usertype<ScriptScene>(
+        "ScriptScene", sol::no_constructor, "objects",
+        sol::readonly_property([](ScriptScene& scene) { return &scene.objects; }), "streamed",
+        sol::readonly_property([](ScriptScene& scene) { return &scene.streamed; }), "read_camera",
+        &ScriptScene::read_camera, "write_camera", &ScriptScene::write_camera);
+}
@@ -0,0 +1,75 @@
+#include "rendering_internals/ShaderIncludes.hpp"
+
+#include <algorithm>
+#include <format>
+#include <iterator>
+#include <optional>
+
+namespace {
+// Deep enough for any sensible nesting, and stops files that include each other
+constexpr int maxIncludeDepth = 16;
+
+tel::ShaderCompilationError include_error(std::string_view message) {
+    tel::ShaderCompilationError error{};
+    error.text.assign(message.begin(), message.end());
+    error.text.push_back('\0');
+    return error;
+}
+
+// The quoted name when the line is an include directive
+std::optional<std::string_view> included_name(std::string_view line) {
+    constexpr std::string_view whitespace = " \t\r";
+    constexpr std::string_view directive = "#include";
+    line.remove_prefix(std::min(line.find_first_not_of(whitespace), line.size()));
+    if (!line.starts_with(directive)) {
+        return std::nullopt;
+    }
+    line.remove_prefix(directive.size());
+    line.remove_prefix(std::min(line.find_first_not_of(whitespace), line.size()));
+    const std::size_t close = line.find('"', 1);
+    if (!line.starts_with('"') || close == std::string_view::npos) {
+        return std::nullopt;
+    }
+    return line.substr(1, close - 1);
+}
+
+std::expected<void, tel::ShaderCompilationError> resolve(std::string_view code, const tel::AssetArchive& assets,
+                                                         int depth, std::string& out) {
+    if (depth > maxIncludeDepth) {
+        return std::unexpected(include_error("Shader includes nested too deeply"));
+    }
+    std::size_t lineNumber = 0;
+    while (!code.empty()) {
+        const std::size_t end = std::min(code.find('\n'), code.size());
+        const std::string_view line = code.substr(0, end);
+        code.remove_prefix(std::min(end + 1, code.size()));
+        ++lineNumber;
+        const auto name = included_name(line);
+        if (!name) {
+            out.append(line);
+            out.push_back('\n');
+            continue;
+        }
+        const auto included = assets.read(std::format("shaders/{}", *name));
+        if (!included) {
+            return std::unexpected(include_error(std::format("Cannot find included shader {}", *name)));
+        }
+        out.append("#line 1\n");
+        if (auto resolved = resolve(*included, assets, depth + 1, out); !resolved) {
+            return resolved;
+        }
+        std::format_to(std::back_inserter(out), "#line {}\n", lineNumber + 1);
+    }
+    return {};
+}
+} // namespace
+
+std::expected<std::string, tel::ShaderCompilationError> tel::resolve_shader_includes(std::string_view code,
+                                                                                     const AssetArchive& assets) {
+    std::string out;
+    out.reserve(code.size());
+    if (auto resolved = resolve(code, assets, 0, out); !resolved) {
+        return std::unexpected(resolved.error());
+    }
+    return out;
+}
@@ -0,0 +1,262 @@
+#include "TextureStreaming.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <chrono>
+#include <cstring>
+#include <ranges>
+
+namespace {
+GLenum internal_format_for(int channels) {
+    assert(channels >= 1 && channels <= 4);
+    constexpr std::array<GLenum, 4> formats{GL_R8, GL_RG8, GL_RGB8, GL_RGBA8};
+    return formats[channels - 1];
+}
+
+GLenum pixel_format_for(int channels) {
+    constexpr std::array<GLenum, 4> formats{GL_RED, GL_RG, GL_RGB, GL_RGBA};
+    return formats[channels - 1];
+}
+
+tel::Texture create_texture(int width, int height, int levels, int layers, GLenum internalFormat) {
+    tel::Texture texture = tel::Texture::create(tel::TextureOptions{.width = width,
+                                                                    .height = height,
+                                                                    .levels = levels,
+                                                                    .layers = layers,
+                                                                    .type = tel::TextureType::Texture2DArray,
+                                                                    .internalFormat = internalFormat});
+    // Greyscale textures sample as grey rather than red, so shaders need not know how many channels were stored
+    if (internalFormat == GL_R8 || internalFormat == GL_RG8) {
+        const GLenum alpha = internalFormat == GL_RG8 ? GL_GREEN : GL_ONE;
+        const std::array<GLint, 4> swizzle{GL_RED, GL_RED, GL_RED, static_cast<GLint>(alpha)};
+        glTextureParameteriv(texture.underlying(), GL_TEXTURE_SWIZZLE_RGBA, swizzle.data());
+    }
+    return texture;
+}
+} // namespace
+
+tel::TextureStreaming::TextureStreaming(ThreadPool* threadPool, const TextureStreamingOptions& options)
+    : threadPool(threadPool), options(options), staging(StagingBuffer::create(options.stagingBufferSize)),
+      textures(MemorySubsystem::Textures) {}
+
+tel::TextureHandle tel::TextureStreaming::request(std::string encodedData, const TextureLoadOptions& loadOptions) {
+    return add(std::make_shared<const Source>(std::move(encodedData)), loadOptions);
+}
+
+tel::TextureHandle tel::TextureStreaming::request(Image image, const TextureLoadOptions& loadOptions) {
+    return add(std::make_shared<const Source>(std::move(image)), loadOptions);
+}
+
+tel::TextureHandle tel::TextureStreaming::add(std::shared_ptr<const Source> source,
+                                              const TextureLoadOptions& loadOptions) {
+    const TextureHandle handle = textures.add(StreamedTexture{.options = loadOptions, .source = std::move(source)});
+    start_decoding(*textures.find(handle));
+    return handle;
+}
+
+void tel::TextureStreaming::start_decoding(StreamedTexture& texture) {
+    texture.state = State::Decoding;
+    texture.decoding = threadPool->submit([source = texture.source, generateMips = texture.options.generateMips] {
+        std::expected<Image, ImageLoadError> image = std::holds_alternative<Image>(*source)
+                                                         ? std::get<Image>(*source)
+                                                         : load_image_from_memory(std::get<std::string>(*source));
+        if (!image) {
+            return DecodeResult(std::unexpected(image.error()));
+        }
+        if (!generateMips) {
+            return DecodeResult(std::vector{std::move(image.value())});
+        }
+        return DecodeResult(generate_mip_chain(std::move(image.value())));
+    });
+}
+
+void tel::TextureStreaming::update(std::uint64_t frame) {
+    using namespace std::chrono_literals;
+    staging.retire();
+    for (auto& [handle, texture] : textures) {
+        if (texture.state != State::Decoding || texture.decoding.wait_for(0s) != std::future_status::ready) {
+            continue;
+        }
+        auto decoded = texture.decoding.get();
+        if (!decoded) {
+            texture.state = State::Failed;
+            continue;
+        }
+        texture.mips = std::move(decoded.value());
+        begin_upload(texture);
+        uploadQueue.emplace_back(handle);
+    }
+
+    std::size_t budget = options.uploadBudgetPerFrame;
+    while (!uploadQueue.empty() && budget > 0) {
+        StreamedTexture& texture = *textures.find(uploadQueue.front());
+        if (!upload_level(texture, budget)) {
+            break;
+        }
+        if (texture.nextUploadLevel == texture.mips.size()) {
+            finish_upload(texture);
+            uploadQueue.pop_front();
+        }
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    staging.fence();
+    enforce_residency(frame);
+}
+
+void tel::TextureStreaming::begin_upload(StreamedTexture& texture) {
+    texture.state = State::Uploading;
+    texture.nextUploadLevel = 0;
+    const Image& base = texture.mips.front();
+    const int levels = static_cast<int>(texture.mips.size());
+    if (texture.options.batch) {
+        if (!texture.arrayKey) {
+            texture.arrayKey =
+                ArrayKey{.width = base.width, .height = base.height, .levels = levels, .channels = base.channels};
+            std::tie(texture.arrayIndex, texture.layer) = allocate_layer(*texture.arrayKey);
+        }
+        return;
+    }
+    texture.restoring = create_texture(base.width, base.height, levels, 1, internal_format_for(base.channels));
+}
+
+bool tel::TextureStreaming::upload_level(StreamedTexture& texture, std::size_t& budget) {
+    const auto level = static_cast<int>(texture.nextUploadLevel);
+    const Image& mip = texture.mips[texture.nextUploadLevel];
+    const GLuint destination = texture.arrayKey
+                                   ? arrays.at(*texture.arrayKey)[texture.arrayIndex].texture.underlying()
+                                   : texture.restoring.underlying();
+    const GLenum format = pixel_format_for(mip.channels);
+    // Rows of fewer than four channels are not padded to four bytes
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    const auto region = staging.allocate(mip.size_in_bytes());
+    if (region) {
+        std::memcpy(region->memory.data(), mip.pixels.data(), mip.size_in_bytes());
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, staging.underlying());
+        glTextureSubImage3D(destination, level, 0, 0, texture.layer, mip.width, mip.height, 1, format,
+                            GL_UNSIGNED_BYTE, reinterpret_cast<const void*>(region->offset));
+    } else if (mip.size_in_bytes() >= staging.capacity()) {
+        // Larger than the whole ring; the driver has to copy it synchronously either way
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        glTextureSubImage3D(destination, level, 0, 0, texture.layer, mip.width, mip.height, 1, format,
+                            GL_UNSIGNED_BYTE, mip.pixels.data());
+    } else {
+        return false;
+    }
+    budget -= std::min(budget, mip.size_in_bytes());
+    ++texture.nextUploadLevel;
+    return true;
+}
+
+void tel::TextureStreaming::finish_upload(StreamedTexture& texture) {
+    if (!texture.arrayKey) {
+        residentBytes -= texture.texture.size_in_bytes();
+        // The old storage may still be read by in-flight draws; GL defers deleting it until they finish
+        Texture previous = std::move(texture.texture);
+        texture.texture = std::move(texture.restoring);
+        residentBytes += texture.texture.size_in_bytes();
+    }
+    texture.droppedLevels = 0;
+    texture.mips.clear();
+    texture.mips.shrink_to_fit();
+    texture.state = State::Resident;
+}
+
+std::pair<std::size_t, int> tel::TextureStreaming::allocate_layer(const ArrayKey& key) {
+    auto& candidates = arrays[key];
+    auto iter = std::ranges::find_if(candidates, [](const auto& array) { return !array.freeLayers.empty(); });
+    if (iter == candidates.end()) {
+        TextureArray array{.texture = create_texture(key.width, key.height, key.levels, options.layersPerArray,
+                                                     internal_format_for(key.channels))};
+        array.freeLayers.append_range(std::views::iota(0, options.layersPerArray) | std::views::reverse);
+        candidates.emplace_back(std::move(array));
+        iter = std::prev(candidates.end());
+    }
+    const int layer = iter->freeLayers.back();
+    iter->freeLayers.pop_back();
+    return {static_cast<std::size_t>(std::distance(candidates.begin(), iter)), layer};
+}
+
+void tel::TextureStreaming::unload(TextureHandle handle) {
+    StreamedTexture* texture = textures.find(handle);
+    if (texture == nullptr) {
+        return;
+    }
+    if (texture->arrayKey) {
+        arrays.at(*texture->arrayKey)[texture->arrayIndex].freeLayers.emplace_back(texture->layer);
+    } else {
+        residentBytes -= texture->texture.size_in_bytes();
+    }
+    if (texture->state == State::Uploading) {
+        std::erase(uploadQueue, handle);
+    }
+    // A decode still running keeps its own reference to the source until it finishes
+    textures.remove(handle);
+}
+
+std::optional<tel::TextureBinding> tel::TextureStreaming::use(TextureHandle handle, std::uint64_t frame) {
+    StreamedTexture* texture = textures.find(handle);
+    if (texture == nullptr) {
+        return std::nullopt;
+    }
+    texture->lastUsedFrame = frame;
+    if (texture->arrayKey) {
+        if (texture->state != State::Resident) {
+            return std::nullopt;
+        }
+        return TextureBinding{.texture = arrays.at(*texture->arrayKey)[texture->arrayIndex].texture.underlying(),
+                              .layer = texture->layer};
+    }
+    if (texture->state == State::Resident && texture->droppedLevels > 0) {
+        start_decoding(*texture);
+    }
+    if (texture->texture.underlying() == 0) {
+        return std::nullopt;
+    }
+    return TextureBinding{.texture = texture->texture.underlying(), .layer = 0};
+}
+
+void tel::TextureStreaming::enforce_residency(std::uint64_t frame) {
+    if (residentBytes <= options.residencyCap) {
+        return;
+    }
+    evictionCandidates.clear();
+    for (auto& texture : textures | std::views::values) {
+        if (!texture.arrayKey && texture.state == State::Resident && texture.texture.levels() > 1 &&
+            texture.lastUsedFrame + options.evictionGraceFrames < frame) {
+            evictionCandidates.emplace_back(&texture);
+        }
+    }
+    std::ranges::sort(evictionCandidates, {}, &StreamedTexture::lastUsedFrame);
+    // Trim least recently used first, one level at a time, so the textures that were used last keep the most detail
+    bool trimmed = true;
+    while (residentBytes > options.residencyCap && trimmed) {
+        trimmed = false;
+        for (StreamedTexture* texture : evictionCandidates) {
+            if (residentBytes <= options.residencyCap) {
+                return;
+            }
+            if (texture->texture.levels() > 1) {
+                drop_top_level(*texture);
+                trimmed = true;
+            }
+        }
+    }
+}
+
+void tel::TextureStreaming::drop_top_level(StreamedTexture& texture) {
+    const Texture& current = texture.texture;
+    Texture smaller = create_texture(mip_dimension(current.width(), 1), mip_dimension(current.height(), 1),
+                                     current.levels() - 1, 1, current.internal_format());
+    for (int level = 0; level < smaller.levels(); ++level) {
+        glCopyImageSubData(current.underlying(), GL_TEXTURE_2D_ARRAY, level + 1, 0, 0, 0, smaller.underlying(),
+                           GL_TEXTURE_2D_ARRAY, level, 0, 0, 0, mip_dimension(smaller.width(), level),
+                           mip_dimension(smaller.height(), level), 1);
+    }
+    residentBytes -= current.size_in_bytes();
+    residentBytes += smaller.size_in_bytes();
+    Texture previous = std::move(texture.texture);
+    texture.texture = std::move(smaller);
+    ++texture.droppedLevels;
+}
@@ -0,0 +1,319 @@
+#include "WorldStreaming.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <glm/geometric.hpp>
+#include <glm/matrix.hpp>
+#include <iostream>
+#include <ranges>
+
+tel::WorldStreaming::WorldStreaming(Rendering* rendering, ThreadPool* threadPool, LoadMesh loadMesh,
+                                    const WorldStreamingOptions& options)
+    : rendering(rendering), threadPool(threadPool), loadMesh(std::move(loadMesh)), options(options) {}
+
+tel::WorldStreaming::~WorldStreaming() {
+    for (auto& [path, mesh] : meshes) {
+        // Loads still running call loadMesh, which goes away with this
+        if (mesh.pending.valid()) {
+            threadPool->wait(mesh.pending);
+        }
+        if (mesh.handle) {
+            rendering->unload_mesh(*mesh.handle);
+        }
+    }
+}
+
+tel::WorldStreaming::LoadMesh tel::WorldStreaming::archive_loader(const AssetArchive& archive, ThreadPool* threadPool) {
+    return [&archive, threadPool](std::string_view path) -> std::expected<Mesh, MeshLoadError> {
+        // Stored entries are parsed straight out of the archive; compressed ones have to be unpacked first
+        if (const auto view = archive.view(path)) {
+            return load_mesh_from_memory(*view, threadPool);
+        }
+        const auto contents = archive.read(path);
+        if (!contents) {
+            return std::unexpected(MeshLoadError{});
+        }
+        return load_mesh_from_memory(*contents, threadPool);
+    };
+}
+
+std::uint64_t tel::WorldStreaming::key(CellCoordinate cell) {
+    return static_cast<std::uint64_t>(static_cast<std::uint32_t>(cell.x)) << 32 | static_cast<std::uint32_t>(cell.y);
+}
+
+tel::CellCoordinate tel::WorldStreaming::cell_at(const glm::vec3& position) const {
+    return {static_cast<int>(std::floor(position.x / options.cellSize)),
+            static_cast<int>(std::floor(position.z / options.cellSize))};
+}
+
+tel::CellState tel::WorldStreaming::cell_state(CellCoordinate cell) const {
+    const auto iter = cells.find(key(cell));
+    return iter == cells.end() ? CellState::Unloaded : iter->second.state;
+}
+
+std::size_t tel::WorldStreaming::resident_cell_count() const {
+    return std::ranges::count_if(activeCells, [&](std::uint64_t id) {
+        return cells.at(id).state == CellState::Resident;
+    });
+}
+
+std::size_t tel::WorldStreaming::loading_cell_count() const {
+    return activeCells.size() - resident_cell_count();
+}
+
+void tel::WorldStreaming::add_object(WorldObject object) {
+    const CellCoordinate coordinate = cell_at(glm::vec3(object.transform[3]));
+    Cell& cell = cells[key(coordinate)];
+    cell.coordinate = coordinate;
+    // A cell that is already in use has to bring the new mesh in too
+    if (cell.state != CellState::Unloaded) {
+        acquire_mesh(object.mesh);
+        cell.state = CellState::Loading;
+    }
+    cell.objects.emplace_back(std::move(object));
+}
+
+float tel::WorldStreaming::distance_to(const Cell& cell, glm::vec2 viewer) const {
+    const glm::vec2 min = glm::vec2(cell.coordinate) * options.cellSize;
+    const glm::vec2 max = min + options.cellSize;
+    return glm::length(glm::max(glm::max(min - viewer, viewer - max), glm::vec2(0.0f)));
+}
+
+void tel::WorldStreaming::update(Scene& scene) {
+    // The camera transform is the view matrix, so its inverse places the camera in the world
+    const glm::mat4 cameraToWorld = glm::inverse(scene.camera.transform);
+    const glm::vec3 position(cameraToWorld[3]);
+    const glm::vec2 viewer(position.x, position.z);
+    glm::vec2 forward(-cameraToWorld[2].x, -cameraToWorld[2].z);
+    // Looking straight up or down, no direction is preferred
+    forward = glm::dot(forward, forward) > 0.0f ? glm::normalize(forward) : glm::vec2(0.0f);
+    const auto prioritize = [&](Cell& cell) {
+        const float distance = distance_to(cell, viewer);
+        const glm::vec2 toCell = (glm::vec2(cell.coordinate) + 0.5f) * options.cellSize - viewer;
+        const float facing = glm::dot(toCell, toCell) > 0.0f ? glm::dot(forward, glm::normalize(toCell)) : 1.0f;
+        cell.cost = distance * (1.0f + (options.behindPenalty - 1.0f) * (1.0f - facing) * 0.5f);
+        return distance;
+    };
+
+    std::erase_if(activeCells, [&](std::uint64_t id) {
+        Cell& cell = cells.at(id);
+        if (prioritize(cell) <= options.unloadRadius) {
+            return false;
+        }
+        unload(cell);
+        return true;
+    });
+
+    loadCandidates.clear();
+    const int reach = static_cast<int>(std::ceil(options.loadRadius / options.cellSize));
+    const CellCoordinate center = cell_at(position);
+    for (int y = -reach; y <= reach; ++y) {
+        for (int x = -reach; x <= reach; ++x) {
+            const auto iter = cells.find(key(center + CellCoordinate(x, y)));
+            if (iter != cells.end() && iter->second.state == CellState::Unloaded &&
+                prioritize(iter->second) <= options.loadRadius) {
+                loadCandidates.emplace_back(&iter->second);
+            }
+        }
+    }
+    std::ranges::sort(loadCandidates, {}, &Cell::cost);
+    std::size_t loading = loading_cell_count();
+    const std::size_t averageMeshBytes = loadedMeshCount > 0 ? residentBytes / loadedMeshCount : 0;
+    for (Cell* cell : loadCandidates) {
+        if (loading >= options.maxConcurrentLoads ||
+            !make_room(estimated_bytes(*cell, averageMeshBytes), cell->cost)) {
+            break;
+        }
+        begin_loading(*cell);
+        ++loading;
+    }
+
+    upload_finished_meshes();
+    // Estimates can be short, so whatever went over the budget is taken back from the costliest cells, keeping the
+    // nearest cell that still needs its meshes
+    if (const Cell* nearest = nearest_active_cell()) {
+        make_room(0, nearest->cost);
+    }
+    finish_loaded_cells();
+
+    if (objectsChanged) {
+        refill(scene);
+        objectsChanged = false;
+    }
+}
+
+void tel::WorldStreaming::acquire_mesh(const std::string& path) {
+    auto [iter, inserted] = meshes.try_emplace(path);
+    StreamedMesh& mesh = iter->second;
+    ++mesh.users;
+    if (inserted) {
+        mesh.pending = threadPool->submit([this, path = iter->first] { return loadMesh(path); });
+    }
+}
+
+void tel::WorldStreaming::release_mesh(const std::string& path) {
+    const auto iter = meshes.find(path);
+    StreamedMesh& mesh = iter->second;
+    if (--mesh.users > 0) {
+        return;
+    }
+    if (mesh.handle) {
+        rendering->unload_mesh(*mesh.handle);
+        residentBytes -= mesh.bytes;
+        --loadedMeshCount;
+    }
+    // A load still in flight is left to finish, and dropped in upload_finished_meshes unless a cell wants it again
+    if (!mesh.pending.valid()) {
+        meshes.erase(iter);
+    }
+}
+
+void tel::WorldStreaming::begin_loading(Cell& cell) {
+    for (const WorldObject& object : cell.objects) {
+        acquire_mesh(object.mesh);
+    }
+    cell.state = CellState::Loading;
+    activeCells.emplace_back(key(cell.coordinate));
+}
+
+void tel::WorldStreaming::unload(Cell& cell) {
+    // A cell dropped before it finished loading has still shown what it takes at least, so it is not brought straight
+    // back in on a guess that is known to be short
+    cell.lastBytes = std::max(cell.lastBytes, loaded_bytes(cell));
+    for (const WorldObject& object : cell.objects) {
+        release_mesh(object.mesh);
+    }
+    cell.state = CellState::Unloaded;
+    objectsChanged = true;
+}
+
+void tel::WorldStreaming::upload_finished_meshes() {
+    using namespace std::chrono_literals;
+    std::size_t uploaded = 0;
+    for (auto iter = meshes.begin(); iter != meshes.end();) {
+        StreamedMesh& mesh = iter->second;
+        if (!mesh.pending.valid() || mesh.pending.wait_for(0s) != std::future_status::ready) {
+            ++iter;
+            continue;
+        }
+        if (mesh.users == 0) {
+            iter = meshes.erase(iter);
+            continue;
+        }
+        // Whatever is left waits for the next frame, so a burst of finished loads does not stall this one
+        if (uploaded >= options.uploadBudgetPerFrame) {
+            break;
+        }
+        const auto loaded = mesh.pending.get();
+        if (loaded) {
+            mesh.bytes = size_in_bytes(*loaded);
+            if (options.raycastable) {
+                mesh.bytes += MeshBvh::max_size_in_bytes(loaded->triangles.size() / 3);
+            }
+            // Read again from the world's files if the renderer evicts it, rather than kept in memory
+            mesh.handle = rendering->load_mesh(
+                *loaded, [loadMesh = loadMesh, path = iter->first] { return loadMesh(path); },
+                {.raycastable = options.raycastable});
+            residentBytes += mesh.bytes;
+            ++loadedMeshCount;
+            uploaded += mesh.bytes;
+            objectsChanged = true;
+        } else {
+            std::cerr << "Could not load mesh " << iter->first << " for world streaming\n";
+            mesh.failed = true;
+        }
+        ++iter;
+    }
+}
+
+void tel::WorldStreaming::collect_meshes(const Cell& cell) {
+    cellMeshes.clear();
+    for (const WorldObject& object : cell.objects) {
+        cellMeshes.emplace_back(&meshes.find(object.mesh)->second);
+    }
+    std::ranges::sort(cellMeshes);
+    const auto duplicates = std::ranges::unique(cellMeshes);
+    cellMeshes.erase(duplicates.begin(), duplicates.end());
+}
+
+std::size_t tel::WorldStreaming::loaded_bytes(const Cell& cell) {
+    collect_meshes(cell);
+    std::size_t bytes = 0;
+    for (const StreamedMesh* mesh : cellMeshes) {
+        bytes += mesh->bytes;
+    }
+    return bytes;
+}
+
+std::size_t tel::WorldStreaming::estimated_bytes(const Cell& cell, std::size_t averageMeshBytes) const {
+    if (cell.lastBytes > 0) {
+        return cell.lastBytes;
+    }
+    // Never loaded: meshes already in memory cost nothing more, and the rest are guessed at the average so far
+    std::size_t bytes = 0;
+    for (const WorldObject& object : cell.objects) {
+        const auto iter = meshes.find(object.mesh);
+        if (iter == meshes.end() || !iter->second.handle) {
+            bytes += averageMeshBytes;
+        }
+    }
+    return bytes;
+}
+
+const tel::WorldStreaming::Cell* tel::WorldStreaming::nearest_active_cell() const {
+    const Cell* nearest = nullptr;
+    for (const std::uint64_t id : activeCells) {
+        const Cell& cell = cells.at(id);
+        if (nearest == nullptr || cell.cost < nearest->cost) {
+            nearest = &cell;
+        }
+    }
+    return nearest;
+}
+
+void tel::WorldStreaming::finish_loaded_cells() {
+    for (const std::uint64_t id : activeCells) {
+        Cell& cell = cells.at(id);
+        if (cell.state != CellState::Loading) {
+            continue;
+        }
+        collect_meshes(cell);
+        if (std::ranges::all_of(cellMeshes, &StreamedMesh::done)) {
+            cell.state = CellState::Resident;
+            cell.lastBytes = 0;
+            for (const StreamedMesh* mesh : cellMeshes) {
+                cell.lastBytes += mesh->bytes;
+            }
+        }
+    }
+}
+
+bool tel::WorldStreaming::make_room(std::size_t bytes, float cost) {
+    while (residentBytes + bytes > options.memoryBudget) {
+        const auto worst = std::ranges::max_element(activeCells, {}, [&](std::uint64_t id) {
+            return cells.at(id).cost;
+        });
+        if (worst == activeCells.end() || cells.at(*worst).cost <= cost) {
+            return false;
+        }
+        unload(cells.at(*worst));
+        activeCells.erase(worst);
+    }
+    return true;
+}
+
+void tel::WorldStreaming::refill(Scene& scene) const {
+    scene.streamedObjects.clear();
+    // Objects show up as soon as their own mesh is in, rather than waiting for the rest of their cell
+    for (const std::uint64_t id : activeCells) {
+        for (const WorldObject& object : cells.at(id).objects) {
+            const StreamedMesh& mesh = meshes.find(object.mesh)->second;
+            if (mesh.handle) {
+                const Renderable renderable{.shader = object.shader, .mesh = *mesh.handle, .texture = object.texture};
+                scene.streamedObjects.emplace_back(
+                    SceneObject{.transform = object.transform, .renderable = renderable});
+            }
+        }
+    }
+}
@@ -0,0 +1,52 @@
+// hazor-pack: packs files into an asset archive.
+//
+//     hazor-pack <archive> <root> [paths...]
+//
+// Paths are relative to root and become the names the assets are looked up by. Without any, every file under root is
+// packed.
+#include "AssetArchive.hpp"
+#include "FileLoading.hpp"
+
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " <archive> <root> [paths...]\n";
+        return 2;
+    }
+    const std::filesystem::path archivePath = argv[1];
+    const std::filesystem::path root = argv[2];
+
+    std::vector<std::filesystem::path> paths(argv + 3, argv + argc);
+    if (paths.empty()) {
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(root)) {
+            if (entry.is_regular_file()) {
+                paths.emplace_back(std::filesystem::relative(entry.path(), root));
+            }
+        }
+    }
+
+    tel::AssetArchiveWriter writer;
+    std::size_t totalBytes = 0;
+    for (const auto& path : paths) {
+        const auto contents = tel::load_file(root / path);
+        if (!contents) {
+            std::cerr << "Could not read " << (root / path).string() << '\n';
+            return 1;
+        }
+        totalBytes += contents->size();
+        // Archive paths always use forward slashes, whatever the platform that packed them
+        writer.add(path.generic_string(), std::as_bytes(std::span(*contents)));
+    }
+
+    if (const auto written = writer.write(archivePath); !written) {
+        std::cerr << "Could not write " << archivePath.string() << '\n';
+        return 1;
+    }
+    std::cout << "Packed " << paths.size() << " files, " << totalBytes << " bytes, into " << archivePath.string()
+              << " (" << std::filesystem::file_size(archivePath) << " bytes)\n";
+    return 0;
+}